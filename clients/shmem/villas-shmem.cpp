@@ -16,6 +16,7 @@
 #include <villas/node.hpp>
 #include <villas/node/config.hpp>
 #include <villas/node/exceptions.hpp>
+#include <villas/node/memory.hpp>
 #include <villas/pool.hpp>
 #include <villas/sample.hpp>
 #include <villas/shmem.hpp>
@@ -29,7 +30,14 @@ namespace tools {
 class Shmem : public Tool {
 
 public:
-  Shmem(int argc, char *argv[]) : Tool(argc, argv, "shmem"), stop(false) {}
+  Shmem(int argc, char *argv[]) : Tool(argc, argv, "shmem"), stop(false) {
+    int ret;
+
+    // Samples are only allocated from the shared memory regions
+    ret = memory::init(0);
+    if (ret)
+      throw RuntimeError("Failed to initialize memory");
+  }
 
 protected:
   std::atomic<bool> stop;
@@ -42,6 +50,11 @@ protected:
         << "  RNAME     name of the shared memory object for the input queue"
         << std::endl
         << "  VECTORIZE maximum number of samples to read/write at a time"
+        << std::endl
+        << std::endl
+        << "  The lengths of the queues and samples are taken from the"
+        << std::endl
+        << "  environment variables VILLAS_SHMEM_{QUEUE,SAMPLE}LEN if set."
         << std::endl;
 
     printCopyright();
@@ -62,6 +75,15 @@ protected:
       return 1;
     }
 
+    // Started as sub-process of an exec node with 'ipc = "shmem"'
+    const char *queuelen = getenv("VILLAS_SHMEM_QUEUELEN");
+    if (queuelen)
+      conf.queuelen = atoi(queuelen);
+
+    const char *samplelen = getenv("VILLAS_SHMEM_SAMPLELEN");
+    if (samplelen)
+      conf.samplelen = atoi(samplelen);
+
     std::string wname = argv[1];
     std::string rname = argv[2];
     int vectorize = atoi(argv[3]);
@@ -85,6 +107,7 @@ protected:
 
       for (int i = 0; i < avail; i++) {
         outsmps[i]->sequence = insmps[i]->sequence;
+        outsmps[i]->flags = insmps[i]->flags;
         outsmps[i]->ts = insmps[i]->ts;
 
         int len = std::min(insmps[i]->length, outsmps[i]->capacity);
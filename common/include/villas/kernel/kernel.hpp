@@ -63,5 +63,20 @@ int get_cpu_frequency(uint64_t *freq);
 // Set SMP affinity of IRQ
 int setIRQAffinity(unsigned irq, uintmax_t aff, uintmax_t *old);
 
+#ifdef __linux__
+// Block while the futex word at addr contains val
+//
+// This function is a cancellation point. Callers which have to undo changes
+// when the thread is cancelled should use pthread_cleanup_push().
+//
+// @param shared The futex word is located in memory shared between processes
+// @retval 0 Woken up
+// @retval <0 The value did not match or the wait was interrupted; errno is set
+int futexWait(uint32_t *addr, uint32_t val, bool shared = false);
+
+// Wake up at most cnt threads waiting on the futex word at addr
+int futexWake(uint32_t *addr, int cnt, bool shared = false);
+#endif
+
 } // namespace kernel
 } // namespace villas
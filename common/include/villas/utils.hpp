@@ -123,6 +123,15 @@ bool isContainer();
 // Check if the process is running in a privileged environment (has SYS_ADMIN capability).
 bool isPrivileged();
 
+// Hint the CPU that we are spinning in a busy-wait loop.
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
 // helper type for std::visit
 template <class... Ts> struct overloaded : Ts... {
   using Ts::operator()...;
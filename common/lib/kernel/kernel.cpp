@@ -5,17 +5,24 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cerrno>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
 
 #include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/futex.h>
+#endif
+
 #include <villas/config.hpp>
 #include <villas/exceptions.hpp>
 #include <villas/kernel/kernel.hpp>
@@ -328,4 +335,27 @@ out:
 
   return ret;
 }
+
+int villas::kernel::futexWait(uint32_t *addr, uint32_t val, bool shared) {
+  int ret, err, oldtype;
+  int op = shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+
+  /* A raw system call is not a cancellation point. Like glibc does for its
+   * own blocking calls, we enable asynchronous cancellation for the duration
+   * of the system call only. */
+  pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &oldtype);
+  ret = syscall(SYS_futex, addr, op, val, nullptr, nullptr, 0);
+  err = errno;
+  pthread_setcanceltype(oldtype, nullptr);
+
+  errno = err;
+
+  return ret;
+}
+
+int villas::kernel::futexWake(uint32_t *addr, int cnt, bool shared) {
+  int op = shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE;
+
+  return syscall(SYS_futex, addr, op, cnt, nullptr, nullptr, 0);
+}
 #endif // __linux__
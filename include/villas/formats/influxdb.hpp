@@ -0,0 +1,45 @@
+/* InfluxDB line protocol.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <villas/formats/line.hpp>
+
+namespace villas {
+namespace node {
+
+class InfluxDBFormat : public LineFormat {
+
+protected:
+  size_t sprintLine(char *buf, size_t len, const struct Sample *smp) override;
+  size_t sscanLine(const char *buf, size_t len, struct Sample *smp) override;
+
+  // Parsing the line protocol is not supported
+  int sscan(const char *buf, size_t len, size_t *rbytes,
+            struct Sample *const smps[], unsigned cnt) override;
+
+  std::string key; // Measurement name and optional tags.
+
+  // Escaped field keys of the signal list which has been printed last.
+  SignalList::Ptr fields_signals;
+  std::vector<std::string> fields;
+
+  void updateFields(const SignalList::Ptr sigs);
+
+public:
+  using LineFormat::LineFormat;
+
+  void setKey(const std::string &k) { key = k; }
+
+  void parse(json_t *json) override;
+};
+
+} // namespace node
+} // namespace villas
@@ -40,6 +40,10 @@ public:
 
   void reset() override { header_printed = false; }
 
+  char getDelimiter() const { return delimiter; }
+
+  char getComment() const { return comment; }
+
   void printMetadata(FILE *f, json_t *json) override;
 
   int sprint(char *buf, size_t len, size_t *wbytes,
@@ -62,6 +62,9 @@ protected:
 
   json_t *config; // A JSON object containing the configuration of the hook.
 
+  // Check if all samples of a batch use the same signal list.
+  static bool hasUniformSignals(struct Sample *const smps[], unsigned cnt);
+
 public:
   Hook(Path *p, Node *n, int fl, int prio, bool en = true);
 
@@ -108,6 +111,18 @@ public:
   // Called whenever a sample is processed.
   virtual Reason process(struct Sample *smp) { return Reason::OK; };
 
+  /* Called whenever a batch of samples is processed.
+   *
+   * The result for each sample is stored in \p reasons.
+   * The default implementation calls process() for each sample.
+   * Hooks can override it to avoid the per-sample overhead.
+   *
+   * @retval Reason::ERROR If the processing of any sample failed.
+   * @retval Reason::OK Otherwise.
+   */
+  virtual Reason processMany(struct Sample *smps[], unsigned cnt,
+                             Reason reasons[]);
+
   unsigned getPriority() const { return priority; }
 
   int getFlags() const { return flags; }
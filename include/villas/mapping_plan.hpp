@@ -0,0 +1,88 @@
+/* Compiled sample value remapping for path source muxing.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <villas/mapping_list.hpp>
+#include <villas/stats.hpp>
+
+namespace villas {
+namespace node {
+
+// Forward declarations
+class Node;
+struct Sample;
+
+/* A flat execution plan for a MappingList.
+ *
+ * The plan is compiled once during Path::prepare().
+ * It consists of a set of contiguous copy ranges and a few fix-ups for
+ * header, timestamp and statistic values. This avoids the per-entry
+ * dispatch of MappingEntry::update() and a full clone of the previous
+ * muxed sample.
+ */
+class MappingPlan {
+
+public:
+  struct Range {
+    unsigned src; // Offset in the source sample.
+    unsigned dst; // Offset in the remapped sample.
+    unsigned len; // Number of values.
+  };
+
+  struct StatsFixup {
+    unsigned dst;
+    Node *node;
+    enum Stats::Metric metric;
+    enum Stats::Type type;
+  };
+
+protected:
+  std::vector<Range>
+      data; // Values copied from the original sample (merged if contiguous).
+  std::vector<Range>
+      carry; // Values carried over from the previous muxed sample.
+
+  std::vector<unsigned> sequence;   // Offsets of hdr.sequence mappings.
+  std::vector<unsigned> length;     // Offsets of hdr.length mappings.
+  std::vector<unsigned> tsOrigin;   // Offsets of ts.origin mappings.
+  std::vector<unsigned> tsReceived; // Offsets of ts.received mappings.
+  std::vector<StatsFixup> stats;    // Offsets of stats.* mappings.
+
+  unsigned fixedEnd; // Upper bound of all non-data mappings.
+  unsigned capacity; // Minimal capacity of remapped samples.
+
+public:
+  MappingPlan() : fixedEnd(0), capacity(0) {}
+
+  /* Compile a plan for the mapping entries in \p ml.
+   *
+   * @param ml A prepared mapping list.
+   * @param total The total number of signals of the muxed sample.
+   */
+  void compile(const MappingList &ml, unsigned total);
+
+  /* Construct a muxed sample.
+   *
+   * Values which are not covered by the mappings are taken from \p previous.
+   * Only the values and the length of \p remapped are updated.
+   *
+   * @retval 0 Success.
+   * @retval -1 The capacity of \p remapped is insufficient.
+   */
+  int apply(struct Sample *remapped, const struct Sample *original,
+            const struct Sample *previous) const;
+
+  const std::vector<Range> &getDataRanges() const { return data; }
+
+  const std::vector<Range> &getCarryRanges() const { return carry; }
+};
+
+} // namespace node
+} // namespace villas
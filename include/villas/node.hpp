@@ -193,6 +193,13 @@ public:
    */
   virtual std::vector<int> getNetemFDs() { return {}; }
 
+  /* Get the time at which the kernel has sent the sample with the given
+   * sequence number. Returns 0 on success or -1 if the time is not known.
+   */
+  virtual int getTxTimestamp(uint64_t sequence, struct timespec *ts) {
+    return -1;
+  }
+
   /* Get the memory type which this node-type expects.
    *
    * This is useful for special node-types like Infiniband, GPUs & FPGAs
@@ -119,6 +119,9 @@ public:
   // Get list of socket file descriptors for configuring network emulation.
   std::vector<int> getNetemFDs() override;
 
+  // Get the kernel TX timestamp of a sample which has been sent by this node.
+  int getTxTimestamp(uint64_t sequence, struct timespec *ts) override;
+
   // Return a memory allocator which should be used for sample pools passed to this node.
   struct memory::Type *getMemoryType() override;
 };
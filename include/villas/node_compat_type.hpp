@@ -215,6 +215,15 @@ public:
    */
   int (*netem_fds)(NodeCompat *n, int sds[]);
 
+  /* Get the time at which the kernel has sent the sample with the given sequence number.
+   *
+   * This callback is optional. It will only be called if non-null.
+   *
+   * @retval 0	Success. The timestamp has been put into \p ts.
+   * @retval <0	Error. The timestamp is not known.
+   */
+  int (*tx_timestamp)(NodeCompat *n, uint64_t sequence, struct timespec *ts);
+
   // Return a memory allocator which should be used for sample pools passed to this node.
   struct memory::Type *(*memory_type)(NodeCompat *n,
                                       struct memory::Type *parent);
@@ -7,9 +7,12 @@
 
 #pragma once
 
+#include <thread>
+
 #include <villas/format.hpp>
 #include <villas/node.hpp>
 #include <villas/popen.hpp>
+#include <villas/shmem.hpp>
 
 namespace villas {
 namespace node {
@@ -19,6 +22,12 @@ struct Sample;
 
 class ExecNode : public Node {
 
+public:
+  enum class IPC {
+    STDIO, // Samples are exchanged in the format via stdin / stdout.
+    SHMEM  // Samples are exchanged via a shared memory interface.
+  };
+
 protected:
   std::unique_ptr<villas::utils::Popen> proc;
   std::unique_ptr<Format> formatter;
@@ -28,6 +37,19 @@ protected:
   bool flush;
   bool shell;
 
+  enum IPC ipc;
+
+  struct ShmemConfig shmem_conf;
+  struct ShmemInterface shmem;
+  std::string shmem_wname; // Name of the shm object for the output queue.
+  std::string shmem_rname; // Name of the shm object for the input queue.
+  double shmem_timeout;    // Seconds to wait for the sub-process to attach.
+
+  // Forwards the output of the sub-process to the log in SHMEM mode.
+  std::thread output_thread;
+
+  void forwardOutput();
+
   std::string working_dir;
   std::string command;
 
@@ -40,7 +62,12 @@ protected:
 public:
   ExecNode(const uuid_t &id = {}, const std::string &name = "")
       : Node(id, name), stream_in(nullptr), stream_out(nullptr), flush(true),
-        shell(false) {}
+        shell(false), ipc(IPC::STDIO),
+        shmem_conf({.polling = 0,
+                    .queuelen = DEFAULT_SHMEM_QUEUELEN,
+                    .samplelen = DEFAULT_SHMEM_SAMPLELEN,
+                    .mode = QueueSignalledMode::AUTO}),
+        shmem_timeout(10) {}
 
   ~ExecNode() override;
 
@@ -7,9 +7,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
 
+#include <pthread.h>
+
 #include <villas/format.hpp>
+#include <villas/pool.hpp>
+#include <villas/queue_signalled.h>
 #include <villas/task.hpp>
 
 namespace villas {
@@ -20,6 +25,24 @@ class NodeCompat;
 
 #define FILE_MAX_PATHLEN 512
 
+// Alignment of the chunks written by the asynchronous writer (for O_DIRECT).
+#define FILE_ASYNC_ALIGNMENT 4096
+
+// Maximum number of samples which are formatted at once by the writer.
+#define FILE_ASYNC_BATCH 64
+
+// Size of the window which is read ahead during memory-mapped replay.
+#define FILE_REPLAY_PREFETCH (8 << 20)
+
+// Suffix of the sample index which is stored next to the replayed file.
+#define FILE_REPLAY_INDEX_SUFFIX ".idx"
+
+// Entry of the sample index used by the memory-mapped replay.
+struct FileIndexEntry {
+  uint64_t offset;    // Position of the sample in the file.
+  struct timespec ts; // Origin timestamp of the sample.
+};
+
 struct file {
   Format *formatter;
   FILE *stream_in;
@@ -52,6 +75,48 @@ struct file {
     SUSPEND // Blocking wait when EOF is reached.
   } eof_mode;
 
+  enum class OverflowPolicy {
+    DROP, // Drop samples if the queue of the writer is full.
+    BLOCK // Wait until the writer has caught up.
+  };
+
+  // Asynchronous writer
+  struct {
+    int enabled;       // Write from a separate thread.
+    int direct;        // Open the file with O_DIRECT.
+    size_t chunk_size; // Formatted data is written in chunks of this size.
+    unsigned queuelen; // Number of samples which can be queued.
+    enum OverflowPolicy overflow;
+
+    int fd;
+    FILE *stream; // Appends formatted samples to buf.
+    char *buf;    // Aligned buffer of 2 * chunk_size bytes.
+    size_t buflen;
+    struct Pool pool;
+    struct CQueueSignalled queue;
+    pthread_t thread;
+  } async;
+
+  // Memory-mapped replay
+  struct {
+    int enabled;          // Read samples from a mapping of the file.
+    int cache;            // Store the index next to the file.
+    int seek_enabled;     // Start the replay at replay::seek.
+    struct timespec seek; // Timestamp of the first replayed sample.
+
+    const char *base; // Mapping of the file.
+    size_t length;    // Length of the mapping.
+
+    struct FileIndexEntry *index; // Offset and timestamp of each sample.
+    size_t count;                 // Number of samples in the index.
+    void *index_map;              // Mapping of the cached index or nullptr.
+    size_t index_length;          // Length of index_map.
+
+    size_t start;      // Index of the first replayed sample.
+    size_t pos;        // Index of the next sample.
+    size_t prefetched; // Position up to which read-ahead was requested.
+  } replay;
+
   struct timespec
       first; // The first timestamp in the file file::{read,write}::uri
   struct timespec epoch; // The epoch timestamp from the configuration.
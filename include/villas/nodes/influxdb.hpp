@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <ctime>
+
+#include <pthread.h>
+
 #include <villas/list.hpp>
 
 namespace villas {
@@ -14,8 +18,12 @@ namespace node {
 
 // Forward declarations
 class NodeCompat;
+class Format;
 struct Sample;
 
+// Largest payload of a single UDP datagram.
+#define INFLUXDB_MAX_DATAGRAM 65507
+
 struct influxdb {
   char *host;
   char *port;
@@ -24,10 +32,41 @@ struct influxdb {
   struct List fields;
 
   int sd;
+
+  enum class Protocol {
+    UDP, // One or more lines per datagram.
+    TCP  // Line stream, e.g. to the socket_listener of Telegraf.
+  } protocol;
+
+  Format *formatter;
+
+  size_t batch_size;     // Lines are sent once this many bytes are buffered.
+  double batch_timeout;  // Maximum time lines are held back (in seconds).
+  size_t buffer_size;    // Maximum number of buffered bytes.
+  double retry_interval; // Time between attempts after a failure.
+
+  // Background flusher
+  char *buf;          // Lines which have not been sent yet.
+  size_t buflen;      // Number of bytes in buf.
+  char *sendbuf;      // Lines which are currently being sent.
+  size_t sendlen;     // Number of bytes in sendbuf.
+  struct timespec ts; // Time the first line has been added to buf.
+  int stopping;
+
+  char *encbuf; // Lines encoded by influxdb_write().
+  size_t enclen;
+
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
 };
 
 char *influxdb_print(NodeCompat *n);
 
+int influxdb_init(NodeCompat *n);
+
+int influxdb_destroy(NodeCompat *n);
+
 int influxdb_parse(NodeCompat *n, json_t *json);
 
 int influxdb_open(NodeCompat *n);
@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <atomic>
+
+#include <pthread.h>
+
 #include <librdkafka/rdkafka.h>
 
 #include <villas/format.hpp>
@@ -19,6 +23,15 @@ namespace node {
 // Forward declarations
 class NodeCompat;
 
+// A consumer of the group which runs in its own thread.
+struct KafkaConsumer {
+  rd_kafka_t *client;
+  rd_kafka_queue_t *queue; // Consumer queue of the client.
+  Format *formatter;       // Each thread decodes with its own formatter.
+  pthread_t thread;
+  NodeCompat *node;
+};
+
 struct kafka {
   struct CQueueSignalled queue;
   struct Pool pool;
@@ -33,11 +46,26 @@ struct kafka {
   struct {
     rd_kafka_t *client;
     rd_kafka_topic_t *topic;
+
+    int batch;          // Produce each sample as a separate message.
+    double linger;      // Time to wait for further messages (linger.ms).
+    int batch_size;     // Messages per batch (batch.num.messages).
+    size_t buffer_size; // Size of each message buffer.
+    unsigned buffers;   // Number of message buffers.
+
+    // Buffers are passed to librdkafka without a copy and returned to this
+    // pool by the delivery report callback.
+    struct Pool pool;
   } producer;
 
   struct {
-    rd_kafka_t *client;
     char *group_id; // Group id.
+
+    unsigned count; // Number of consumers in the group.
+    unsigned batch; // Maximum number of messages consumed at once.
+
+    struct KafkaConsumer *consumers;
+    std::atomic<bool> stopping;
   } consumer;
 
   struct {
@@ -51,6 +79,7 @@ struct kafka {
   } sasl;
 
   Format *formatter;
+  json_t *json_format; // Configuration of the formatters of the consumers.
 };
 
 int kafka_reverse(NodeCompat *n);
@@ -19,6 +19,7 @@ class LoopbackNode : public Node {
 
 protected:
   int queuelen;
+  int copy; // Copy samples instead of passing them on by reference.
   struct CQueueSignalled queue;
   enum QueueSignalledMode mode;
 
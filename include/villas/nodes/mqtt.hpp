@@ -7,6 +7,10 @@
 
 #pragma once
 
+#include <atomic>
+
+#include <pthread.h>
+
 #include <villas/format.hpp>
 #include <villas/pool.hpp>
 #include <villas/queue_signalled.h>
@@ -49,6 +53,22 @@ struct mqtt {
   } ssl;
 
   Format *formatter;
+
+  // Asynchronous publisher
+  struct {
+    unsigned queuelen; // Number of samples which can be queued.
+    int max_inflight;  // Maximum number of uncompleted messages.
+
+    std::atomic<int> inflight;   // Messages which have not been completed yet.
+    std::atomic<size_t> dropped; // Samples dropped by the publisher thread.
+    int stopping;
+
+    struct Pool pool;
+    struct CQueueSignalled queue;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; // Signalled when a message has been completed.
+    pthread_t thread;
+  } async;
 };
 
 int mqtt_reverse(NodeCompat *n);
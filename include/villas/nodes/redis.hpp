@@ -8,6 +8,7 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <unordered_map>
 
@@ -24,7 +25,7 @@
 namespace villas {
 namespace node {
 
-enum class RedisMode { KEY, HASH, CHANNEL };
+enum class RedisMode { KEY, HASH, CHANNEL, STREAM };
 
 inline std::ostream &operator<<(std::ostream &os,
                                 const enum villas::node::RedisMode &m) {
@@ -40,6 +41,10 @@ inline std::ostream &operator<<(std::ostream &os,
   case villas::node::RedisMode::CHANNEL:
     os << "channel";
     break;
+
+  case villas::node::RedisMode::STREAM:
+    os << "stream";
+    break;
   }
 
   return os;
@@ -95,6 +100,18 @@ struct redis {
 
   Format *formatter;
 
+  // Streams
+  long long maxlen;     // Approximate maximum number of entries in the stream.
+  std::string group;    // Consumer group, or empty for plain XREAD.
+  std::string consumer; // Name of this consumer within the group.
+  std::string last_id;  // ID after which the reader thread continues.
+
+  // Queues the commands of a single write on a dedicated connection.
+  std::unique_ptr<sw::redis::Pipeline> pipeline;
+
+  std::thread thread; // Reads new stream entries.
+  std::atomic<bool> stopping;
+
   struct Pool pool;
   struct CQueueSignalled queue;
 };
@@ -25,6 +25,11 @@ struct shmem {
   struct ShmemConfig conf;    // Interface configuration struct.
   char **exec;                // External program to execute on start.
   struct ShmemInterface intf; // Shmem interface
+
+  int broadcast;                   // Use broadcast rings instead of queues.
+  struct ShmemBroadcast bcast_in;  // Broadcast ring which is read.
+  struct ShmemBroadcast bcast_out; // Broadcast ring which is written.
+  uint64_t lost;                   // Samples missed by the broadcast reader.
 };
 
 char *shmem_print(NodeCompat *n);
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <pthread.h>
+#include <sys/socket.h>
+
 #include <villas/format.hpp>
 #include <villas/node/config.hpp>
 #include <villas/socket_addr.hpp>
@@ -16,15 +19,85 @@ namespace node {
 
 // Forward declarations
 class NodeCompat;
+struct SocketUring;
+struct SocketPacketRing;
 
 // The maximum length of a packet which contains stuct msg.
 #define SOCKET_INITIAL_BUFFER_LEN (64 * 1024)
 
+// The maximum length of a single datagram if batching is enabled.
+#define SOCKET_BATCH_BUFFER_LEN (16 * 1024)
+
+// The maximum number of datagrams per recvmmsg() / sendmmsg() call.
+#define SOCKET_MAX_BATCH 64
+
+// The maximum number of segments of a UDP GSO / GRO super-buffer.
+#define SOCKET_GSO_MAX_SEGMENTS 64
+
+// The maximum payload of a UDP GSO super-buffer (leaves room for headers).
+#define SOCKET_GSO_MAX_LEN (63 * 1024)
+
+// The length of the control message buffer of each received datagram.
+#define SOCKET_CONTROL_LEN 128
+
+// The number of receive and send buffers of the io_uring backend.
+#define SOCKET_URING_ENTRIES 64
+
+// The number of sent samples and datagrams for which TX timestamps are kept.
+#define SOCKET_TIMESTAMP_HISTORY 1024
+
+// The geometry of the memory-mapped rings of the packet_mmap backend.
+#define SOCKET_RING_BLOCK_SIZE (64 * 1024)
+#define SOCKET_RING_FRAME_SIZE 2048
+#define SOCKET_RING_RX_BLOCKS 64
+#define SOCKET_RING_TX_BLOCKS 8
+
+// The time after which a partially filled RX block is retired (in ms).
+#define SOCKET_RING_TIMEOUT 1
+
+enum class SocketBackend {
+  DEFAULT,    // Blocking system calls in the path thread.
+  IO_URING,   // Asynchronous I/O with io_uring(7).
+  PACKET_MMAP // Memory-mapped TPACKET_V3 rings of AF_PACKET sockets.
+};
+
+// The datagram in which a sample has been sent.
+struct SocketTxSample {
+  uint64_t sequence;
+  uint32_t key; // See SocketTxDatagram::key.
+};
+
+struct SocketTxDatagram {
+  uint32_t key;       // The SOF_TIMESTAMPING_OPT_ID of the datagram.
+  struct timespec ts; // The kernel TX timestamp or zero if not yet known.
+};
+
 struct Socket {
   int sd;     // The socket descriptor
   int clt_sd; // TCP client socket descriptor
   int verify_source; // Verify the source address of incoming packets against socket::remote.
   bool tcp_connected = false; // TCP connection status bit
+  int batch; // Use recvmmsg() / sendmmsg() with one sample per datagram.
+  int gso;   // Send bursts as a single UDP_SEGMENT super-buffer.
+  int gro;   // Receive coalesced datagrams (UDP_GRO).
+
+  // Kernel timestamps (SO_TIMESTAMPING)
+  struct {
+    int rx; // Take ts.received from the kernel RX timestamps.
+    int tx; // Keep the kernel TX timestamps of the sent samples.
+
+    uint32_t key; // The SOF_TIMESTAMPING_OPT_ID of the next datagram.
+
+    // Ring buffers indexed by the sample sequence and datagram key.
+    struct SocketTxSample *samples;
+    struct SocketTxDatagram *datagrams;
+
+    pthread_mutex_t mutex; // Shared by the sending and receiving threads.
+  } timestamping;
+
+  enum SocketBackend backend;    // The I/O backend used for this socket
+  struct SocketUring *uring;     // State of the io_uring backend or nullptr.
+  struct SocketPacketRing *ring; // State of the packet_mmap backend.
 
   enum SocketLayer
       layer; // The OSI / IP layer which should be used for this socket
@@ -43,6 +116,13 @@ struct Socket {
     char *buf; // Buffer for receiving messages
     size_t buflen;
     union sockaddr_union saddr; // Remote address of the socket
+
+    // Vectors for recvmmsg() / sendmmsg(). Only used if batching is enabled.
+    struct mmsghdr *msgs;
+    struct iovec *iovs;
+    union sockaddr_union *addrs; // Source addresses of received datagrams.
+    char *ctrl;                  // Control message buffers.
+    unsigned batchlen;           // Number of datagrams per system call.
   } in, out;
 };
 
@@ -64,6 +144,10 @@ int socket_reverse(NodeCompat *n);
 
 int socket_fds(NodeCompat *n, int fds[]);
 
+int socket_netem_fds(NodeCompat *n, int fds[]);
+
+int socket_tx_timestamp(NodeCompat *n, uint64_t sequence, struct timespec *ts);
+
 int socket_write(NodeCompat *n, struct Sample *const smps[], unsigned cnt);
 
 int socket_read(NodeCompat *n, struct Sample *const smps[], unsigned cnt);
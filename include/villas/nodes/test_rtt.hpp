@@ -44,6 +44,8 @@ protected:
     unsigned received_warmup;
     unsigned missed_warmup;
 
+    unsigned missing_tx; // Samples received without a kernel TX timestamp.
+
     struct timespec started;
     struct timespec stopped;
 
@@ -58,7 +60,7 @@ protected:
         : node(n), id(id), rate(rate), warmup(warmup), cooldown(cooldown),
           values(values), count(count), sent(0), received(0), missed(0),
           count_warmup(count_warmup), sent_warmup(0), received_warmup(0),
-          missed_warmup(0), filename(filename){};
+          missed_warmup(0), missing_tx(0), filename(filename){};
 
     int start();
     int stop();
@@ -77,6 +79,10 @@ protected:
 
   bool shutdown;
 
+  std::string tx_timestamps; // The node which sends the samples.
+  Node *tx_node;             // Provides the kernel TX timestamps.
+  struct Sample *tx_sample;  // A copy of the received sample with a new origin.
+
   int _read(struct Sample *smps[], unsigned cnt) override;
   int _write(struct Sample *smps[], unsigned cnt) override;
 
@@ -93,9 +99,9 @@ public:
 
   TestRTT(const uuid_t &id = {}, const std::string &name = "")
       : Node(id, name), task(), formatter(nullptr), stream(nullptr), current(),
-        shutdown(false) {}
+        shutdown(false), tx_node(nullptr), tx_sample(nullptr) {}
 
-  ~TestRTT() override{};
+  ~TestRTT() override;
 
   int prepare() override;
 
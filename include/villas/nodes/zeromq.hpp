@@ -27,6 +27,7 @@ namespace node {
 // Forward declarations
 class NodeCompat;
 struct Sample;
+struct ZeroMQPool;
 
 struct zeromq {
   int ipv6;
@@ -54,7 +55,18 @@ struct zeromq {
     struct List endpoints;
     char *filter;
     int bind, pending;
+    int hwm; // High water mark of the socket or -1 for the default.
   } in, out;
+
+  int multipart;      // Send each sample in a separate frame.
+  unsigned buffers;   // Number of send buffers.
+  size_t buffer_size; // Size of each send buffer.
+
+  /* Send buffers which are passed to ZeroMQ without a copy.
+   *
+   * It is allocated separately, as ZeroMQ might release buffers after the
+   * node has been stopped. */
+  struct ZeroMQPool *pool;
 };
 
 char *zeromq_print(NodeCompat *n);
@@ -7,7 +7,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <bitset>
+#include <memory>
 
 #include <fmt/ostream.h>
 #include <jansson.h>
@@ -24,6 +26,7 @@
 #include <villas/node_list.hpp>
 #include <villas/path_destination.hpp>
 #include <villas/path_source.hpp>
+#include <villas/path_trace.hpp>
 #include <villas/pool.hpp>
 #include <villas/queue.h>
 #include <villas/signal_list.hpp>
@@ -31,12 +34,14 @@
 
 // Forward declarations
 struct pollfd;
+struct epoll_event;
 
 namespace villas {
 namespace node {
 
 // Forward declarations
 class Node;
+class PathScheduler;
 
 // The datastructure for a path.
 class Path {
@@ -52,8 +57,16 @@ protected:
 
   void startPoll();
 
+  // Spin on the epoll set for at most busy_poll µs before blocking.
+  int waitBusy(struct epoll_event *evs, int maxevents);
+
   static int id;
 
+  PathScheduler *scheduler; // The shared worker pool or nullptr.
+
+  std::atomic<uint64_t> spinTime;  // Nanoseconds spent busy polling.
+  std::atomic<uint64_t> blockTime; // Nanoseconds spent blocked in the kernel.
+
 public:
   enum State state; // Path state.
 
@@ -66,6 +79,9 @@ public:
   uuid_t uuid;
 
   std::vector<struct pollfd> pfds;
+  std::vector<int> pfdSources; // Index of the source for each slot in pfds.
+                               // The timeout timer uses -1.
+  int epfd;                    // The epoll(7) set used by runPoll().
 
   struct Pool pool;
   struct Sample *last_sample;
@@ -80,10 +96,16 @@ public:
 
   struct Task timeout;
 
+  std::unique_ptr<PathTrace> trace; // Per-stage latency tracing or nullptr.
+
   double rate;              // A timeout for
   int affinity;             // Thread affinity.
   bool enabled;             // Is this path enabled?
   int poll;                 // Weather or not to use poll(2).
+  int thread;               // Use a dedicated thread instead of a worker.
+  int busy_poll;            // Spin budget in µs before blocking or 0.
+  int busy_poll_socket;     // SO_BUSY_POLL of socket-based sources in µs or 0.
+  bool busy_poll_pause;     // Use a CPU pause hint while spinning.
   bool reversed;            // This path has a matching reverse path.
   bool builtin;             // This path should use built-in hooks by default.
   int original_sequence_no; // Use original source sequence number when multiplexing
@@ -143,12 +165,20 @@ public:
   /* Start a path.
    *
    * Start a new pthread for receiving/sending messages over this path.
+   * If a scheduler is given, the path is assigned to one of its
+   * shared workers instead.
    */
-  void start();
+  void start(PathScheduler *sched = nullptr);
 
   // Stop a path.
   void stop();
 
+  // Handle a readiness event of the file descriptor in slot i of pfds.
+  void processEvent(unsigned i);
+
+  // Send all enqueued samples to the destination nodes.
+  void writeDestinations();
+
   // Get a list of signals which is emitted by the path.
   SignalList::Ptr getOutputSignals(bool after_hooks = true);
 
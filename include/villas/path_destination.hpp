@@ -41,11 +41,19 @@ public:
 
   void check();
 
-  static void enqueueAll(class Path *p, const struct Sample *const smps[],
+  /* Enqueue samples to all destinations of a path.
+   *
+   * The samples are not copied but shared between all destinations.
+   * Each destination queue takes its own reference.
+   */
+  static void enqueueAll(class Path *p, struct Sample *const smps[],
                          unsigned cnt);
 
   void write();
 
+  // Does the destination node alter samples in its write hooks?
+  bool hasWriteHooks() const;
+
   Node *getNode() const { return node; }
 };
 
@@ -0,0 +1,97 @@
+/* Shared worker pool for paths.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <jansson.h>
+#include <pthread.h>
+
+#include <villas/common.hpp>
+#include <villas/log.hpp>
+
+namespace villas {
+namespace node {
+
+// Forward declarations
+class Path;
+
+/* A pool of worker threads which multiplexes many paths (N:M scheduling).
+ *
+ * Each worker waits on a single epoll(7) set which contains the file
+ * descriptors of all path sources and timeout timers assigned to it.
+ * All file descriptors of a path are assigned to the same worker.
+ * Hence, a path is never processed by two threads at the same time.
+ */
+class PathScheduler {
+
+protected:
+  // A registration of a single poll slot of a path.
+  struct Event {
+    Path *path;    // Is set to nullptr after the path has been removed.
+    unsigned slot; // Index into Path::pfds.
+  };
+
+  struct Worker {
+    PathScheduler *scheduler;
+
+    pthread_t tid;
+    int epfd; // The epoll(7) set of this worker.
+    int efd;  // An eventfd(2) to wake-up the worker.
+    int cpu;  // The core to which the worker is pinned or -1.
+
+    unsigned paths; // Number of paths which are assigned to this worker.
+
+    std::atomic<bool> running;
+
+    // Held by the worker while it processes events.
+    std::mutex mutex;
+
+    // Registrations are kept until the worker is stopped.
+    std::list<std::unique_ptr<Event>> events;
+  };
+
+  enum State state;
+
+  unsigned numWorkers; // Number of worker threads. 0 disables the scheduler.
+  int affinity;        // Mask of cores to which the workers are pinned.
+
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  Logger logger;
+
+  static void *runWrapper(void *arg);
+
+  void run(Worker *w);
+
+public:
+  PathScheduler();
+  ~PathScheduler();
+
+  void parse(json_t *json);
+
+  void start();
+  void stop();
+
+  // Assign a started path to the least loaded worker.
+  void add(Path *p);
+
+  // Remove a path. Blocks until the path is not processed anymore.
+  void remove(Path *p);
+
+  bool isEnabled() const { return numWorkers > 0; }
+
+  unsigned getWorkerCount() const { return numWorkers; }
+};
+
+} // namespace node
+} // namespace villas
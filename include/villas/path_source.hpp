@@ -11,6 +11,7 @@
 #include <vector>
 
 #include <villas/mapping_list.hpp>
+#include <villas/mapping_plan.hpp>
 #include <villas/pool.hpp>
 
 namespace villas {
@@ -36,6 +37,7 @@ protected:
   struct Pool pool;
 
   MappingList mappings; // List of mappings (struct MappingEntry).
+  MappingPlan plan;     // Compiled version of the mappings above.
 
 public:
   PathSource(Path *p, Node *n);
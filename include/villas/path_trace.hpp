@@ -0,0 +1,103 @@
+/* Per-stage latency tracing of the path pipeline.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <jansson.h>
+
+#include <villas/hist.hpp>
+#include <villas/log.hpp>
+#include <villas/pool.hpp>
+#include <villas/sample.hpp>
+#include <villas/tsc.hpp>
+
+namespace villas {
+namespace node {
+
+/* Histograms of the time spent by samples in each stage of a path.
+ *
+ * The stage boundaries are taken with the time-stamp counter (TSC) of the
+ * CPU. The timestamps of each sample are kept in a table which is indexed by
+ * the block of the sample in the pool of the path. This keeps them out of
+ * struct Sample, whose layout is shared with external programs.
+ * A PathTrace is only updated by the thread which runs the path.
+ */
+class PathTrace {
+
+public:
+  enum class Stage {
+    READ,  // From the reception by the source node until its read() returned.
+    MUX,   // Forwarding to secondary sources and remapping.
+    HOOKS, // Path hooks.
+    QUEUE, // Waiting in the queue of a path destination.
+    WRITE, // Node::write() of the destination node including its output hooks.
+    TOTAL  // From the return of Node::read() until the end of the write.
+  };
+
+  // Stage boundaries of a sample which belongs to the pool of the path.
+  struct SampleTimes {
+    uint64_t read;     // When Node::read() of the source node returned.
+    uint64_t enqueued; // When the sample was enqueued to the destinations.
+  };
+
+  static constexpr unsigned NUM_STAGES = (unsigned)Stage::TOTAL + 1;
+
+protected:
+  struct Tsc tsc;
+
+  double period; // Duration of a single TSC cycle in seconds.
+
+  std::vector<Hist> histograms; // Indexed by Stage.
+
+  const struct Pool *pool;          // The pool of the path.
+  std::vector<SampleTimes> samples; // Indexed by the block of a sample in pool.
+
+public:
+  PathTrace(int buckets = 20, int warmup = 500);
+
+  uint64_t now() { return tsc_now(&tsc); }
+
+  // Count the delay between two TSC timestamps once for each of cnt samples.
+  void update(Stage s, uint64_t start, uint64_t end, unsigned cnt = 1) {
+    auto &h = histograms[(unsigned)s];
+    double delay = (end - start) * period;
+
+    for (unsigned i = 0; i < cnt; i++)
+      h.put(delay);
+  }
+
+  // Count a delay in seconds which has not been taken with the TSC.
+  void update(Stage s, double delay) { histograms[(unsigned)s].put(delay); }
+
+  void reset();
+
+  // Track the timestamps of the samples which are allocated from pool.
+  void setPool(const struct Pool *p);
+
+  // Get the timestamps of a sample or nullptr if it is not part of the pool.
+  SampleTimes *getTimes(const struct Sample *smp);
+
+  json_t *toJson() const;
+
+  // Print a single line with the mean and highest delay of each stage.
+  void printPeriodic(Logger logger) const;
+
+  // Print all histograms.
+  void print(Logger logger, bool details) const;
+
+  const Hist &getHistogram(Stage s) const {
+    return histograms[(unsigned)s];
+  }
+
+  static const char *stageToString(Stage s);
+};
+
+} // namespace node
+} // namespace villas
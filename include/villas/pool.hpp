@@ -9,7 +9,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 
 #include <sys/types.h>
 
@@ -20,6 +22,19 @@
 namespace villas {
 namespace node {
 
+enum class PoolFlags {
+  /* Put a per-thread cache (magazine) in front of the queue of the pool.
+   *
+   * Each thread keeps up to DEFAULT_POOL_CACHE_SIZE free blocks which are
+   * refilled from and flushed to the queue in batches. Blocks can be released
+   * by any thread. Threads which only release blocks return them to the queue
+   * directly. The pool must be sized with enough headroom for the blocks
+   * cached by all threads allocating from it. Must not be used for pools
+   * which are shared between processes.
+   */
+  THREAD_CACHE = (1 << 0)
+};
+
 // A thread-safe memory pool.
 struct Pool {
   enum State state;
@@ -30,10 +45,22 @@ struct Pool {
   size_t len;       // Length of the underlying memory area.
   size_t blocksz;   // Length of a block in bytes.
   size_t alignment; // Alignment of a block in bytes.
+  int flags;        // See enum PoolFlags.
+
+  // Cache statistics of threads which have already exited.
+  std::atomic<uint64_t> cache_hits;
+  std::atomic<uint64_t> cache_misses;
 
   struct CQueue queue; // The queue which is used to keep track of free blocks.
 };
 
+// Statistics of the per-thread caches of a pool.
+struct PoolCacheStats {
+  uint64_t hits;   // Operations which were served by the cache.
+  uint64_t misses; // Operations which needed to access the queue.
+  size_t cached;   // Blocks currently held by the caches of all threads.
+};
+
 const char *pool_buffer(const struct Pool *pool);
 
 /* Initialize a pool.
@@ -42,11 +69,12 @@ const char *pool_buffer(const struct Pool *pool);
  * @param[in] cnt The total number of blocks which are reserverd by this pool.
  * @param[in] blocksz The size in bytes per block.
  * @param[in] mem The type of memory which should be used for this pool.
+ * @param[in] flags A bitmask of enum PoolFlags.
  * @retval 0 The pool has been successfully initialized.
  * @retval <>0 There was an error during the pool initialization.
  */
 int pool_init(struct Pool *p, size_t cnt, size_t blocksz,
-              struct memory::Type *mem = memory::default_type)
+              struct memory::Type *mem = memory::default_type, int flags = 0)
     __attribute__((warn_unused_result));
 
 // Destroy and release memory used by pool.
@@ -69,5 +97,11 @@ void *pool_get(struct Pool *p);
 // Release a memory block back to the pool.
 int pool_put(struct Pool *p, void *buf);
 
+// Return the blocks cached by the calling thread to the pool.
+void pool_cache_flush(struct Pool *p);
+
+// Get the statistics of the per-thread caches of a pool.
+struct PoolCacheStats pool_cache_stats(const struct Pool *p);
+
 } // namespace node
 } // namespace villas
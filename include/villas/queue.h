@@ -48,6 +48,12 @@ namespace node {
 
 typedef char cacheline_pad_t[CACHELINE_SIZE];
 
+enum class QueueFlags {
+  /* Only a single thread pushes to and a single thread pulls from the queue.
+   * This enables a faster ring buffer implementation. */
+  SPSC = (1 << 0)
+};
+
 struct CQueue_cell {
   std::atomic<size_t> sequence;
   off_t data_off; // Pointer relative to the queue struct
@@ -61,21 +67,27 @@ struct CQueue {
 
   size_t buffer_mask;
   off_t buffer_off; // Relative pointer to struct CQueue_cell[]
+  int flags;        // See enum QueueFlags
 
   cacheline_pad_t _pad1; // Producer area: only producers read & write
 
   std::atomic<size_t> tail; // Queue tail pointer
+  size_t head_cache;        // Last head seen by the SPSC producer
 
   cacheline_pad_t _pad2; // Consumer area: only consumers read & write
 
   std::atomic<size_t> head; // Queue head pointer
+  size_t tail_cache;        // Last tail seen by the SPSC consumer
 
   cacheline_pad_t _pad3; // TODO: Why needed?
 };
 
-// Initialize MPMC queue
+/* Initialize queue
+ *
+ * @param flags A bitmask of enum QueueFlags.
+ */
 int queue_init(struct CQueue *q, size_t size,
-               struct memory::Type *mem = memory::default_type)
+               struct memory::Type *mem = memory::default_type, int flags = 0)
     __attribute__((warn_unused_result));
 
 // Desroy MPMC queue and release memory
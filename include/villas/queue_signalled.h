@@ -21,11 +21,16 @@ enum class QueueSignalledMode {
   POLLING,
 #ifdef HAS_EVENTFD
   EVENTFD,
-
+#endif
+#ifdef __linux__
+  FUTEX, // Also works between processes
 #endif
 };
 
-enum class QueueSignalledFlags { PROCESS_SHARED = (1 << 4) };
+enum class QueueSignalledFlags {
+  SPSC = (int)QueueFlags::SPSC, // Passed to the underlying queue.
+  PROCESS_SHARED = (1 << 4)
+};
 
 // Wrapper around queue that uses POSIX CV's for signalling writes.
 struct CQueueSignalled {
@@ -41,6 +46,11 @@ struct CQueueSignalled {
     } pthread;
 #ifdef __linux__
     int eventfd;
+
+    struct {
+      uint32_t seq;     // Incremented after each push.
+      uint32_t waiters; // Number of threads blocked in a pull.
+    } futex;
 #endif
   };
 };
@@ -134,6 +134,15 @@ int sample_copy_many(struct Sample *const dsts[],
 int sample_incref_many(struct Sample *const smps[], int cnt);
 int sample_decref_many(struct Sample *const smps[], int cnt);
 
+/* Replace shared samples in \p smps by private copies (copy-on-write).
+ *
+ * Samples for which the caller already holds the only reference are left untouched.
+ * The references to the original samples are released.
+ *
+ * @return The number of samples which have been copied or -1 on pool underrun.
+ */
+int sample_unshare_many(struct Sample *smps[], int cnt);
+
 enum SignalType sample_format(const struct Sample *s, unsigned idx);
 
 void sample_data_insert(struct Sample *smp, const union SignalData *src,
@@ -0,0 +1,104 @@
+/* Column-major view on a batch of samples.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <villas/config.hpp>
+
+namespace villas {
+namespace node {
+
+// Forward declarations
+struct Sample;
+
+// Allocator which places the storage of a container at a cache line boundary.
+template <typename T> struct CachelineAllocator {
+  using value_type = T;
+
+  CachelineAllocator() = default;
+
+  template <typename U>
+  CachelineAllocator(const CachelineAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(CACHELINE_SIZE)));
+  }
+
+  void deallocate(T *p, size_t) noexcept {
+    ::operator delete(p, std::align_val_t(CACHELINE_SIZE));
+  }
+
+  template <typename U>
+  bool operator==(const CachelineAllocator<U> &) const noexcept {
+    return true;
+  }
+};
+
+/* A batch of samples transposed into signal-major columns.
+ *
+ * struct Sample stores the values of a single sample contiguously.
+ * Kernels which operate per signal over time (e.g. windowed filters) are
+ * better served by contiguous columns which the compiler can vectorize.
+ *
+ * gather() copies the selected signals of a batch into one column per signal.
+ * scatter() writes the columns back into the samples.
+ * Each column starts at a cache line boundary.
+ * Only signals of type float are supported.
+ */
+class SampleBlock {
+
+protected:
+  std::vector<unsigned> indices; // Signal index of each column.
+  std::vector<double, CachelineAllocator<double>>
+      values; // Storage of all columns.
+
+  unsigned count;  // Number of samples in the block.
+  unsigned stride; // Distance between the start of two columns.
+
+  void resize(unsigned cnt);
+
+public:
+  SampleBlock() : count(0), stride(0) {}
+
+  /* Transpose the signals in \p idx of \p cnt samples into columns.
+   *
+   * Memory is reused between calls as long as the block does not grow.
+   */
+  template <typename Container>
+  void gather(struct Sample *const smps[], unsigned cnt, const Container &idx) {
+    indices.assign(idx.begin(), idx.end());
+
+    resize(cnt);
+
+    for (unsigned col = 0; col < indices.size(); col++)
+      gatherColumn(smps, col);
+  }
+
+  // Write the columns back into the samples they have been gathered from.
+  void scatter(struct Sample *const smps[]) const;
+
+  void gatherColumn(struct Sample *const smps[], unsigned col);
+
+  void scatterColumn(struct Sample *const smps[], unsigned col) const;
+
+  // Get the values of the column \p col over all samples of the block.
+  double *column(unsigned col) { return &values[col * stride]; }
+
+  const double *column(unsigned col) const { return &values[col * stride]; }
+
+  unsigned getColumnCount() const { return indices.size(); }
+
+  unsigned getCount() const { return count; }
+};
+
+} // namespace node
+} // namespace villas
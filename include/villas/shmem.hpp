@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+
 #include <villas/pool.hpp>
 #include <villas/queue.h>
 #include <villas/queue_signalled.h>
@@ -15,6 +18,9 @@
 #define DEFAULT_SHMEM_QUEUELEN 512u
 #define DEFAULT_SHMEM_SAMPLELEN 64u
 
+#define SHMEM_BROADCAST_MAGIC 0x56425243 // "VBRC"
+#define SHMEM_BROADCAST_VERSION 1
+
 namespace villas {
 namespace node {
 
@@ -24,6 +30,9 @@ struct ShmemConfig {
   int polling;   // Whether to use polling instead of POSIX CVs
   int queuelen;  // Size of the queues (in elements)
   int samplelen; // Maximum number of data entries in a single sample
+
+  // Signalling mode of the queues, unless polling is set
+  enum QueueSignalledMode mode;
 };
 
 // The structure that actually resides in the shared memory.
@@ -47,6 +56,56 @@ struct ShmemInterface {
   std::atomic<int> readers, writers, closed;
 };
 
+/* Header of a broadcast ring in shared memory.
+ *
+ * A broadcast ring has a single writer and any number of readers, which
+ * attach and detach at any time. Each reader keeps its own cursor. The
+ * writer never waits for readers: slow readers lose the overwritten samples.
+ *
+ * The header is followed by `slots` slots of `slotsize` bytes each. Readers
+ * in other languages can rely on this layout.
+ */
+struct ShmemBroadcastShared {
+  uint32_t magic;     // SHMEM_BROADCAST_MAGIC
+  uint32_t version;   // SHMEM_BROADCAST_VERSION
+  uint32_t slots;     // Number of slots (a power of two).
+  uint32_t slotsize;  // Size of a slot in bytes.
+  uint32_t samplelen; // Maximum number of values in a slot.
+  uint32_t closed;    // Set by the writer before it detaches.
+  uint32_t futex;     // Incremented after each write.
+  uint32_t waiters;   // Number of readers blocked on futex.
+  uint64_t head;      // Position of the next sample written.
+};
+
+/* A slot of a broadcast ring.
+ *
+ * The writer sets pos to UINT64_MAX while it updates the slot and to the
+ * position of the sample afterwards. Readers check that pos did not change
+ * while they copied the slot.
+ */
+struct ShmemBroadcastSlot {
+  uint64_t pos;
+  uint64_t sequence;
+  struct timespec ts_origin;
+  struct timespec ts_received;
+  uint32_t flags;
+  uint32_t length;
+  union SignalData data[];
+};
+
+// A process-local handle of a broadcast ring.
+struct ShmemBroadcast {
+  const char *name;                    // Name of the shmem object.
+  void *base;                          // Base address of the mapping.
+  size_t len;                          // Total size of the mapping.
+  struct ShmemBroadcastShared *shared; // Header of the ring.
+  uint64_t cursor;                     // Position of the next sample read.
+  uint64_t lost;                       // Number of samples missed.
+  bool writer;                         // Attached as the writer.
+  std::atomic<bool> closing;           // Set by shmem_bcast_close().
+  std::atomic<unsigned> active;        // Threads in shmem_bcast_read().
+};
+
 /* Open the shared memory objects and retrieve / initialize the shared data structures.
  * Blocks until another process connects by opening the same objects.
  *
@@ -55,11 +114,15 @@ struct ShmemInterface {
  * @param[inout] shm The shmem_int structure that should be used for following
  * calls will be written to this pointer.
  * @param[in] conf Configuration parameters for the output queue.
+ * @param[in] peer If positive, give up once this child process has exited.
+ * @param[in] timeout Give up after this many seconds, or never if negative.
  * @retval 0 The objects were opened and initialized successfully.
- * @retval <0 An error occured; errno is set accordingly.
+ * @retval <0 An error occured; errno is set accordingly. errno is ECHILD if
+ * the peer exited and ETIMEDOUT if the timeout expired.
  */
 int shmem_int_open(const char *wname, const char *rname,
-                   struct ShmemInterface *shm, struct ShmemConfig *conf);
+                   struct ShmemInterface *shm, struct ShmemConfig *conf,
+                   pid_t peer = 0, double timeout = -1);
 
 /* Close and destroy the shared memory interface and related structures.
  *
@@ -108,5 +171,56 @@ int shmem_int_alloc(struct ShmemInterface *shm, struct Sample *smps[],
  * per struct Sample. */
 size_t shmem_total_size(int queuelen, int samplelen);
 
+/* Create a broadcast ring and attach to it as its writer.
+ *
+ * @param name Name of the POSIX shared memory object.
+ * @param bc The handle which is initialized by this function.
+ * @param slots Number of slots in the ring. Rounded up to a power of two.
+ * @param samplelen Maximum number of values per sample.
+ * @retval 0 The ring has been created.
+ * @retval <0 An error occurred; errno is set accordingly.
+ */
+int shmem_bcast_create(const char *name, struct ShmemBroadcast *bc, int slots,
+                       int samplelen);
+
+/* Attach to an existing broadcast ring as a reader.
+ *
+ * The reader only receives samples which are written after it attached.
+ *
+ * @retval 0 Attached successfully.
+ * @retval <0 The ring does not exist (yet) or is invalid; errno is set.
+ */
+int shmem_bcast_attach(const char *name, struct ShmemBroadcast *bc);
+
+/* Detach from a broadcast ring.
+ *
+ * If called by the writer, readers are woken up and the shared memory object
+ * is unlinked. Readers keep their mapping until they detach themselves.
+ *
+ * Threads which are blocked in shmem_bcast_read() on this handle are woken
+ * up, and the mapping is only removed after they have returned.
+ */
+int shmem_bcast_close(struct ShmemBroadcast *bc);
+
+/* Write samples to all readers of a broadcast ring.
+ *
+ * @return Number of samples written. Values which do not fit into a slot are
+ * truncated.
+ */
+int shmem_bcast_write(struct ShmemBroadcast *bc,
+                      const struct Sample *const smps[], unsigned cnt);
+
+/* Read samples from a broadcast ring.
+ *
+ * Blocks until at least one sample is available. The samples are copied
+ * from the ring into the samples provided by the caller.
+ *
+ * @retval >0 Number of samples read.
+ * @retval -1 The writer closed the ring and all samples have been read, or
+ * the handle is being closed.
+ */
+int shmem_bcast_read(struct ShmemBroadcast *bc, struct Sample *const smps[],
+                     unsigned cnt);
+
 } // namespace node
 } // namespace villas
@@ -50,7 +50,23 @@ public:
     // RTP metrics
     RTP_LOSS_FRACTION, // Fraction lost since last RTP SR/RR.
     RTP_PKTS_LOST,     // Cumul. no. pkts lost.
-    RTP_JITTER         // Interarrival jitter.
+    RTP_JITTER,        // Interarrival jitter.
+
+    // Socket metrics
+    SOCKET_BATCH_RECV, // Datagrams received per recvmmsg() call.
+    SOCKET_BATCH_SENT, // Datagrams sent per sendmmsg() call.
+
+    // File metrics
+    FILE_WRITE_LATENCY, // Duration of write() calls of the asynchronous writer.
+    FILE_DROPPED,       // Samples dropped due to a full write queue.
+
+    // InfluxDB metrics
+    INFLUXDB_DROPPED, // Samples dropped due to a full send buffer.
+
+    // MQTT metrics
+    MQTT_DROPPED, // Samples dropped due to a full queue or failed publish.
+    MQTT_QUEUED,  // Samples waiting for the publisher.
+    MQTT_INFLIGHT // Messages handed to libmosquitto but not yet completed.
   };
 
   enum class Type { LAST, HIGHEST, LOWEST, MEAN, VAR, STDDEV, TOTAL };
@@ -86,6 +102,9 @@ public:
 
   void update(enum Metric id, double val);
 
+  // Update a metric with multiple values at once.
+  void update(enum Metric id, const double vals[], unsigned cnt);
+
   void reset();
 
   json_t *toJson() const;
@@ -24,6 +24,7 @@ extern "C" {
 #include <villas/node.hpp>
 #include <villas/node_list.hpp>
 #include <villas/path_list.hpp>
+#include <villas/path_scheduler.hpp>
 #include <villas/task.hpp>
 #include <villas/web.hpp>
 
@@ -45,6 +46,7 @@ protected:
 
   NodeList nodes;
   PathList paths;
+  PathScheduler scheduler; // Optional shared worker pool for paths.
   std::list<kernel::Interface *> interfaces;
 
 #ifdef WITH_API
@@ -122,6 +124,8 @@ public:
 
   PathList &getPaths() { return paths; }
 
+  PathScheduler &getScheduler() { return scheduler; }
+
   std::list<kernel::Interface *> &getInterfaces() { return interfaces; }
 
   enum State getState() const { return state; }
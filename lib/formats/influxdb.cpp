@@ -0,0 +1,197 @@
+/* InfluxDB line protocol.
+ *
+ * See: https://docs.influxdata.com/influxdb/v1/write_protocols/line_protocol_reference/
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include <villas/exceptions.hpp>
+#include <villas/formats/influxdb.hpp>
+#include <villas/sample.hpp>
+#include <villas/signal.hpp>
+
+using namespace villas;
+using namespace villas::node;
+
+/* Appends n bytes to buf.
+ *
+ * Like snprintf(), the returned offset also accounts for the bytes which did
+ * not fit into the buffer. */
+static size_t append(char *buf, size_t len, size_t off, const char *str,
+                     size_t n) {
+  if (off < len)
+    memcpy(buf + off, str, std::min(n, len - off));
+
+  return off + n;
+}
+
+static size_t append(char *buf, size_t len, size_t off,
+                     const std::string &str) {
+  return append(buf, len, off, str.data(), str.size());
+}
+
+template <typename T>
+static size_t appendNumber(char *buf, size_t len, size_t off, T value) {
+  char tmp[32];
+
+  auto res = std::to_chars(tmp, tmp + sizeof(tmp), value);
+
+  return append(buf, len, off, tmp, res.ptr - tmp);
+}
+
+void InfluxDBFormat::updateFields(const SignalList::Ptr sigs) {
+  fields.clear();
+
+  for (unsigned i = 0; i < sigs->size(); i++) {
+    auto sig = sigs->getByIndex(i);
+    auto name = sig->name.empty() ? fmt::format("signal{}", i) : sig->name;
+
+    // Commas, equal signs and spaces must be escaped in field keys
+    std::string field;
+    for (char c : name) {
+      if (c == ',' || c == '=' || c == ' ')
+        field += '\\';
+
+      field += c;
+    }
+
+    fields.push_back(field);
+  }
+
+  fields_signals = sigs;
+}
+
+size_t InfluxDBFormat::sprintLine(char *buf, size_t len,
+                                  const struct Sample *smp) {
+  size_t off = 0;
+  bool first = true;
+
+  if (smp->signals != fields_signals)
+    updateFields(smp->signals);
+
+  // Key
+  off = append(buf, len, off, key);
+
+  // Fields
+  if (flags & (int)SampleFlags::HAS_DATA) {
+    for (unsigned j = 0; j < smp->length && j < fields.size(); j++) {
+      const auto *data = &smp->data[j];
+      auto sig = smp->signals->getByIndex(j);
+
+      // InfluxDB has no representation for NaN and infinity
+      switch (sig->type) {
+      case SignalType::FLOAT:
+        if (!std::isfinite(data->f))
+          continue;
+        break;
+
+      case SignalType::COMPLEX:
+        if (!std::isfinite(std::real(data->z)) ||
+            !std::isfinite(std::imag(data->z)))
+          continue;
+        break;
+
+      case SignalType::BOOLEAN:
+      case SignalType::INTEGER:
+        break;
+
+      default:
+        continue;
+      }
+
+      off = append(buf, len, off, first ? " " : ",", 1);
+      first = false;
+
+      off = append(buf, len, off, fields[j]);
+
+      switch (sig->type) {
+      case SignalType::BOOLEAN:
+        off = append(buf, len, off, data->b ? "=true" : "=false",
+                     data->b ? 5 : 6);
+        break;
+
+      case SignalType::FLOAT:
+        off = append(buf, len, off, "=", 1);
+        off = appendNumber(buf, len, off, data->f);
+        break;
+
+      // Integers are written without the 'i' suffix for compatibility with
+      // existing measurements which store them as floats.
+      case SignalType::INTEGER:
+        off = append(buf, len, off, "=", 1);
+        off = appendNumber(buf, len, off, data->i);
+        break;
+
+      case SignalType::COMPLEX:
+        off = append(buf, len, off, "_re=", 4);
+        off = appendNumber(buf, len, off, std::real(data->z));
+        off = append(buf, len, off, ",", 1);
+        off = append(buf, len, off, fields[j]);
+        off = append(buf, len, off, "_im=", 4);
+        off = appendNumber(buf, len, off, std::imag(data->z));
+        break;
+
+      default: {
+      }
+      }
+    }
+  }
+
+  // A line without any field is rejected by the server
+  if (first)
+    return 0;
+
+  // Timestamp in nanoseconds
+  if (flags & (int)SampleFlags::HAS_TS_ORIGIN &&
+      smp->flags & (int)SampleFlags::HAS_TS_ORIGIN) {
+    int64_t ts = (int64_t)smp->ts.origin.tv_sec * 1000000000LL +
+                 smp->ts.origin.tv_nsec;
+
+    off = append(buf, len, off, " ", 1);
+    off = appendNumber(buf, len, off, ts);
+  }
+
+  off = append(buf, len, off, &delimiter, 1);
+
+  return off;
+}
+
+size_t InfluxDBFormat::sscanLine(const char *buf, size_t len,
+                                 struct Sample *smp) {
+  return 0; // Unused as sscan() is not supported
+}
+
+int InfluxDBFormat::sscan(const char *buf, size_t len, size_t *rbytes,
+                          struct Sample *const smps[], unsigned cnt) {
+  return -1;
+}
+
+void InfluxDBFormat::parse(json_t *json) {
+  int ret;
+  json_error_t err;
+  const char *k = nullptr;
+
+  ret = json_unpack_ex(json, &err, 0, "{ s?: s }", "key", &k);
+  if (ret)
+    throw ConfigError(json, err, "node-config-format-influxdb",
+                      "Failed to parse format configuration");
+
+  if (k)
+    key = k;
+
+  LineFormat::parse(json);
+}
+
+// Register format
+static char n[] = "influxdb";
+static char d[] = "InfluxDB line protocol";
+static LineFormatPlugin<InfluxDBFormat, n, d,
+                        (int)SampleFlags::HAS_TS_ORIGIN |
+                            (int)SampleFlags::HAS_DATA>
+    p;
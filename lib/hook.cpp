@@ -12,6 +12,7 @@
 #include <villas/node/config.hpp>
 #include <villas/node/exceptions.hpp>
 #include <villas/path.hpp>
+#include <villas/sample.hpp>
 #include <villas/signal_list.hpp>
 #include <villas/timing.hpp>
 #include <villas/utils.hpp>
@@ -29,6 +30,29 @@ Hook::Hook(Path *p, Node *n, int fl, int prio, bool en)
       flags(fl), priority(prio), enabled(en), path(p), node(n),
       signals(std::make_shared<SignalList>()), config(nullptr) {}
 
+Hook::Reason Hook::processMany(struct Sample *smps[], unsigned cnt,
+                               Reason reasons[]) {
+  for (unsigned i = 0; i < cnt; i++) {
+    reasons[i] = process(smps[i]);
+    if (reasons[i] == Reason::ERROR)
+      return Reason::ERROR;
+  }
+
+  return Reason::OK;
+}
+
+bool Hook::hasUniformSignals(struct Sample *const smps[], unsigned cnt) {
+  if (cnt == 0)
+    return false;
+
+  for (unsigned i = 1; i < cnt; i++) {
+    if (smps[i]->signals != smps[0]->signals)
+      return false;
+  }
+
+  return true;
+}
+
 void Hook::prepare(SignalList::Ptr sigs) {
   assert(state == State::CHECKED);
 
@@ -104,37 +104,70 @@ skip_add:
   }
 }
 
+/* Samples are processed hook by hook in batches.
+ *
+ * Samples which are skipped or which stopped processing are removed from the
+ * batch which is passed to the following hooks.
+ */
 int HookList::process(struct Sample *smps[], unsigned cnt) {
-  unsigned current, processed = 0;
+  unsigned current, active = cnt, processed = 0;
 
   if (size() == 0)
     return cnt;
 
+  struct Sample *batch[cnt];
+  unsigned origin[cnt]; // Index of batch[i] in smps[].
+  bool skipped[cnt];
+  Hook::Reason reasons[cnt];
+
   for (current = 0; current < cnt; current++) {
-    struct Sample *smp = smps[current];
+    batch[current] = smps[current];
+    origin[current] = current;
+    skipped[current] = false;
+  }
+
+  for (auto h : *this) {
+    if (active == 0)
+      break;
 
-    for (auto h : *this) {
-      auto ret = h->process(smp);
-      smp->signals = h->getSignals();
-      switch (ret) {
+    auto ret = h->processMany(batch, active, reasons);
+    if (ret == Hook::Reason::ERROR)
+      return -1;
+
+    auto sigs = h->getSignals();
+
+    unsigned remaining = 0;
+    for (current = 0; current < active; current++) {
+      batch[current]->signals = sigs;
+
+      switch (reasons[current]) {
       case Hook::Reason::ERROR:
         return -1;
 
       case Hook::Reason::OK:
-        continue;
+        batch[remaining] = batch[current];
+        origin[remaining] = origin[current];
+        remaining++;
+        break;
 
       case Hook::Reason::SKIP_SAMPLE:
-        goto skip;
+        skipped[origin[current]] = true;
+        break;
 
       case Hook::Reason::STOP_PROCESSING:
-        goto stop;
+        break;
       }
     }
 
-  stop:
+    active = remaining;
+  }
+
+  for (current = 0; current < cnt; current++) {
+    if (skipped[current])
+      continue;
+
     std::swap(smps[processed], smps[current]);
     processed++;
-  skip: {}
   }
 
   return processed;
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/sample.hpp>
 
@@ -87,6 +89,27 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    if (!hasUniformSignals(smps, cnt))
+      return Hook::processMany(smps, cnt, reasons);
+
+    for (auto index : signalIndices) {
+      auto orig_type = smps[0]->signals->getByIndex(index)->type;
+      auto new_type = signals->getByIndex(index)->type;
+
+      for (unsigned i = 0; i < cnt; i++)
+        smps[i]->data[index] =
+            smps[i]->data[index].cast(orig_type, new_type);
+    }
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
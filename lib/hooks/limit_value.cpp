@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/node/exceptions.hpp>
 #include <villas/sample.hpp>
@@ -70,6 +72,47 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    if (!hasUniformSignals(smps, cnt))
+      return Hook::processMany(smps, cnt, reasons);
+
+    for (auto index : signalIndices) {
+      switch (sample_format(smps[0], index)) {
+      case SignalType::INTEGER:
+        for (unsigned i = 0; i < cnt; i++) {
+          auto &v = smps[i]->data[index].i;
+          if (v > max)
+            v = max;
+          if (v < min)
+            v = min;
+        }
+        break;
+
+      case SignalType::FLOAT:
+        for (unsigned i = 0; i < cnt; i++) {
+          auto &v = smps[i]->data[index].f;
+          if (v > max)
+            v = max;
+          if (v < min)
+            v = min;
+        }
+        break;
+
+      case SignalType::INVALID:
+      case SignalType::COMPLEX:
+      case SignalType::BOOLEAN:
+        return Hook::Reason::ERROR; // not supported
+      }
+    }
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/sample.hpp>
 
@@ -88,6 +90,37 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    /* The accumulator is shared by all signals.
+     * Hence, we must keep the order of processing sample by sample. */
+    for (unsigned j = 0; j < cnt; j++) {
+      unsigned pos = smpMemoryPosition % windowSize;
+      unsigned next = (smpMemoryPosition + 1) % windowSize;
+      unsigned i = 0;
+
+      for (auto index : signalIndices) {
+        auto &history = smpMemory[i++];
+        double newValue = smps[j]->data[index].f;
+
+        history[pos] = newValue;
+
+        accumulator += newValue;
+        accumulator -= history[next];
+
+        smps[j]->data[index].f = accumulator / windowSize;
+      }
+
+      smpMemoryPosition++;
+    }
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
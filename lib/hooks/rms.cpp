@@ -5,8 +5,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/sample.hpp>
+#include <villas/sample_block.hpp>
 
 namespace villas {
 namespace node {
@@ -20,6 +23,8 @@ protected:
   unsigned windowSize;
   uint64_t smpMemoryPosition;
 
+  SampleBlock block;
+
 public:
   RMSHook(Path *p, Node *n, int fl, int prio, bool en = true)
       : MultiSignalHook(p, n, fl, prio, en), smpMemory(), windowSize(0),
@@ -40,6 +45,7 @@ public:
 
     /* Initialize memory for each channel*/
     smpMemory.clear();
+    accumulator.clear();
     for (unsigned i = 0; i < signalIndices.size(); i++) {
       accumulator.push_back(0.0);
       smpMemory.emplace_back(windowSize, 0.0);
@@ -87,10 +93,10 @@ public:
       smpMemory[i][smpMemoryPosition % windowSize] = newValue;
 
       // Update the accumulator
-      accumulator[index] += newValue;
-      accumulator[index] -= oldValue;
+      accumulator[i] += newValue;
+      accumulator[i] -= oldValue;
 
-      auto rms = pow(accumulator[index] / windowSize, 0.5);
+      auto rms = pow(accumulator[i] / windowSize, 0.5);
 
       smp->data[index].f = rms;
       i++;
@@ -100,6 +106,42 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    // Signals are independent. So we process the batch signal by signal.
+    block.gather(smps, cnt, signalIndices);
+
+    for (unsigned i = 0; i < block.getColumnCount(); i++) {
+      double *values = block.column(i);
+      auto &history = smpMemory[i];
+      auto &acc = accumulator[i];
+
+      for (unsigned j = 0; j < cnt; j++)
+        values[j] = pow(values[j], 2);
+
+      for (unsigned j = 0; j < cnt; j++) {
+        unsigned pos = (smpMemoryPosition + j) % windowSize;
+
+        acc += values[j];
+        acc -= history[pos];
+
+        history[pos] = values[j];
+
+        values[j] = pow(acc / windowSize, 0.5);
+      }
+    }
+
+    block.scatter(smps);
+
+    smpMemoryPosition += cnt;
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/sample.hpp>
 
@@ -60,6 +62,47 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    if (!hasUniformSignals(smps, cnt))
+      return Hook::processMany(smps, cnt, reasons);
+
+    double factor = pow(10, precision);
+
+    // All samples share the same signal types
+    for (auto index : signalIndices) {
+      switch (sample_format(smps[0], index)) {
+      case SignalType::FLOAT:
+        for (unsigned i = 0; i < cnt; i++) {
+          assert(index < smps[i]->length);
+
+          auto &f = smps[i]->data[index].f;
+          f = round(f * factor) / factor;
+        }
+        break;
+
+      case SignalType::COMPLEX:
+        for (unsigned i = 0; i < cnt; i++) {
+          assert(index < smps[i]->length);
+
+          auto &z = smps[i]->data[index].z;
+          z = std::complex<float>(round(z.real() * factor) / factor,
+                                  round(z.imag() * factor) / factor);
+        }
+        break;
+
+      default: {
+      }
+      }
+    }
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
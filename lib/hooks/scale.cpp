@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+
 #include <villas/hook.hpp>
 #include <villas/sample.hpp>
 
@@ -65,6 +67,53 @@ public:
 
     return Reason::OK;
   }
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    assert(state == State::STARTED);
+
+    if (!hasUniformSignals(smps, cnt))
+      return Hook::processMany(smps, cnt, reasons);
+
+    // All samples share the same signal types
+    for (auto index : signalIndices) {
+      switch (sample_format(smps[0], index)) {
+      case SignalType::INTEGER:
+        for (unsigned i = 0; i < cnt; i++) {
+          assert(index < smps[i]->length);
+
+          smps[i]->data[index].i *= scale;
+          smps[i]->data[index].i += offset;
+        }
+        break;
+
+      case SignalType::FLOAT:
+        for (unsigned i = 0; i < cnt; i++) {
+          assert(index < smps[i]->length);
+
+          smps[i]->data[index].f *= scale;
+          smps[i]->data[index].f += offset;
+        }
+        break;
+
+      case SignalType::COMPLEX:
+        for (unsigned i = 0; i < cnt; i++) {
+          assert(index < smps[i]->length);
+
+          smps[i]->data[index].z *= scale;
+          smps[i]->data[index].z += offset;
+        }
+        break;
+
+      default: {
+      }
+      }
+    }
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Reason::OK;
+  }
 };
 
 // Register hook
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <memory>
 
 #include <villas/common.hpp>
@@ -33,6 +34,9 @@ public:
   }
 
   Hook::Reason process(struct Sample *smp) override;
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override;
 };
 
 class StatsReadHook : public Hook {
@@ -67,7 +71,12 @@ public:
     state = State::STOPPED;
   }
 
+  void update(const struct Sample *smp, const struct Sample *prev);
+
   Hook::Reason process(struct Sample *smp) override;
+
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override;
 };
 
 class StatsHook : public Hook {
@@ -146,6 +155,16 @@ public:
     return Hook::Reason::OK;
   }
 
+  Hook::Reason processMany(struct Sample *smps[], unsigned cnt,
+                           Reason reasons[]) override {
+    if (!node)
+      return readHook->processMany(smps, cnt, reasons);
+
+    std::fill(reasons, reasons + cnt, Reason::OK);
+
+    return Hook::Reason::OK;
+  }
+
   void periodic() override {
     assert(state == State::STARTED);
 
@@ -205,29 +224,50 @@ Hook::Reason StatsWriteHook::process(struct Sample *smp) {
   return Reason::OK;
 }
 
-Hook::Reason StatsReadHook::process(struct Sample *smp) {
-  if (last) {
-    if (smp->flags & last->flags & (int)SampleFlags::HAS_TS_RECEIVED)
+Hook::Reason StatsWriteHook::processMany(struct Sample *smps[], unsigned cnt,
+                                         Reason reasons[]) {
+  timespec now = time_now();
+  double ages[cnt];
+
+  // All samples of a batch are written at the same time
+  for (unsigned i = 0; i < cnt; i++) {
+    ages[i] = time_delta(&smps[i]->ts.received, &now);
+    reasons[i] = Reason::OK;
+  }
+
+  parent->stats->update(Stats::Metric::AGE, ages, cnt);
+
+  return Reason::OK;
+}
+
+void StatsReadHook::update(const struct Sample *smp,
+                           const struct Sample *prev) {
+  if (prev) {
+    if (smp->flags & prev->flags & (int)SampleFlags::HAS_TS_RECEIVED)
       parent->stats->update(Stats::Metric::GAP_RECEIVED,
-                            time_delta(&last->ts.received, &smp->ts.received));
+                            time_delta(&prev->ts.received, &smp->ts.received));
 
-    if (smp->flags & last->flags & (int)SampleFlags::HAS_TS_ORIGIN)
+    if (smp->flags & prev->flags & (int)SampleFlags::HAS_TS_ORIGIN)
       parent->stats->update(Stats::Metric::GAP_SAMPLE,
-                            time_delta(&last->ts.origin, &smp->ts.origin));
+                            time_delta(&prev->ts.origin, &smp->ts.origin));
 
     if ((smp->flags & (int)SampleFlags::HAS_TS_ORIGIN) &&
         (smp->flags & (int)SampleFlags::HAS_TS_RECEIVED))
       parent->stats->update(Stats::Metric::OWD,
                             time_delta(&smp->ts.origin, &smp->ts.received));
 
-    if (smp->flags & last->flags & (int)SampleFlags::HAS_SEQUENCE) {
-      int dist = smp->sequence - (int32_t)last->sequence;
+    if (smp->flags & prev->flags & (int)SampleFlags::HAS_SEQUENCE) {
+      int dist = smp->sequence - (int32_t)prev->sequence;
       if (dist != 1)
         parent->stats->update(Stats::Metric::SMPS_REORDERED, dist);
     }
   }
 
   parent->stats->update(Stats::Metric::SIGNAL_COUNT, smp->length);
+}
+
+Hook::Reason StatsReadHook::process(struct Sample *smp) {
+  update(smp, last);
 
   sample_incref(smp);
 
@@ -239,6 +279,28 @@ Hook::Reason StatsReadHook::process(struct Sample *smp) {
   return Reason::OK;
 }
 
+Hook::Reason StatsReadHook::processMany(struct Sample *smps[], unsigned cnt,
+                                        Reason reasons[]) {
+  if (cnt == 0)
+    return Reason::OK;
+
+  // Within a batch, the previous sample is still referenced by the batch
+  for (unsigned i = 0; i < cnt; i++) {
+    update(smps[i], i > 0 ? smps[i - 1] : last);
+    reasons[i] = Reason::OK;
+  }
+
+  // Only the last sample of the batch needs to be kept
+  sample_incref(smps[cnt - 1]);
+
+  if (last)
+    sample_decref(last);
+
+  last = smps[cnt - 1];
+
+  return Reason::OK;
+}
+
 // Register hook
 static char n[] = "stats";
 static char d[] = "Collect statistics for the current node";
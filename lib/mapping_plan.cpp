@@ -0,0 +1,174 @@
+/* Compiled sample value remapping for path source muxing.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <villas/exceptions.hpp>
+#include <villas/mapping_plan.hpp>
+#include <villas/node.hpp>
+#include <villas/sample.hpp>
+
+using namespace villas;
+using namespace villas::node;
+
+// Number of values of the range [off, off + len) which are below avail.
+static inline unsigned available(unsigned off, unsigned len, unsigned avail) {
+  return off < avail ? std::min(len, avail - off) : 0;
+}
+
+static inline void copy_values(struct Sample *dst, const struct Sample *src,
+                               unsigned dst_off, unsigned src_off,
+                               unsigned len) {
+  memcpy(&dst->data[dst_off], &src->data[src_off], SAMPLE_DATA_LENGTH(len));
+}
+
+void MappingPlan::compile(const MappingList &ml, unsigned total) {
+  data.clear();
+  carry.clear();
+  sequence.clear();
+  length.clear();
+  tsOrigin.clear();
+  tsReceived.clear();
+  stats.clear();
+
+  fixedEnd = 0;
+  capacity = total;
+
+  std::vector<bool> mapped(total, false);
+
+  for (auto me : ml) {
+    unsigned len = me->length;
+    unsigned end = me->offset + len;
+
+    if (end > mapped.size())
+      mapped.resize(end, false);
+
+    std::fill(mapped.begin() + me->offset, mapped.begin() + end, true);
+
+    capacity = std::max(capacity, end);
+
+    if (me->type != MappingEntry::Type::DATA)
+      fixedEnd = std::max(fixedEnd, end);
+
+    switch (me->type) {
+    case MappingEntry::Type::DATA: {
+      unsigned src = me->data.offset;
+
+      // Merge with previous range if source and destination are contiguous
+      if (!data.empty() && data.back().src + data.back().len == src &&
+          data.back().dst + data.back().len == me->offset)
+        data.back().len += len;
+      else
+        data.push_back({src, me->offset, len});
+      break;
+    }
+
+    case MappingEntry::Type::STATS:
+      stats.push_back({me->offset, me->node, me->stats.metric, me->stats.type});
+      break;
+
+    case MappingEntry::Type::HEADER:
+      switch (me->header.type) {
+      case MappingEntry::HeaderType::LENGTH:
+        length.push_back(me->offset);
+        break;
+
+      case MappingEntry::HeaderType::SEQUENCE:
+        sequence.push_back(me->offset);
+        break;
+      }
+      break;
+
+    case MappingEntry::Type::TIMESTAMP:
+      switch (me->timestamp.type) {
+      case MappingEntry::TimestampType::ORIGIN:
+        tsOrigin.push_back(me->offset);
+        break;
+
+      case MappingEntry::TimestampType::RECEIVED:
+        tsReceived.push_back(me->offset);
+        break;
+      }
+      break;
+
+    case MappingEntry::Type::UNKNOWN:
+      throw RuntimeError("Failed to compile mapping with unknown entry type");
+    }
+  }
+
+  // All values which are not mapped by this list are carried over
+  for (unsigned i = 0; i < total;) {
+    if (mapped[i]) {
+      i++;
+      continue;
+    }
+
+    unsigned j = i;
+    while (j < total && !mapped[j])
+      j++;
+
+    carry.push_back({i, i, j - i});
+    i = j;
+  }
+}
+
+int MappingPlan::apply(struct Sample *remapped, const struct Sample *original,
+                       const struct Sample *previous) const {
+  if (capacity > remapped->capacity)
+    return -1;
+
+  /* We reset the sample length after each restart of the simulation.
+   * This is necessary for the test_rtt node to work properly.
+   */
+  unsigned end = original->flags & (int)SampleFlags::NEW_SIMULATION
+                     ? 0
+                     : previous->length;
+
+  end = std::max(end, fixedEnd);
+
+  for (auto &r : carry)
+    copy_values(remapped, previous, r.dst, r.src,
+                available(r.src, r.len, previous->length));
+
+  for (auto off : tsOrigin) {
+    remapped->data[off].i = original->ts.origin.tv_sec;
+    if (off + 1 < remapped->capacity)
+      remapped->data[off + 1].i = original->ts.origin.tv_nsec;
+  }
+
+  for (auto off : tsReceived) {
+    remapped->data[off].i = original->ts.received.tv_sec;
+    if (off + 1 < remapped->capacity)
+      remapped->data[off + 1].i = original->ts.received.tv_nsec;
+  }
+
+  for (auto &r : data) {
+    unsigned n = available(r.src, r.len, original->length);
+
+    copy_values(remapped, original, r.dst, r.src, n);
+
+    // Keep previous values for the part not covered by the original sample
+    copy_values(remapped, previous, r.dst + n, r.dst + n,
+                available(r.dst + n, r.len - n, previous->length));
+
+    end = std::max(end, r.dst + n);
+  }
+
+  for (auto off : sequence)
+    remapped->data[off].i = original->sequence;
+
+  for (auto off : length)
+    remapped->data[off].i = original->length;
+
+  for (auto &s : stats)
+    remapped->data[s.dst] = s.node->getStats()->getValue(s.metric, s.type);
+
+  remapped->length = end;
+
+  return 0;
+}
@@ -171,6 +171,10 @@ std::vector<int> NodeCompat::getNetemFDs() {
   return {};
 }
 
+int NodeCompat::getTxTimestamp(uint64_t sequence, struct timespec *ts) {
+  return _vt->tx_timestamp ? _vt->tx_timestamp(this, sequence, ts) : -1;
+}
+
 struct memory::Type *NodeCompat::getMemoryType() {
   return _vt->memory_type ? _vt->memory_type(this, memory::default_type)
                           : memory::default_type;
@@ -7,12 +7,14 @@
 
 #include <string>
 
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include <villas/format.hpp>
 #include <villas/node/config.hpp>
 #include <villas/node/exceptions.hpp>
 #include <villas/nodes/exec.hpp>
+#include <villas/sample.hpp>
 #include <villas/utils.hpp>
 
 using namespace villas;
@@ -40,14 +42,35 @@ int ExecNode::parse(json_t *json) {
   json_t *json_format = nullptr;
 
   const char *wd = nullptr;
+  const char *ipc_str = nullptr;
 
   ret = json_unpack_ex(
-      json, &err, 0, "{ s: o, s?: o, s?: b, s?: o, s?: b, s?: s }", "exec",
-      &json_exec, "format", &json_format, "flush", &f, "environment", &json_env,
-      "shell", &s, "working_directory", &wd);
+      json, &err, 0,
+      "{ s: o, s?: o, s?: b, s?: o, s?: b, s?: s, s?: s, s?: i, s?: F }",
+      "exec", &json_exec, "format", &json_format, "flush", &f, "environment",
+      &json_env, "shell", &s, "working_directory", &wd, "ipc", &ipc_str,
+      "queuelen", &shmem_conf.queuelen, "timeout", &shmem_timeout);
   if (ret)
     throw ConfigError(json, err, "node-config-node-exec");
 
+  if (ipc_str) {
+    if (!strcmp(ipc_str, "stdio"))
+      ipc = IPC::STDIO;
+    else if (!strcmp(ipc_str, "shmem"))
+      ipc = IPC::SHMEM;
+    else
+      throw ConfigError(json, "node-config-node-exec-ipc",
+                        "Invalid value '{}' for setting 'ipc'", ipc_str);
+  }
+
+  if (shmem_conf.queuelen <= 0)
+    throw ConfigError(json, "node-config-node-exec-queuelen",
+                      "Setting 'queuelen' must be positive");
+
+  if (shmem_timeout <= 0)
+    throw ConfigError(json, "node-config-node-exec-timeout",
+                      "Setting 'timeout' must be positive");
+
   flush = f != 0;
   shell = s < 0 ? json_is_string(json_exec) : s != 0;
 
@@ -119,6 +142,16 @@ int ExecNode::prepare() {
   // Initialize IO
   formatter->start(getInputSignals(false));
 
+  if (ipc == IPC::SHMEM) {
+    unsigned samplelen = getInputSignals(false)->size();
+
+    auto output_sigs = getOutputSignals(true);
+    if (output_sigs)
+      samplelen = std::max<unsigned>(samplelen, output_sigs->size());
+
+    shmem_conf.samplelen = samplelen;
+  }
+
   return Node::prepare();
 }
 
@@ -127,6 +160,18 @@ int ExecNode::start() {
   environment["VILLAS_NODE_CONFIG"] = configPath;
   environment["VILLAS_NODE_NAME"] = name_short;
 
+  if (ipc == IPC::SHMEM) {
+    shmem_wname = fmt::format("/villas-exec-{}-{}-in", getpid(), name_short);
+    shmem_rname = fmt::format("/villas-exec-{}-{}-out", getpid(), name_short);
+
+    // Names as seen by the sub-process
+    environment["VILLAS_SHMEM_WNAME"] = shmem_rname;
+    environment["VILLAS_SHMEM_RNAME"] = shmem_wname;
+    environment["VILLAS_SHMEM_QUEUELEN"] = std::to_string(shmem_conf.queuelen);
+    environment["VILLAS_SHMEM_SAMPLELEN"] =
+        std::to_string(shmem_conf.samplelen);
+  }
+
   // Start subprocess
   proc = std::make_unique<Popen>(command, arguments, environment, working_dir,
                                  shell);
@@ -140,6 +185,29 @@ int ExecNode::start() {
   if (!stream_out)
     return -1;
 
+  if (ipc == IPC::SHMEM) {
+    output_thread = std::thread(&ExecNode::forwardOutput, this);
+
+    // Blocks until the sub-process has opened the interface or exited
+    logger->debug("Waiting for sub-process to open shared memory interface");
+
+    int ret = shmem_int_open(shmem_wname.c_str(), shmem_rname.c_str(), &shmem,
+                             &shmem_conf, proc->getPid(), shmem_timeout);
+    if (ret < 0) {
+      int err = errno;
+
+      proc->kill(SIGINT);
+      proc->close();
+      output_thread.join();
+
+      shm_unlink(shmem_rname.c_str());
+
+      errno = err;
+      throw SystemError("Failed to open shared memory interface (ret={})",
+                        ret);
+    }
+  }
+
   int ret = Node::start();
   if (!ret)
     state = State::STARTED;
@@ -152,6 +220,13 @@ int ExecNode::stop() {
   if (ret)
     return ret;
 
+  // Let the sub-process see the end of its input queue
+  if (ipc == IPC::SHMEM) {
+    ret = shmem_int_close(&shmem);
+    if (ret)
+      return ret;
+  }
+
   // Stop subprocess
   logger->debug("Killing sub-process with pid={}", proc->getPid());
   proc->kill(SIGINT);
@@ -160,17 +235,84 @@ int ExecNode::stop() {
                 proc->getPid());
   proc->close();
 
+  if (ipc == IPC::SHMEM) {
+    // The sub-process might have been terminated before unlinking its queue
+    shm_unlink(shmem_rname.c_str());
+
+    output_thread.join();
+  }
+
   // TODO: Check exit code of subprocess?
   return 0;
 }
 
+void ExecNode::forwardOutput() {
+  char *line = nullptr;
+  size_t len = 0;
+  ssize_t bytes;
+
+  while ((bytes = getline(&line, &len, stream_in)) > 0) {
+    if (line[bytes - 1] == '\n')
+      line[bytes - 1] = '\0';
+
+    logger->info("{}", line);
+  }
+
+  free(line);
+}
+
 int ExecNode::_read(struct Sample *smps[], unsigned cnt) {
+  if (ipc == IPC::SHMEM) {
+    struct Sample *shared_smps[cnt];
+    int recv;
+
+    do {
+      recv = shmem_int_read(&shmem, shared_smps, cnt);
+    } while (recv == 0);
+
+    if (recv < 0) {
+      logger->info("Sub-process closed the shared memory interface");
+
+      setState(State::STOPPING);
+
+      return recv;
+    }
+
+    sample_copy_many(smps, shared_smps, recv);
+    sample_decref_many(shared_smps, recv);
+
+    // Signal descriptions are not shared between processes
+    for (int i = 0; i < recv; i++)
+      smps[i]->signals = getInputSignals(false);
+
+    return recv;
+  }
+
   return formatter->scan(stream_in, smps, cnt);
 }
 
 int ExecNode::_write(struct Sample *smps[], unsigned cnt) {
   int ret;
 
+  if (ipc == IPC::SHMEM) {
+    struct Sample *shared_smps[cnt];
+
+    int avail = shmem_int_alloc(&shmem, shared_smps, cnt);
+    if (avail < (int)cnt)
+      logger->warn("Pool underrun for shared memory interface");
+
+    sample_copy_many(shared_smps, smps, avail);
+
+    int pushed = shmem_int_write(&shmem, shared_smps, avail);
+    if (pushed < avail) {
+      sample_decref_many(shared_smps + std::max(pushed, 0),
+                         avail - std::max(pushed, 0));
+      logger->warn("Queue overrun for shared memory interface");
+    }
+
+    return pushed;
+  }
+
   ret = formatter->print(stream_out, smps, cnt);
   if (ret < 0)
     return ret;
@@ -190,15 +332,26 @@ const std::string &ExecNode::getDetails() {
     }
 
     details = fmt::format("exec={}, shell={}, flush={}, #environment={}, "
-                          "#arguments={}, working_dir={}",
+                          "#arguments={}, working_dir={}, ipc={}",
                           command, shell ? "yes" : "no", flush ? "yes" : "no",
-                          environment.size(), arguments.size(), wd);
+                          environment.size(), arguments.size(), wd,
+                          ipc == IPC::SHMEM ? "shmem" : "stdio");
+
+    if (ipc == IPC::SHMEM)
+      details += fmt::format(", queuelen={}, timeout={}", shmem_conf.queuelen,
+                             shmem_timeout);
   }
 
   return details;
 }
 
-std::vector<int> ExecNode::getPollFDs() { return {proc->getFdIn()}; }
+std::vector<int> ExecNode::getPollFDs() {
+  // The queues of the shared memory interface have no file descriptor
+  if (ipc == IPC::SHMEM)
+    return {};
+
+  return {proc->getFdIn()};
+}
 
 // Register node
 static char n[] = "exec";
@@ -5,18 +5,29 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <cctype>
 #include <cerrno>
 #include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <fcntl.h>
 #include <libgen.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include <villas/exceptions.hpp>
 #include <villas/format.hpp>
+#include <villas/formats/line.hpp>
 #include <villas/node_compat.hpp>
 #include <villas/nodes/file.hpp>
 #include <villas/queue.h>
+#include <villas/sample.hpp>
+#include <villas/stats.hpp>
 #include <villas/timing.hpp>
 #include <villas/utils.hpp>
 
@@ -76,19 +87,64 @@ int villas::node::file_parse(NodeCompat *n, json_t *json) {
   const char *uri_tmpl = nullptr;
   const char *eof = nullptr;
   const char *epoch = nullptr;
+  const char *overflow = nullptr;
   double epoch_flt = 0;
-
-  ret = json_unpack_ex(json, &err, 0,
-                       "{ s: s, s?: o, s?: { s?: s, s?: F, s?: s, s?: F, s?: "
-                       "i, s?: i }, s?: { s?: b, s?: i } }",
-                       "uri", &uri_tmpl, "format", &json_format, "in", "eof",
-                       &eof, "rate", &f->rate, "epoch_mode", &epoch, "epoch",
-                       &epoch_flt, "buffer_size", &f->buffer_size_in, "skip",
-                       &f->skip_lines, "out", "flush", &f->flush, "buffer_size",
-                       &f->buffer_size_out);
+  int chunk_size = f->async.chunk_size;
+  int queuelen = f->async.queuelen;
+  json_t *json_seek = nullptr;
+
+  ret = json_unpack_ex(
+      json, &err, 0,
+      "{ s: s, s?: o, s?: { s?: s, s?: F, s?: s, s?: F, s?: i, s?: i, s?: b, "
+      "s?: b, s?: o }, s?: { s?: b, s?: i, s?: b, s?: b, s?: i, s?: i, s?: s } "
+      "}",
+      "uri", &uri_tmpl, "format", &json_format, "in", "eof", &eof, "rate",
+      &f->rate, "epoch_mode", &epoch, "epoch", &epoch_flt, "buffer_size",
+      &f->buffer_size_in, "skip", &f->skip_lines, "mmap", &f->replay.enabled,
+      "index", &f->replay.cache, "seek", &json_seek, "out", "flush", &f->flush,
+      "buffer_size", &f->buffer_size_out, "async", &f->async.enabled, "direct",
+      &f->async.direct, "chunk_size", &chunk_size, "queuelen", &queuelen,
+      "overflow", &overflow);
   if (ret)
     throw ConfigError(json, err, "node-config-node-file");
 
+  if (json_seek) {
+    if (!json_is_number(json_seek))
+      throw ConfigError(json_seek, "node-config-node-file-seek",
+                        "Setting 'in.seek' must be a timestamp in seconds");
+
+    f->replay.seek = time_from_double(json_number_value(json_seek));
+    f->replay.seek_enabled = 1;
+  }
+
+  if (chunk_size <= 0)
+    throw ConfigError(json, "node-config-node-file-chunk-size",
+                      "Setting 'out.chunk_size' must be positive");
+
+  if (queuelen <= 0)
+    throw ConfigError(json, "node-config-node-file-queuelen",
+                      "Setting 'out.queuelen' must be positive");
+
+  // O_DIRECT requires aligned writes
+  f->async.chunk_size = (chunk_size + FILE_ASYNC_ALIGNMENT - 1) &
+                        ~(FILE_ASYNC_ALIGNMENT - 1);
+  f->async.queuelen = queuelen;
+
+  if (overflow) {
+    if (!strcmp(overflow, "drop"))
+      f->async.overflow = file::OverflowPolicy::DROP;
+    else if (!strcmp(overflow, "block"))
+      f->async.overflow = file::OverflowPolicy::BLOCK;
+    else
+      throw ConfigError(json, "node-config-node-file-overflow",
+                        "Invalid value '{}' for setting 'out.overflow'",
+                        overflow);
+  }
+
+  if (f->async.direct && !f->async.enabled)
+    throw ConfigError(json, "node-config-node-file-direct",
+                      "Setting 'out.direct' requires 'out.async'");
+
   f->epoch = time_from_double(epoch_flt);
   f->uri_tmpl = uri_tmpl ? strdup(uri_tmpl) : nullptr;
 
@@ -112,6 +168,19 @@ int villas::node::file_parse(NodeCompat *n, json_t *json) {
       throw RuntimeError("Invalid mode '{}' for 'eof' setting", eof);
   }
 
+  if (f->replay.enabled) {
+    if (!dynamic_cast<LineFormat *>(f->formatter))
+      throw ConfigError(json, "node-config-node-file-mmap",
+                        "Setting 'in.mmap' requires a line-based format");
+
+    if (f->eof_mode == file::EOFBehaviour::SUSPEND)
+      throw ConfigError(json, "node-config-node-file-mmap",
+                        "Setting 'in.mmap' can not be used with 'in.eof' = "
+                        "'wait'");
+  } else if (f->replay.seek_enabled)
+    throw ConfigError(json, "node-config-node-file-seek",
+                      "Setting 'in.seek' requires 'in.mmap'");
+
   if (epoch) {
     if (!strcmp(epoch, "direct"))
       f->epoch_mode = file::EpochMode::DIRECT;
@@ -190,6 +259,23 @@ char *villas::node::file_print(NodeCompat *n) {
   if (f->rate)
     strcatf(&buf, ", in.rate=%.1f", f->rate);
 
+  if (f->replay.enabled) {
+    strcatf(&buf, ", in.mmap=yes, in.index=%s",
+            f->replay.cache ? "yes" : "no");
+
+    if (f->replay.seek_enabled)
+      strcatf(&buf, ", in.seek=%.2f", time_to_double(&f->replay.seek));
+  }
+
+  if (f->async.enabled)
+    strcatf(&buf,
+            ", out.async=yes, out.direct=%s, out.chunk_size=%zu, "
+            "out.queuelen=%u, out.overflow=%s",
+            f->async.direct ? "yes" : "no", f->async.chunk_size,
+            f->async.queuelen,
+            f->async.overflow == file::OverflowPolicy::DROP ? "drop"
+                                                             : "block");
+
   if (f->first.tv_sec || f->first.tv_nsec)
     strcatf(&buf, ", first=%.2f", time_to_double(&f->first));
 
@@ -210,6 +296,496 @@ char *villas::node::file_print(NodeCompat *n) {
   return buf;
 }
 
+/* Write the buffer of the asynchronous writer to the file.
+ *
+ * With O_DIRECT, only complete blocks are written unless all is set.
+ * The remainder is kept at the beginning of the buffer.
+ */
+static void file_async_flush(NodeCompat *n, bool all) {
+  auto *f = n->getData<struct file>();
+
+  size_t len = f->async.buflen;
+
+  if (all && f->async.direct) {
+    // The last partial block can not be written with O_DIRECT
+    int flags = fcntl(f->async.fd, F_GETFL);
+    if (flags < 0 || fcntl(f->async.fd, F_SETFL, flags & ~O_DIRECT))
+      throw SystemError("Failed to disable O_DIRECT");
+
+    f->async.direct = 0;
+  } else if (f->async.direct)
+    len &= ~(size_t)(FILE_ASYNC_ALIGNMENT - 1);
+
+  auto stats = n->getStats();
+
+  for (size_t off = 0; off < len;) {
+    struct timespec start = time_now();
+
+    ssize_t ret = write(f->async.fd, f->async.buf + off, len - off);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+
+      throw SystemError("Failed to write to file");
+    }
+
+    if (stats) {
+      struct timespec end = time_now();
+      stats->update(Stats::Metric::FILE_WRITE_LATENCY,
+                    time_delta(&start, &end));
+    }
+
+    off += ret;
+  }
+
+  f->async.buflen -= len;
+  memmove(f->async.buf, f->async.buf + len, f->async.buflen);
+}
+
+// Write callback of the stream into which the formatter prints.
+static ssize_t file_async_append(void *cookie, const char *data, size_t len) {
+  auto *n = (NodeCompat *)cookie;
+  auto *f = n->getData<struct file>();
+
+  size_t cap = 2 * f->async.chunk_size;
+
+  for (size_t off = 0; off < len;) {
+    if (f->async.buflen == cap) {
+      // Exceptions must not propagate through stdio
+      try {
+        file_async_flush(n, false);
+      } catch (std::exception &e) {
+        n->logger->error("{}", e.what());
+        return -1;
+      }
+    }
+
+    size_t cpy = std::min(len - off, cap - f->async.buflen);
+
+    memcpy(f->async.buf + f->async.buflen, data + off, cpy);
+
+    f->async.buflen += cpy;
+    off += cpy;
+  }
+
+  return len;
+}
+
+static void *file_async_writer(void *ctx) {
+  auto *n = (NodeCompat *)ctx;
+  auto *f = n->getData<struct file>();
+
+  struct Sample *smps[FILE_ASYNC_BATCH];
+  bool failed = false;
+
+  while (true) {
+    int pulled = queue_signalled_pull_many(&f->async.queue, (void **)smps,
+                                           FILE_ASYNC_BATCH);
+    if (pulled < 0)
+      break; // Queue has been closed
+
+    // After a failure, samples are discarded so that the queue never stalls
+    if (!failed) {
+      try {
+        int ret = f->formatter->print(f->async.stream, smps, pulled);
+        if (ret < 0)
+          n->logger->warn("Failed to format samples: reason={}", ret);
+
+        if (fflush(f->async.stream))
+          throw RuntimeError("Failed to flush formatted samples");
+
+        // Flush if the chunk is complete or the queue has been drained
+        if (f->async.buflen >= f->async.chunk_size ||
+            (f->flush && queue_signalled_available(&f->async.queue) == 0))
+          file_async_flush(n, false);
+      } catch (std::exception &e) {
+        n->logger->error("Asynchronous writer failed: {}", e.what());
+        failed = true;
+      }
+    }
+
+    sample_decref_many(smps, pulled);
+  }
+
+  if (!failed) {
+    try {
+      file_async_flush(n, true);
+    } catch (std::exception &e) {
+      n->logger->error("Asynchronous writer failed: {}", e.what());
+    }
+  }
+
+  return nullptr;
+}
+
+static void file_async_start(NodeCompat *n) {
+  int ret;
+  auto *f = n->getData<struct file>();
+
+  int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+
+  f->async.fd = -1;
+  if (f->async.direct) {
+    f->async.fd = open(f->uri, flags | O_DIRECT, 0644);
+    if (f->async.fd < 0 && errno == EINVAL) {
+      n->logger->warn("File system does not support O_DIRECT");
+      f->async.direct = 0;
+    }
+  }
+
+  if (f->async.fd < 0)
+    f->async.fd = open(f->uri, flags, 0644);
+
+  if (f->async.fd < 0)
+    throw SystemError("Failed to open file '{}'", f->uri);
+
+  // Appending with O_DIRECT requires an aligned file size
+  struct stat sb;
+  ret = fstat(f->async.fd, &sb);
+  if (ret)
+    throw SystemError("Failed to stat file '{}'", f->uri);
+
+  if (f->async.direct && sb.st_size % FILE_ASYNC_ALIGNMENT) {
+    n->logger->warn("Disabling O_DIRECT as the size of the existing file is "
+                    "not aligned");
+
+    ret = fcntl(f->async.fd, F_SETFL, O_APPEND);
+    if (ret)
+      throw SystemError("Failed to disable O_DIRECT");
+
+    f->async.direct = 0;
+  }
+
+  f->async.buflen = 0;
+  f->async.buf = (char *)aligned_alloc(FILE_ASYNC_ALIGNMENT,
+                                       2 * f->async.chunk_size);
+  if (!f->async.buf)
+    throw MemoryAllocationError();
+
+  cookie_io_functions_t funcs = {.write = file_async_append};
+
+  f->async.stream = fopencookie(n, "w", funcs);
+  if (!f->async.stream)
+    throw SystemError("Failed to open stream for asynchronous writer");
+
+  unsigned len = std::max({n->getOutputSignalsMaxCount(),
+                           (unsigned)n->getInputSignals(false)->size(), 1U});
+
+  ret = pool_init(&f->async.pool, f->async.queuelen, SAMPLE_LENGTH(len));
+  if (ret)
+    throw RuntimeError("Failed to initialize pool");
+
+  // Multiple paths might write to this node
+  ret = queue_signalled_init(&f->async.queue, f->async.queuelen);
+  if (ret)
+    throw RuntimeError("Failed to initialize queue");
+
+  ret = pthread_create(&f->async.thread, nullptr, file_async_writer, n);
+  if (ret)
+    throw RuntimeError("Failed to create writer thread");
+}
+
+static void file_async_stop(NodeCompat *n) {
+  int ret;
+  auto *f = n->getData<struct file>();
+
+  /* Let the writer drain the queue before closing it. We give up if the
+   * writer did not make any progress for a second. */
+  size_t avail = queue_signalled_available(&f->async.queue);
+  for (int i = 0; avail > 0 && i < 1000; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    size_t left = queue_signalled_available(&f->async.queue);
+    if (left < avail)
+      i = 0;
+
+    avail = left;
+  }
+
+  if (avail > 0)
+    n->logger->warn("Writer is stuck: pending={}", avail);
+
+  ret = queue_signalled_close(&f->async.queue);
+  if (ret)
+    throw RuntimeError("Failed to close queue");
+
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  ts.tv_sec += 1;
+
+  ret = pthread_timedjoin_np(f->async.thread, nullptr, &ts);
+  if (ret == ETIMEDOUT) {
+    // The writer might still use its resources, so we leak them
+    n->logger->error("Writer thread did not terminate. Detaching it");
+    pthread_detach(f->async.thread);
+    return;
+  } else if (ret)
+    throw RuntimeError("Failed to join writer thread");
+
+  fclose(f->async.stream);
+  close(f->async.fd);
+  free(f->async.buf);
+
+  ret = queue_signalled_destroy(&f->async.queue);
+  if (ret)
+    throw RuntimeError("Failed to destroy queue");
+
+  ret = pool_destroy(&f->async.pool);
+  if (ret)
+    throw RuntimeError("Failed to destroy pool");
+}
+
+// Header of the sample index which is cached next to the replayed file.
+struct FileIndexHeader {
+  char magic[8];
+  uint64_t size; // Size of the indexed file.
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t count; // Number of entries following the header.
+};
+
+static const char file_index_magic[8] = "VNIDX01";
+
+// Map an index which has been cached for the current version of the file.
+static bool file_replay_index_load(NodeCompat *n, const struct stat *sb) {
+  auto *f = n->getData<struct file>();
+
+  std::string path = std::string(f->uri) + FILE_REPLAY_INDEX_SUFFIX;
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat isb;
+  if (fstat(fd, &isb) || (size_t)isb.st_size < sizeof(FileIndexHeader)) {
+    close(fd);
+    return false;
+  }
+
+  void *map = mmap(nullptr, isb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  auto *hdr = (struct FileIndexHeader *)map;
+  if (memcmp(hdr->magic, file_index_magic, sizeof(hdr->magic)) ||
+      hdr->size != (uint64_t)sb->st_size ||
+      hdr->mtime_sec != sb->st_mtim.tv_sec ||
+      hdr->mtime_nsec != sb->st_mtim.tv_nsec ||
+      sizeof(*hdr) + hdr->count * sizeof(FileIndexEntry) !=
+          (size_t)isb.st_size) {
+    n->logger->info("Ignoring outdated index: {}", path);
+    munmap(map, isb.st_size);
+    return false;
+  }
+
+  f->replay.index_map = map;
+  f->replay.index_length = isb.st_size;
+  f->replay.index = (struct FileIndexEntry *)(hdr + 1);
+  f->replay.count = hdr->count;
+
+  n->logger->info("Loaded index of {} samples: {}", f->replay.count, path);
+
+  return true;
+}
+
+static void file_replay_index_store(NodeCompat *n, const struct stat *sb) {
+  auto *f = n->getData<struct file>();
+
+  std::string path = std::string(f->uri) + FILE_REPLAY_INDEX_SUFFIX;
+  std::string tmp = path + ".tmp";
+
+  struct FileIndexHeader hdr = {};
+  memcpy(hdr.magic, file_index_magic, sizeof(hdr.magic));
+  hdr.size = sb->st_size;
+  hdr.mtime_sec = sb->st_mtim.tv_sec;
+  hdr.mtime_nsec = sb->st_mtim.tv_nsec;
+  hdr.count = f->replay.count;
+
+  FILE *fp = fopen(tmp.c_str(), "w");
+  if (!fp) {
+    n->logger->warn("Failed to store index: {}: {}", path, strerror(errno));
+    return;
+  }
+
+  bool ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+            fwrite(f->replay.index, sizeof(FileIndexEntry), f->replay.count,
+                   fp) == f->replay.count;
+
+  if (fclose(fp) || !ok || rename(tmp.c_str(), path.c_str())) {
+    n->logger->warn("Failed to store index: {}", path);
+    unlink(tmp.c_str());
+  }
+}
+
+// Parse the file once and record the position and timestamp of each sample.
+static void file_replay_index_build(NodeCompat *n, size_t start) {
+  auto *f = n->getData<struct file>();
+  auto *fmt = dynamic_cast<LineFormat *>(f->formatter);
+
+  char delim = fmt->getDelimiter();
+  char comment = fmt->getComment();
+
+  std::vector<FileIndexEntry> entries;
+  struct Sample *smp = sample_alloc_mem(n->getInputSignals(false)->size());
+
+  const char *end = f->replay.base + f->replay.length;
+  for (const char *line = f->replay.base + start; line < end;) {
+    auto *eol = (const char *)memchr(line, delim, end - line);
+    if (!eol)
+      break; // An incomplete last line is ignored
+
+    // Skip whitespaces, empty and comment lines
+    const char *ptr = line;
+    while (ptr < eol && isspace(*ptr))
+      ptr++;
+
+    if (ptr < eol && *ptr != comment) {
+      int ret = f->formatter->sscan(line, eol + 1 - line, nullptr, &smp, 1);
+      if (ret == 1)
+        entries.push_back({(uint64_t)(line - f->replay.base), smp->ts.origin});
+    }
+
+    line = eol + 1;
+  }
+
+  sample_free(smp);
+
+  f->replay.count = entries.size();
+  f->replay.index = new struct FileIndexEntry[entries.size()];
+  if (!f->replay.index)
+    throw MemoryAllocationError();
+
+  std::copy(entries.begin(), entries.end(), f->replay.index);
+
+  n->logger->info("Indexed {} samples", f->replay.count);
+}
+
+// Request read-ahead of the file region following the next sample.
+static void file_replay_prefetch(NodeCompat *n) {
+  auto *f = n->getData<struct file>();
+
+  if (f->replay.pos >= f->replay.count)
+    return;
+
+  size_t off = f->replay.index[f->replay.pos].offset;
+  if (off + FILE_REPLAY_PREFETCH / 2 < f->replay.prefetched)
+    return;
+
+  size_t from = std::max(f->replay.prefetched,
+                         off & ~((size_t)sysconf(_SC_PAGESIZE) - 1));
+  size_t to = std::min(from + FILE_REPLAY_PREFETCH, f->replay.length);
+
+  if (to > from)
+    madvise((void *)(f->replay.base + from), to - from, MADV_WILLNEED);
+
+  f->replay.prefetched = to;
+}
+
+static void file_replay_rewind(NodeCompat *n) {
+  auto *f = n->getData<struct file>();
+
+  f->replay.pos = f->replay.start;
+  f->replay.prefetched = 0;
+
+  file_replay_prefetch(n);
+}
+
+static void file_replay_start(NodeCompat *n) {
+  int ret;
+  auto *f = n->getData<struct file>();
+
+  int fd = fileno(f->stream_in);
+
+  struct stat sb;
+  ret = fstat(fd, &sb);
+  if (ret)
+    throw SystemError("Failed to stat file '{}'", f->uri);
+
+  f->replay.length = sb.st_size;
+  f->replay.count = 0;
+  f->replay.start = 0;
+  f->replay.pos = 0;
+
+  if (f->replay.length == 0) {
+    n->logger->warn("Empty file");
+    return;
+  }
+
+  void *base = mmap(nullptr, f->replay.length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (base == MAP_FAILED)
+    throw SystemError("Failed to map file '{}'", f->uri);
+
+  f->replay.base = (const char *)base;
+
+  madvise(base, f->replay.length, MADV_SEQUENTIAL);
+
+  // Consume the header line of the format, if it has one
+  size_t rbytes = 0;
+  f->formatter->sscan(f->replay.base, f->replay.length, &rbytes, nullptr, 0);
+
+  if (!f->replay.cache || !file_replay_index_load(n, &sb)) {
+    file_replay_index_build(n, rbytes);
+
+    if (f->replay.cache)
+      file_replay_index_store(n, &sb);
+  }
+
+  if (f->replay.seek_enabled) {
+    auto *end = f->replay.index + f->replay.count;
+    auto *it = std::lower_bound(
+        f->replay.index, end, f->replay.seek,
+        [](const FileIndexEntry &e, const struct timespec &ts) {
+          return time_cmp(&e.ts, &ts) < 0;
+        });
+
+    f->replay.start = it - f->replay.index;
+  } else
+    f->replay.start = std::min<size_t>(f->skip_lines, f->replay.count);
+
+  if (f->replay.start < f->replay.count) {
+    f->first = f->replay.index[f->replay.start].ts;
+    f->offset = file_calc_offset(&f->first, &f->epoch, f->epoch_mode);
+  } else
+    n->logger->warn("No samples left to replay");
+
+  file_replay_rewind(n);
+}
+
+static void file_replay_stop(NodeCompat *n) {
+  auto *f = n->getData<struct file>();
+
+  if (f->replay.index_map)
+    munmap(f->replay.index_map, f->replay.index_length);
+  else
+    delete[] f->replay.index;
+
+  if (f->replay.base)
+    munmap((void *)f->replay.base, f->replay.length);
+
+  f->replay.index = nullptr;
+  f->replay.index_map = nullptr;
+  f->replay.base = nullptr;
+}
+
+static int file_replay_scan(NodeCompat *n, struct Sample *const smps[],
+                            unsigned cnt) {
+  auto *f = n->getData<struct file>();
+
+  if (f->replay.pos >= f->replay.count)
+    return 0;
+
+  auto *e = &f->replay.index[f->replay.pos++];
+
+  int ret = f->formatter->sscan(f->replay.base + e->offset,
+                                f->replay.length - e->offset, nullptr, smps,
+                                cnt);
+
+  file_replay_prefetch(n);
+
+  return ret;
+}
+
 int villas::node::file_start(NodeCompat *n) {
   auto *f = n->getData<struct file>();
 
@@ -246,9 +822,13 @@ int villas::node::file_start(NodeCompat *n) {
   f->formatter->start(n->getInputSignals(false));
 
   // Open file
-  f->stream_out = fopen(f->uri, "a+");
-  if (!f->stream_out)
-    return -1;
+  if (f->async.enabled)
+    file_async_start(n);
+  else {
+    f->stream_out = fopen(f->uri, "a+");
+    if (!f->stream_out)
+      return -1;
+  }
 
   f->stream_in = fopen(f->uri, "r");
   if (!f->stream_in)
@@ -260,7 +840,7 @@ int villas::node::file_start(NodeCompat *n) {
       return ret;
   }
 
-  if (f->buffer_size_out) {
+  if (f->buffer_size_out && f->stream_out) {
     ret = setvbuf(f->stream_out, nullptr, _IOFBF, f->buffer_size_out);
     if (ret)
       return ret;
@@ -269,6 +849,12 @@ int villas::node::file_start(NodeCompat *n) {
   // Create timer
   f->task.setRate(f->rate);
 
+  if (f->replay.enabled) {
+    file_replay_start(n);
+
+    return 0;
+  }
+
   // Get timestamp of first line
   if (f->epoch_mode != file::EpochMode::ORIGINAL) {
     rewind(f->stream_in);
@@ -306,8 +892,15 @@ int villas::node::file_stop(NodeCompat *n) {
 
   f->task.stop();
 
+  if (f->replay.enabled)
+    file_replay_stop(n);
+
   fclose(f->stream_in);
-  fclose(f->stream_out);
+
+  if (f->async.enabled)
+    file_async_stop(n);
+  else
+    fclose(f->stream_out);
 
   return 0;
 }
@@ -321,15 +914,27 @@ int villas::node::file_read(NodeCompat *n, struct Sample *const smps[],
   assert(cnt == 1);
 
 retry:
-  ret = f->formatter->scan(f->stream_in, smps, cnt);
+  if (f->replay.enabled)
+    ret = file_replay_scan(n, smps, cnt);
+  else
+    ret = f->formatter->scan(f->stream_in, smps, cnt);
   if (ret <= 0) {
-    if (feof(f->stream_in)) {
+    if (f->replay.enabled ? f->replay.pos >= f->replay.count
+                          : feof(f->stream_in)) {
       switch (f->eof_mode) {
       case file::EOFBehaviour::REWIND:
         n->logger->info("Rewind input file");
 
         f->offset = file_calc_offset(&f->first, &f->epoch, f->epoch_mode);
-        rewind(f->stream_in);
+        if (f->replay.enabled) {
+          if (f->replay.start >= f->replay.count) {
+            n->setState(State::STOPPING);
+            return -1;
+          }
+
+          file_replay_rewind(n);
+        } else
+          rewind(f->stream_in);
         goto retry;
 
       case file::EOFBehaviour::SUSPEND:
@@ -380,6 +985,46 @@ retry:
   return cnt;
 }
 
+// Hand copies of the samples over to the writer thread.
+static int file_write_async(NodeCompat *n, struct Sample *const smps[],
+                            unsigned cnt) {
+  int ret;
+  auto *f = n->getData<struct file>();
+
+  struct Sample *cpys[cnt];
+  unsigned avail = 0;
+
+  while (true) {
+    ret = sample_alloc_many(&f->async.pool, cpys + avail, cnt - avail);
+    if (ret > 0)
+      avail += ret;
+
+    if (avail == cnt || f->async.overflow == file::OverflowPolicy::DROP)
+      break;
+
+    std::this_thread::yield();
+  }
+
+  if (avail < cnt) {
+    auto stats = n->getStats();
+    if (stats)
+      stats->update(Stats::Metric::FILE_DROPPED, cnt - avail);
+
+    n->logger->debug("Queue overrun: dropped={}", cnt - avail);
+  }
+
+  sample_copy_many(cpys, smps, avail);
+
+  // The queue is at least as large as the pool
+  ret = queue_signalled_push_many(&f->async.queue, (void **)cpys, avail);
+  if (ret < (int)avail) {
+    sample_decref_many(cpys + std::max(ret, 0), avail - std::max(ret, 0));
+    return ret < 0 ? ret : cnt;
+  }
+
+  return cnt;
+}
+
 int villas::node::file_write(NodeCompat *n, struct Sample *const smps[],
                              unsigned cnt) {
   int ret;
@@ -387,6 +1032,9 @@ int villas::node::file_write(NodeCompat *n, struct Sample *const smps[],
 
   assert(cnt == 1);
 
+  if (f->async.enabled)
+    return file_write_async(n, smps, cnt);
+
   ret = f->formatter->print(f->stream_out, smps, cnt);
   if (ret < 0)
     return ret;
@@ -429,6 +1077,19 @@ int villas::node::file_init(NodeCompat *n) {
   f->buffer_size_out = 0;
   f->skip_lines = 0;
 
+  f->async.enabled = 0;
+  f->async.direct = 0;
+  f->async.chunk_size = 1 << 20;
+  f->async.queuelen = 4096;
+  f->async.overflow = file::OverflowPolicy::DROP;
+
+  f->replay.enabled = 0;
+  f->replay.cache = 1;
+  f->replay.seek_enabled = 0;
+  f->replay.base = nullptr;
+  f->replay.index = nullptr;
+  f->replay.index_map = nullptr;
+
   f->formatter = nullptr;
 
   return 0;
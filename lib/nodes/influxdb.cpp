@@ -5,26 +5,53 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
-#include <cinttypes>
+#include <algorithm>
 #include <cstring>
 
 #include <netdb.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <villas/exceptions.hpp>
+#include <villas/formats/influxdb.hpp>
 #include <villas/node/config.hpp>
 #include <villas/node/memory.hpp>
 #include <villas/node_compat.hpp>
 #include <villas/nodes/influxdb.hpp>
 #include <villas/sample.hpp>
 #include <villas/signal.hpp>
+#include <villas/stats.hpp>
+#include <villas/timing.hpp>
 #include <villas/utils.hpp>
 
 using namespace villas;
 using namespace villas::node;
 using namespace villas::utils;
 
+int villas::node::influxdb_init(NodeCompat *n) {
+  auto *i = n->getData<struct influxdb>();
+
+  i->host = nullptr;
+  i->port = nullptr;
+  i->key = nullptr;
+
+  i->sd = -1;
+  i->protocol = influxdb::Protocol::UDP;
+  i->formatter = nullptr;
+
+  i->batch_size = 0;
+  i->batch_timeout = 0.1;
+  i->buffer_size = 16 << 20;
+  i->retry_interval = 1;
+
+  i->buf = nullptr;
+  i->sendbuf = nullptr;
+  i->encbuf = nullptr;
+
+  return 0;
+}
+
 int villas::node::influxdb_parse(NodeCompat *n, json_t *json) {
   auto *i = n->getData<struct influxdb>();
 
@@ -33,12 +60,58 @@ int villas::node::influxdb_parse(NodeCompat *n, json_t *json) {
 
   char *tmp, *host, *port, *lasts;
   const char *server, *key;
+  const char *protocol = nullptr;
+
+  int batch_size = -1;
+  int buffer_size = -1;
 
-  ret = json_unpack_ex(json, &err, 0, "{ s: s, s: s }", "server", &server,
-                       "key", &key);
+  ret = json_unpack_ex(json, &err, 0,
+                       "{ s: s, s: s, s?: s, s?: i, s?: F, s?: i, s?: F }",
+                       "server", &server, "key", &key, "protocol", &protocol,
+                       "batch_size", &batch_size, "batch_timeout",
+                       &i->batch_timeout, "buffer_size", &buffer_size,
+                       "retry_interval", &i->retry_interval);
   if (ret)
     throw ConfigError(json, err, "node-config-node-influx");
 
+  if (protocol) {
+    if (!strcmp(protocol, "udp"))
+      i->protocol = influxdb::Protocol::UDP;
+    else if (!strcmp(protocol, "tcp"))
+      i->protocol = influxdb::Protocol::TCP;
+    else
+      throw ConfigError(json, "node-config-node-influx-protocol",
+                        "Invalid protocol '{}'", protocol);
+  }
+
+  if (batch_size == 0 || batch_size < -1)
+    throw ConfigError(json, "node-config-node-influx-batch-size",
+                      "Setting 'batch_size' must be positive");
+
+  if (batch_size > 0)
+    i->batch_size = batch_size;
+  else
+    i->batch_size = i->protocol == influxdb::Protocol::UDP ? 1400 : 65536;
+
+  if (i->protocol == influxdb::Protocol::UDP &&
+      i->batch_size > INFLUXDB_MAX_DATAGRAM)
+    throw ConfigError(json, "node-config-node-influx-batch-size",
+                      "Setting 'batch_size' must not exceed {} bytes for UDP",
+                      INFLUXDB_MAX_DATAGRAM);
+
+  if (buffer_size >= 0)
+    i->buffer_size = buffer_size;
+
+  if (i->buffer_size < i->batch_size)
+    throw ConfigError(json, "node-config-node-influx-buffer-size",
+                      "Setting 'buffer_size' must not be smaller than "
+                      "'batch_size'");
+
+  if (i->batch_timeout < 0 || i->retry_interval <= 0)
+    throw ConfigError(json, "node-config-node-influx",
+                      "Settings 'batch_timeout' and 'retry_interval' must be "
+                      "positive");
+
   tmp = strdup(server);
 
   host = strtok_r(tmp, ":", &lasts);
@@ -53,7 +126,7 @@ int villas::node::influxdb_parse(NodeCompat *n, json_t *json) {
   return 0;
 }
 
-int villas::node::influxdb_open(NodeCompat *n) {
+static int influxdb_connect(NodeCompat *n) {
   int ret;
   auto *i = n->getData<struct influxdb>();
 
@@ -61,15 +134,18 @@ int villas::node::influxdb_open(NodeCompat *n) {
 
   memset(&hints, 0, sizeof hints);
   hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_socktype =
+      i->protocol == influxdb::Protocol::UDP ? SOCK_DGRAM : SOCK_STREAM;
 
   ret = getaddrinfo(i->host, i->port, &hints, &servinfo);
-  if (ret)
-    throw RuntimeError("Failed to lookup server: {}", gai_strerror(ret));
+  if (ret) {
+    n->logger->warn("Failed to lookup server: {}", gai_strerror(ret));
+    return -1;
+  }
 
   // Loop through all the results and connect to the first we can
   for (p = servinfo; p != nullptr; p = p->ai_next) {
-    i->sd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+    i->sd = socket(p->ai_family, p->ai_socktype | SOCK_CLOEXEC, p->ai_protocol);
     if (i->sd == -1)
       throw SystemError("Failed to create socket");
 
@@ -77,6 +153,7 @@ int villas::node::influxdb_open(NodeCompat *n) {
     if (ret == -1) {
       n->logger->warn("Connect failed: {}", strerror(errno));
       close(i->sd);
+      i->sd = -1;
       continue;
     }
 
@@ -84,13 +161,215 @@ int villas::node::influxdb_open(NodeCompat *n) {
     break;
   }
 
+  freeaddrinfo(servinfo);
+
   return p ? 0 : -1;
 }
 
+// Returns the length of the next datagram starting at off.
+static size_t influxdb_datagram_length(struct influxdb *i, size_t off) {
+  size_t len = i->sendlen - off;
+  if (len <= i->batch_size)
+    return len;
+
+  // Split at the last complete line which fits into the datagram
+  auto *start = i->sendbuf + off;
+  auto *end = (char *)memrchr(start, '\n', i->batch_size);
+  if (end)
+    return end - start + 1;
+
+  // The first line alone is larger than a datagram
+  end = (char *)memchr(start, '\n', len);
+
+  return end ? end - start + 1 : len;
+}
+
+/* Sends all lines of the send buffer.
+ *
+ * After a failure, the remaining lines are retried every retry_interval
+ * seconds until they have been sent or the node is stopped. */
+static void influxdb_flush(NodeCompat *n) {
+  auto *i = n->getData<struct influxdb>();
+
+  size_t off = 0;
+  while (off < i->sendlen) {
+    if (i->sd < 0)
+      influxdb_connect(n);
+
+    if (i->sd >= 0) {
+      size_t len = i->protocol == influxdb::Protocol::UDP
+                       ? influxdb_datagram_length(i, off)
+                       : i->sendlen - off;
+
+      ssize_t sent = send(i->sd, i->sendbuf + off, len, MSG_NOSIGNAL);
+      if (sent >= 0) {
+        off += sent; // Stream sockets might only accept a part
+        continue;
+      }
+
+      if (errno == EINTR)
+        continue;
+
+      if (errno == EMSGSIZE) {
+        n->logger->error("Discarding line which exceeds the maximum size of a "
+                         "datagram");
+        off += len;
+        continue;
+      }
+
+      n->logger->warn("Failed to send: {}", strerror(errno));
+
+      if (i->protocol == influxdb::Protocol::TCP) {
+        close(i->sd);
+        i->sd = -1;
+      }
+    }
+
+    pthread_mutex_lock(&i->mutex);
+
+    if (i->stopping) {
+      pthread_mutex_unlock(&i->mutex);
+
+      n->logger->warn("Discarding {} bytes which could not be sent",
+                      i->sendlen - off);
+      break;
+    }
+
+    struct timespec now = time_now();
+    struct timespec interval = time_from_double(i->retry_interval);
+    struct timespec deadline = time_add(&now, &interval);
+
+    while (!i->stopping && time_cmp(&now, &deadline) < 0) {
+      pthread_cond_timedwait(&i->cond, &i->mutex, &deadline);
+      now = time_now();
+    }
+
+    pthread_mutex_unlock(&i->mutex);
+  }
+}
+
+static void *influxdb_flusher(void *ctx) {
+  auto *n = (NodeCompat *)ctx;
+  auto *i = n->getData<struct influxdb>();
+
+  pthread_mutex_lock(&i->mutex);
+
+  while (true) {
+    // Wait until a batch is complete, its timeout has passed or we stop
+    while (!i->stopping && i->buflen < i->batch_size) {
+      if (i->buflen == 0) {
+        pthread_cond_wait(&i->cond, &i->mutex);
+        continue;
+      }
+
+      struct timespec now = time_now();
+      struct timespec timeout = time_from_double(i->batch_timeout);
+      struct timespec deadline = time_add(&i->ts, &timeout);
+
+      if (time_cmp(&now, &deadline) >= 0)
+        break;
+
+      pthread_cond_timedwait(&i->cond, &i->mutex, &deadline);
+    }
+
+    if (i->buflen == 0)
+      break; // Stopping and nothing left to send
+
+    std::swap(i->buf, i->sendbuf);
+    i->sendlen = i->buflen;
+    i->buflen = 0;
+
+    pthread_mutex_unlock(&i->mutex);
+
+    influxdb_flush(n);
+
+    pthread_mutex_lock(&i->mutex);
+
+    i->sendlen = 0;
+  }
+
+  pthread_mutex_unlock(&i->mutex);
+
+  return nullptr;
+}
+
+int villas::node::influxdb_open(NodeCompat *n) {
+  int ret;
+  auto *i = n->getData<struct influxdb>();
+
+  auto *formatter = new InfluxDBFormat(
+      (int)SampleFlags::HAS_TS_ORIGIN | (int)SampleFlags::HAS_DATA);
+  if (!formatter)
+    throw MemoryAllocationError();
+
+  formatter->setKey(i->key);
+  formatter->start(n->getInputSignals(false));
+
+  i->formatter = formatter;
+
+  i->buf = new char[i->buffer_size];
+  i->sendbuf = new char[i->buffer_size];
+  if (!i->buf || !i->sendbuf)
+    throw MemoryAllocationError();
+
+  i->buflen = 0;
+  i->sendlen = 0;
+  i->stopping = 0;
+
+  i->enclen = 4096;
+  i->encbuf = new char[i->enclen];
+  if (!i->encbuf)
+    throw MemoryAllocationError();
+
+  // The flusher keeps on trying if the server is not reachable yet
+  ret = influxdb_connect(n);
+  if (ret)
+    n->logger->warn("Failed to connect to server. Retrying in background");
+
+  pthread_mutex_init(&i->mutex, nullptr);
+  pthread_cond_init(&i->cond, nullptr);
+
+  ret = pthread_create(&i->thread, nullptr, influxdb_flusher, n);
+  if (ret)
+    throw SystemError("Failed to create flusher thread");
+
+  return 0;
+}
+
 int villas::node::influxdb_close(NodeCompat *n) {
   auto *i = n->getData<struct influxdb>();
 
-  close(i->sd);
+  // Send the remaining lines once
+  pthread_mutex_lock(&i->mutex);
+  i->stopping = 1;
+  pthread_cond_signal(&i->cond);
+  pthread_mutex_unlock(&i->mutex);
+
+  pthread_join(i->thread, nullptr);
+
+  pthread_cond_destroy(&i->cond);
+  pthread_mutex_destroy(&i->mutex);
+
+  if (i->sd >= 0) {
+    close(i->sd);
+    i->sd = -1;
+  }
+
+  delete[] i->buf;
+  delete[] i->sendbuf;
+  delete[] i->encbuf;
+  delete i->formatter;
+
+  i->buf = nullptr;
+  i->sendbuf = nullptr;
+  i->encbuf = nullptr;
+  i->formatter = nullptr;
+
+  return 0;
+}
+
+int villas::node::influxdb_destroy(NodeCompat *n) {
+  auto *i = n->getData<struct influxdb>();
 
   if (i->host)
     free(i->host);
@@ -106,68 +385,51 @@ int villas::node::influxdb_write(NodeCompat *n, struct Sample *const smps[],
                                  unsigned cnt) {
   auto *i = n->getData<struct influxdb>();
 
-  char *buf = strf("");
-  ssize_t sentlen, buflen;
+  int ret;
+  size_t wbytes;
 
-  for (unsigned k = 0; k < cnt; k++) {
-    const struct Sample *smp = smps[k];
+  // Encode all samples, growing the buffer if they do not fit
+  while (true) {
+    ret = i->formatter->sprint(i->encbuf, i->enclen, &wbytes, smps, cnt);
+    if (ret < 0)
+      return ret;
 
-    // Key
-    strcatf(&buf, "%s", i->key);
+    if (ret == (int)cnt && wbytes <= i->enclen)
+      break;
 
-    // Fields
-    for (unsigned j = 0; j < smp->length; j++) {
-      const auto *data = &smp->data[j];
-      auto sig = smp->signals->getByIndex(j);
-      if (!sig)
-        return -1;
+    delete[] i->encbuf;
 
-      if (sig->type != SignalType::BOOLEAN && sig->type != SignalType::FLOAT &&
-          sig->type != SignalType::INTEGER &&
-          sig->type != SignalType::COMPLEX) {
-        n->logger->warn("Unsupported signal format. Skipping");
-        continue;
-      }
+    i->enclen = std::max(2 * i->enclen, wbytes);
+    i->encbuf = new char[i->enclen];
+    if (!i->encbuf)
+      throw MemoryAllocationError();
+  }
 
-      strcatf(&buf, "%c", j == 0 ? ' ' : ',');
-      if (sig->type == SignalType::COMPLEX) {
-        strcatf(&buf, "%s_re=%f, %s_im=%f", sig->name.c_str(),
-                std::real(data->z), sig->name.c_str(), std::imag(data->z));
-      } else {
-        strcatf(&buf, "%s=", sig->name.c_str());
-
-        switch (sig->type) {
-        case SignalType::BOOLEAN:
-          strcatf(&buf, "%s", data->b ? "true" : "false");
-          break;
-
-        case SignalType::FLOAT:
-          strcatf(&buf, "%f", data->f);
-          break;
-
-        case SignalType::INTEGER:
-          strcatf(&buf, "%" PRIi64, data->i);
-          break;
-
-        default: {
-        }
-        }
-      }
-    }
+  pthread_mutex_lock(&i->mutex);
+
+  if (i->buflen + wbytes > i->buffer_size) {
+    pthread_mutex_unlock(&i->mutex);
+
+    auto stats = n->getStats();
+    if (stats)
+      stats->update(Stats::Metric::INFLUXDB_DROPPED, cnt);
+
+    n->logger->debug("Buffer overrun: dropped={}", cnt);
 
-    // Timestamp
-    strcatf(&buf, " %lld%09lld\n", (long long)smp->ts.origin.tv_sec,
-            (long long)smp->ts.origin.tv_nsec);
+    return cnt;
   }
 
-  buflen = strlen(buf) + 1;
-  sentlen = send(i->sd, buf, buflen, 0);
-  if (sentlen < 0)
-    return -1;
-  else if (sentlen < buflen)
-    n->logger->warn("Partial sent");
+  if (i->buflen == 0)
+    i->ts = time_now();
+
+  memcpy(i->buf + i->buflen, i->encbuf, wbytes);
+  i->buflen += wbytes;
+
+  // Wake up the flusher to arm the timeout of a new batch or to send it
+  if (i->buflen == wbytes || i->buflen >= i->batch_size)
+    pthread_cond_signal(&i->cond);
 
-  free(buf);
+  pthread_mutex_unlock(&i->mutex);
 
   return cnt;
 }
@@ -176,7 +438,12 @@ char *villas::node::influxdb_print(NodeCompat *n) {
   auto *i = n->getData<struct influxdb>();
   char *buf = nullptr;
 
-  strcatf(&buf, "host=%s, port=%s, key=%s", i->host, i->port, i->key);
+  strcatf(&buf,
+          "host=%s, port=%s, key=%s, protocol=%s, batch_size=%zu, "
+          "batch_timeout=%g, buffer_size=%zu",
+          i->host, i->port, i->key,
+          i->protocol == influxdb::Protocol::UDP ? "udp" : "tcp",
+          i->batch_size, i->batch_timeout, i->buffer_size);
 
   return buf;
 }
@@ -188,6 +455,8 @@ __attribute__((constructor(110))) static void register_plugin() {
   p.description = "Write results to InfluxDB";
   p.vectorize = 0;
   p.size = sizeof(struct influxdb);
+  p.init = influxdb_init;
+  p.destroy = influxdb_destroy;
   p.parse = influxdb_parse;
   p.print = influxdb_print;
   p.start = influxdb_open;
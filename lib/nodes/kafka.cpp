@@ -6,11 +6,13 @@
  */
 
 #include <cstring>
+#include <string>
 
 #include <librdkafka/rdkafkacpp.h>
 #include <sys/syslog.h>
 
 #include <villas/exceptions.hpp>
+#include <villas/node/memory.hpp>
 #include <villas/node_compat.hpp>
 #include <villas/nodes/kafka.hpp>
 #include <villas/utils.hpp>
@@ -19,9 +21,6 @@ using namespace villas;
 using namespace villas::node;
 using namespace villas::utils;
 
-// Each process has a list of clients for which a thread invokes the kafka loop
-static struct List clients;
-static pthread_t thread;
 static Logger logger;
 
 static void kafka_logger_cb(const rd_kafka_t *rk, int level, const char *fac,
@@ -51,64 +50,98 @@ static void kafka_logger_cb(const rd_kafka_t *rk, int level, const char *fac,
   }
 }
 
-static void kafka_message_cb(void *ctx, const rd_kafka_message_t *msg) {
+static void kafka_delivery_cb(rd_kafka_t *rk, const rd_kafka_message_t *msg,
+                              void *opaque) {
+  auto *n = (NodeCompat *)opaque;
+  auto *k = n->getData<struct kafka>();
+
+  if (msg->err)
+    n->logger->warn("Failed to deliver message: {}",
+                    rd_kafka_err2str(msg->err));
+
+  // The payload has been passed without a copy
+  pool_put(&k->producer.pool, msg->payload);
+}
+
+/* Decodes a batch of messages directly into samples of the pool and
+ * enqueues them at once. */
+static void kafka_consume_batch(NodeCompat *n, struct KafkaConsumer *c,
+                                rd_kafka_message_t *msgs[], unsigned cnt) {
   int ret;
-  auto *n = (NodeCompat *)ctx;
   auto *k = n->getData<struct kafka>();
-  struct Sample *smps[n->in.vectorize];
+  unsigned vec = n->in.vectorize;
+  unsigned decoded = 0;
 
-  n->logger->debug("Received a message of {} bytes from broker {}", msg->len,
-                   k->server);
+  struct Sample *smps[cnt * vec];
 
-  ret = sample_alloc_many(&k->pool, smps, n->in.vectorize);
-  if (ret <= 0) {
-    n->logger->warn("Pool underrun in consumer");
-    return;
-  }
+  unsigned avail = sample_alloc_many(&k->pool, smps, cnt * vec);
 
-  ret = k->formatter->sscan((char *)msg->payload, msg->len, nullptr, smps,
-                            n->in.vectorize);
-  if (ret < 0) {
-    n->logger->warn("Received an invalid message");
-    n->logger->warn("  Payload: {}", (char *)msg->payload);
-    return;
-  }
+  for (unsigned i = 0; i < cnt; i++) {
+    const auto *msg = msgs[i];
+
+    if (msg->err) {
+      if (msg->err != RD_KAFKA_RESP_ERR__PARTITION_EOF)
+        n->logger->warn("Failed to consume message: {}",
+                        rd_kafka_message_errstr(msg));
+      continue;
+    }
+
+    if (avail - decoded < vec) {
+      n->logger->warn("Dropped {} messages due to pool underrun", cnt - i);
+      break;
+    }
+
+    n->logger->debug("Received a message of {} bytes from broker {}",
+                     msg->len, k->server);
+
+    ret = c->formatter->sscan((char *)msg->payload, msg->len, nullptr,
+                              smps + decoded, vec);
+    if (ret < 0) {
+      n->logger->warn("Received an invalid message");
+      n->logger->warn("  Payload: {}", (char *)msg->payload);
+      continue;
+    }
+
+    if (ret == 0) {
+      n->logger->debug("Skip empty message");
+      continue;
+    }
 
-  if (ret == 0) {
-    n->logger->debug("Skip empty message");
-    sample_decref_many(smps, n->in.vectorize);
-    return;
+    // Unused samples are reused for the next message
+    decoded += ret;
   }
 
-  ret = queue_signalled_push_many(&k->queue, (void **)smps, n->in.vectorize);
-  if (ret < (int)n->in.vectorize)
+  ret = queue_signalled_push_many(&k->queue, (void **)smps, decoded);
+  if (ret < (int)decoded) {
     n->logger->warn("Failed to enqueue samples");
+    ret = std::max(ret, 0);
+  } else
+    ret = decoded;
+
+  sample_decref_many(smps + ret, avail - ret);
 }
 
-static void *kafka_loop_thread(void *ctx) {
-  int ret;
+static void *kafka_consumer_thread(void *ctx) {
+  auto *c = (struct KafkaConsumer *)ctx;
+  auto *n = c->node;
+  auto *k = n->getData<struct kafka>();
 
-  // Set the cancel type of this thread to async
-  ret = pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, nullptr);
-  if (ret != 0)
-    throw RuntimeError("Unable to set cancel type of Kafka communication "
-                       "thread to asynchronous.");
-
-  while (true) {
-    for (unsigned i = 0; i < list_length(&clients); i++) {
-      auto *n = (NodeCompat *)list_at(&clients, i);
-      auto *k = n->getData<struct kafka>();
-
-      // Execute kafka loop for this client
-      if (k->consumer.client) {
-        rd_kafka_message_t *msg =
-            rd_kafka_consumer_poll(k->consumer.client, k->timeout * 1000);
-        if (msg) {
-          kafka_message_cb((void *)n, msg);
-          rd_kafka_message_destroy(msg);
-        }
-      }
+  rd_kafka_message_t *msgs[k->consumer.batch];
+
+  while (!k->consumer.stopping) {
+    ssize_t cnt = rd_kafka_consume_batch_queue(c->queue, k->timeout * 1000,
+                                               msgs, k->consumer.batch);
+    if (cnt < 0) {
+      n->logger->error("Failed to consume messages: {}",
+                       rd_kafka_err2str(rd_kafka_last_error()));
+      break;
     }
+
+    if (cnt > 0)
+      kafka_consume_batch(n, c, msgs, cnt);
+
+    for (ssize_t i = 0; i < cnt; i++)
+      rd_kafka_message_destroy(msgs[i]);
   }
 
   return nullptr;
@@ -133,10 +166,19 @@ int villas::node::kafka_init(NodeCompat *n) {
   k->client_id = nullptr;
   k->timeout = 1.0;
 
-  k->consumer.client = nullptr;
   k->consumer.group_id = nullptr;
+  k->consumer.count = 1;
+  k->consumer.batch = 64;
+  k->consumer.consumers = nullptr;
+  k->consumer.stopping = false;
+
   k->producer.client = nullptr;
   k->producer.topic = nullptr;
+  k->producer.batch = 0;
+  k->producer.linger = -1;
+  k->producer.batch_size = -1;
+  k->producer.buffer_size = DEFAULT_FORMAT_BUFFER_LENGTH;
+  k->producer.buffers = 1024;
 
   k->sasl.mechanisms = nullptr;
   k->sasl.username = nullptr;
@@ -145,6 +187,7 @@ int villas::node::kafka_init(NodeCompat *n) {
   k->ssl.ca = nullptr;
 
   k->formatter = nullptr;
+  k->json_format = nullptr;
 
   return 0;
 }
@@ -160,22 +203,48 @@ int villas::node::kafka_parse(NodeCompat *n, json_t *json) {
   const char *client_id = "villas-node";
   const char *group_id = nullptr;
 
+  int consumers = -1, consume_batch = -1;
+  int buffers = -1, buffer_size = -1;
+
   json_error_t err;
   json_t *json_ssl = nullptr;
   json_t *json_sasl = nullptr;
   json_t *json_format = nullptr;
 
-  ret = json_unpack_ex(json, &err, 0,
-                       "{ s?: { s?: s }, s?: { s?: s, s?: s }, s?: o, s: s, "
-                       "s?: F, s: s, s?: s, s?: o, s?: o }",
-                       "out", "produce", &produce, "in", "consume", &consume,
-                       "group_id", &group_id, "format", &json_format, "server",
-                       &server, "timeout", &k->timeout, "protocol", &protocol,
-                       "client_id", &client_id, "ssl", &json_ssl, "sasl",
-                       &json_sasl);
+  ret = json_unpack_ex(
+      json, &err, 0,
+      "{ s?: { s?: s, s?: b, s?: F, s?: i, s?: i, s?: i }, "
+      "s?: { s?: s, s?: s, s?: i, s?: i }, s?: o, s: s, s?: F, s: s, s?: s, "
+      "s?: o, s?: o }",
+      "out", "produce", &produce, "batch", &k->producer.batch, "linger",
+      &k->producer.linger, "batch_size", &k->producer.batch_size, "buffers",
+      &buffers, "buffer_size", &buffer_size, "in", "consume", &consume,
+      "group_id", &group_id, "consumers", &consumers, "batch", &consume_batch,
+      "format", &json_format, "server", &server, "timeout", &k->timeout,
+      "protocol", &protocol, "client_id", &client_id, "ssl", &json_ssl, "sasl",
+      &json_sasl);
   if (ret)
     throw ConfigError(json, err, "node-config-node-kafka");
 
+  if (consumers == 0 || consumers < -1 || consume_batch == 0 ||
+      consume_batch < -1 || buffers == 0 || buffers < -1 ||
+      buffer_size == 0 || buffer_size < -1)
+    throw ConfigError(json, "node-config-node-kafka",
+                      "Settings 'in.consumers', 'in.batch', 'out.buffers' and "
+                      "'out.buffer_size' must be positive");
+
+  if (consumers > 0)
+    k->consumer.count = consumers;
+
+  if (consume_batch > 0)
+    k->consumer.batch = consume_batch;
+
+  if (buffers > 0)
+    k->producer.buffers = buffers;
+
+  if (buffer_size > 0)
+    k->producer.buffer_size = buffer_size;
+
   k->server = strdup(server);
   k->produce = produce ? strdup(produce) : nullptr;
   k->consume = consume ? strdup(consume) : nullptr;
@@ -231,6 +300,10 @@ int villas::node::kafka_parse(NodeCompat *n, json_t *json) {
     throw ConfigError(json_format, "node-config-node-kafka-format",
                       "Invalid format configuration");
 
+  if (k->json_format)
+    json_decref(k->json_format);
+  k->json_format = json_format ? json_incref(json_format) : nullptr;
+
   return 0;
 }
 
@@ -240,7 +313,10 @@ int villas::node::kafka_prepare(NodeCompat *n) {
 
   k->formatter->start(n->getInputSignals(false), ~(int)SampleFlags::HAS_OFFSET);
 
-  ret = pool_init(&k->pool, 1024,
+  // Consumers might hold a full batch each while the queue is full
+  ret = pool_init(&k->pool,
+                  1024 + k->consumer.count * k->consumer.batch *
+                             n->in.vectorize,
                   SAMPLE_LENGTH(n->getInputSignals(false)->size()));
   if (ret)
     return ret;
@@ -249,6 +325,13 @@ int villas::node::kafka_prepare(NodeCompat *n) {
   if (ret)
     return ret;
 
+  if (k->produce) {
+    ret = pool_init(&k->producer.pool, k->producer.buffers,
+                    k->producer.buffer_size, &memory::heap);
+    if (ret)
+      return ret;
+  }
+
   return 0;
 }
 
@@ -262,10 +345,12 @@ char *villas::node::kafka_print(NodeCompat *n) {
 
   // Only show if not default
   if (k->produce)
-    strcatf(&buf, ", out.produce=%s", k->produce);
+    strcatf(&buf, ", out.produce=%s, out.batch=%s, out.buffers=%u",
+            k->produce, k->producer.batch ? "yes" : "no", k->producer.buffers);
 
   if (k->consume)
-    strcatf(&buf, ", in.consume=%s", k->consume);
+    strcatf(&buf, ", in.consume=%s, in.consumers=%u, in.batch=%u", k->consume,
+            k->consumer.count, k->consumer.batch);
 
   return buf;
 }
@@ -274,19 +359,29 @@ int villas::node::kafka_destroy(NodeCompat *n) {
   int ret;
   auto *k = n->getData<struct kafka>();
 
+  if (k->producer.topic)
+    rd_kafka_topic_destroy(k->producer.topic);
+
   if (k->producer.client)
     rd_kafka_destroy(k->producer.client);
 
-  if (k->consumer.client)
-    rd_kafka_destroy(k->consumer.client);
-
   if (k->formatter)
     delete k->formatter;
 
+  if (k->json_format)
+    json_decref(k->json_format);
+
   ret = pool_destroy(&k->pool);
   if (ret)
     return ret;
 
+  // All buffers have been returned before the producer was destroyed
+  if (k->produce) {
+    ret = pool_destroy(&k->producer.pool);
+    if (ret)
+      return ret;
+  }
+
   ret = queue_signalled_destroy(&k->queue);
   if (ret)
     return ret;
@@ -366,6 +461,27 @@ int villas::node::kafka_start(NodeCompat *n) {
     if (!rdkconf_prod)
       throw MemoryAllocationError();
 
+    rd_kafka_conf_set_opaque(rdkconf_prod, n);
+    rd_kafka_conf_set_dr_msg_cb(rdkconf_prod, kafka_delivery_cb);
+
+    if (k->producer.linger >= 0) {
+      auto linger = std::to_string(k->producer.linger * 1000);
+
+      ret = rd_kafka_conf_set(rdkconf_prod, "linger.ms", linger.c_str(),
+                              errstr, sizeof(errstr));
+      if (ret != RD_KAFKA_CONF_OK)
+        goto kafka_config_error;
+    }
+
+    if (k->producer.batch_size > 0) {
+      auto batch_size = std::to_string(k->producer.batch_size);
+
+      ret = rd_kafka_conf_set(rdkconf_prod, "batch.num.messages",
+                              batch_size.c_str(), errstr, sizeof(errstr));
+      if (ret != RD_KAFKA_CONF_OK)
+        goto kafka_config_error;
+    }
+
     k->producer.client =
         rd_kafka_new(RD_KAFKA_PRODUCER, rdkconf_prod, errstr, sizeof(errstr));
     if (!k->producer.client)
@@ -389,12 +505,6 @@ int villas::node::kafka_start(NodeCompat *n) {
   }
 
   if (k->consume) {
-    // rd_kafka_new() will take ownership and free the passed rd_kafka_conf_t object,
-    // so we will need to create a copy first
-    rd_kafka_conf_t *rdkconf_cons = rd_kafka_conf_dup(rdkconf);
-    if (!rdkconf_cons)
-      throw MemoryAllocationError();
-
     rd_kafka_topic_partition_list_t *partitions =
         rd_kafka_topic_partition_list_new(1);
     if (!partitions)
@@ -405,27 +515,61 @@ int villas::node::kafka_start(NodeCompat *n) {
     if (!partition)
       throw RuntimeError("Failed to add new partition");
 
-    ret = rd_kafka_conf_set(rdkconf_cons, "group.id", k->consumer.group_id,
-                            errstr, sizeof(errstr));
-    if (ret != RD_KAFKA_CONF_OK)
-      goto kafka_config_error;
-
-    k->consumer.client =
-        rd_kafka_new(RD_KAFKA_CONSUMER, rdkconf_cons, errstr, sizeof(errstr));
-    if (!k->consumer.client)
+    k->consumer.stopping = false;
+    k->consumer.consumers = new struct KafkaConsumer[k->consumer.count];
+    if (!k->consumer.consumers)
       throw MemoryAllocationError();
 
-    ret = rd_kafka_subscribe(k->consumer.client, partitions);
-    if (ret != RD_KAFKA_RESP_ERR_NO_ERROR)
-      throw RuntimeError("Error subscribing to {} at {}: {}", k->consume,
-                         k->server, rd_kafka_err2str((rd_kafka_resp_err_t)ret));
+    /* The partitions of the topic are distributed among the consumers of
+     * the group by the broker. */
+    for (unsigned i = 0; i < k->consumer.count; i++) {
+      auto *c = &k->consumer.consumers[i];
+
+      // rd_kafka_new() will take ownership and free the passed
+      // rd_kafka_conf_t object, so we will need to create a copy first
+      rd_kafka_conf_t *rdkconf_cons = rd_kafka_conf_dup(rdkconf);
+      if (!rdkconf_cons)
+        throw MemoryAllocationError();
+
+      ret = rd_kafka_conf_set(rdkconf_cons, "group.id", k->consumer.group_id,
+                              errstr, sizeof(errstr));
+      if (ret != RD_KAFKA_CONF_OK)
+        goto kafka_config_error;
+
+      c->node = n;
+      c->client = rd_kafka_new(RD_KAFKA_CONSUMER, rdkconf_cons, errstr,
+                               sizeof(errstr));
+      if (!c->client)
+        throw MemoryAllocationError();
+
+      ret = rd_kafka_subscribe(c->client, partitions);
+      if (ret != RD_KAFKA_RESP_ERR_NO_ERROR)
+        throw RuntimeError("Error subscribing to {} at {}: {}", k->consume,
+                           k->server,
+                           rd_kafka_err2str((rd_kafka_resp_err_t)ret));
+
+      c->queue = rd_kafka_queue_get_consumer(c->client);
+      if (!c->queue)
+        throw RuntimeError("Failed to get consumer queue");
+
+      c->formatter = k->json_format ? FormatFactory::make(k->json_format)
+                                    : FormatFactory::make("villas.binary");
+      if (!c->formatter)
+        throw MemoryAllocationError();
+
+      c->formatter->start(n->getInputSignals(false),
+                          ~(int)SampleFlags::HAS_OFFSET);
+
+      ret = pthread_create(&c->thread, nullptr, kafka_consumer_thread, c);
+      if (ret)
+        throw SystemError("Failed to create consumer thread");
+    }
 
-    n->logger->info("Subscribed consumer from bootstrap server {}", k->server);
-  }
+    rd_kafka_topic_partition_list_destroy(partitions);
 
-  // Add client to global list of kafka clients
-  // so that thread can call kafka loop for this client
-  list_push(&clients, n);
+    n->logger->info("Subscribed {} consumer(s) from bootstrap server {}",
+                    k->consumer.count, k->server);
+  }
 
   rd_kafka_conf_destroy(rdkconf);
 
@@ -451,78 +595,58 @@ int villas::node::kafka_stop(NodeCompat *n) {
 
     /* If the output queue is still not empty there is an issue
      * with producing messages to the clusters. */
-    if (rd_kafka_outq_len(k->producer.client) > 0)
+    if (rd_kafka_outq_len(k->producer.client) > 0) {
       n->logger->warn("{} message(s) were not delivered",
                       rd_kafka_outq_len(k->producer.client));
-  }
-
-  // Unregister client from global kafka client list
-  // so that kafka loop is no longer invoked for this client
-  // important to do that before disconnecting from broker, otherwise, kafka thread will attempt to reconnect
-  list_remove_all(&clients, n);
 
-  ret = queue_signalled_close(&k->queue);
-  if (ret)
-    return ret;
-
-  return 0;
-}
+      /* The remaining messages still reference buffers of the pool.
+       * Their delivery reports return them once they have been purged. */
+      rd_kafka_purge(k->producer.client,
+                     RD_KAFKA_PURGE_F_QUEUE | RD_KAFKA_PURGE_F_INFLIGHT);
+      rd_kafka_flush(k->producer.client, k->timeout * 1000);
+    }
 
-int villas::node::kafka_type_start(villas::node::SuperNode *sn) {
-  int ret;
+    rd_kafka_topic_destroy(k->producer.topic);
+    rd_kafka_destroy(k->producer.client);
 
-  logger = Log::get("node:kafka");
+    k->producer.topic = nullptr;
+    k->producer.client = nullptr;
+  }
 
-  ret = list_init(&clients);
-  if (ret)
-    goto kafka_error;
+  if (k->consumer.consumers) {
+    k->consumer.stopping = true;
 
-  // Start thread here to run kafka loop for registered clients
-  ret = pthread_create(&thread, nullptr, kafka_loop_thread, nullptr);
-  if (ret)
-    goto kafka_error;
+    for (unsigned i = 0; i < k->consumer.count; i++) {
+      auto *c = &k->consumer.consumers[i];
 
-  return 0;
+      pthread_join(c->thread, nullptr);
 
-kafka_error:
-  logger->warn("Error initialazing node type kafka");
+      rd_kafka_queue_destroy(c->queue);
+      rd_kafka_consumer_close(c->client);
+      rd_kafka_destroy(c->client);
 
-  return ret;
-}
+      delete c->formatter;
+    }
 
-int villas::node::kafka_type_stop() {
-  int ret;
+    delete[] k->consumer.consumers;
+    k->consumer.consumers = nullptr;
+  }
 
-  // Stop thread here that executes kafka loop
-  ret = pthread_cancel(thread);
+  ret = queue_signalled_close(&k->queue);
   if (ret)
     return ret;
 
-  logger->debug(
-      "Called pthread_cancel() on kafka communication management thread.");
-
-  ret = pthread_join(thread, nullptr);
-  if (ret)
-    goto kafka_error;
-
-  // When this is called the list of clients should be empty
-  if (list_length(&clients) > 0)
-    throw RuntimeError(
-        "List of kafka clients contains elements at time of destruction. Call "
-        "node_stop for each kafka node before stopping node type!");
-
-  ret = list_destroy(&clients, nullptr, false);
-  if (ret)
-    goto kafka_error;
-
   return 0;
+}
 
-kafka_error:
-  logger->warn("Error stoping node type kafka");
+int villas::node::kafka_type_start(villas::node::SuperNode *sn) {
+  logger = Log::get("node:kafka");
 
-  return ret;
+  return 0;
 }
 
+int villas::node::kafka_type_stop() { return 0; }
+
 int villas::node::kafka_read(NodeCompat *n, struct Sample *const smps[],
                              unsigned cnt) {
   int pulled;
@@ -537,6 +661,37 @@ int villas::node::kafka_read(NodeCompat *n, struct Sample *const smps[],
   return pulled;
 }
 
+/* Encodes samples into a buffer of the producer pool.
+ *
+ * Returns the buffer or nullptr if no buffer is available or the encoded
+ * samples do not fit into it. */
+static char *kafka_encode(NodeCompat *n, struct Sample *const smps[],
+                          unsigned cnt, size_t *wbytes) {
+  int ret;
+  auto *k = n->getData<struct kafka>();
+
+  auto *buf = (char *)pool_get(&k->producer.pool);
+  if (!buf) {
+    // Return the buffers of delivered messages
+    rd_kafka_poll(k->producer.client, 0);
+
+    buf = (char *)pool_get(&k->producer.pool);
+    if (!buf) {
+      n->logger->warn("Buffer pool underrun in producer");
+      return nullptr;
+    }
+  }
+
+  ret = k->formatter->sprint(buf, k->producer.buffer_size, wbytes, smps, cnt);
+  if (ret < (int)cnt || *wbytes > k->producer.buffer_size) {
+    n->logger->warn("Encoded samples exceed the size of a message buffer");
+    pool_put(&k->producer.pool, buf);
+    return nullptr;
+  }
+
+  return buf;
+}
+
 int villas::node::kafka_write(NodeCompat *n, struct Sample *const smps[],
                               unsigned cnt) {
   int ret;
@@ -544,23 +699,57 @@ int villas::node::kafka_write(NodeCompat *n, struct Sample *const smps[],
 
   size_t wbytes;
 
-  char data[DEFAULT_FORMAT_BUFFER_LENGTH];
+  if (!k->produce) {
+    n->logger->warn(
+        "No produce possible because no produce topic is configured");
+    return cnt;
+  }
 
-  ret = k->formatter->sprint(data, sizeof(data), &wbytes, smps, cnt);
-  if (ret < 0)
-    return ret;
+  // Serve delivery reports which return message buffers to the pool
+  rd_kafka_poll(k->producer.client, 0);
 
-  if (k->produce) {
-    ret = rd_kafka_produce(k->producer.topic, RD_KAFKA_PARTITION_UA,
-                           RD_KAFKA_MSG_F_COPY, data, wbytes, NULL, 0, NULL);
+  if (k->producer.batch) {
+    rd_kafka_message_t msgs[cnt];
+    unsigned encoded;
+
+    memset(msgs, 0, sizeof(msgs));
 
-    if (ret != RD_KAFKA_RESP_ERR_NO_ERROR) {
-      n->logger->warn("Publish failed");
-      return -abs(ret);
+    for (encoded = 0; encoded < cnt; encoded++) {
+      char *buf = kafka_encode(n, &smps[encoded], 1, &wbytes);
+      if (!buf)
+        break;
+
+      msgs[encoded].payload = buf;
+      msgs[encoded].len = wbytes;
     }
-  } else
-    n->logger->warn(
-        "No produce possible because no produce topic is configured");
+
+    ret = rd_kafka_produce_batch(k->producer.topic, RD_KAFKA_PARTITION_UA, 0,
+                                 msgs, encoded);
+
+    // Messages which have not been enqueued are not reported
+    for (unsigned i = 0; i < encoded; i++) {
+      if (msgs[i].err)
+        pool_put(&k->producer.pool, msgs[i].payload);
+    }
+
+    if (ret < (int)encoded)
+      n->logger->warn("Publish failed for {} message(s)", encoded - ret);
+
+    return ret;
+  }
+
+  char *buf = kafka_encode(n, smps, cnt, &wbytes);
+  if (!buf)
+    return -1;
+
+  ret = rd_kafka_produce(k->producer.topic, RD_KAFKA_PARTITION_UA, 0, buf,
+                         wbytes, NULL, 0, NULL);
+  if (ret) {
+    pool_put(&k->producer.pool, buf);
+    n->logger->warn("Publish failed: {}",
+                    rd_kafka_err2str(rd_kafka_last_error()));
+    return -1;
+  }
 
   return cnt;
 }
@@ -19,7 +19,7 @@ using namespace villas::node;
 using namespace villas::utils;
 
 LoopbackNode::LoopbackNode(const uuid_t &id, const std::string &name)
-    : Node(id, name), queuelen(DEFAULT_QUEUE_LENGTH),
+    : Node(id, name), queuelen(DEFAULT_QUEUE_LENGTH), copy(0),
       mode(QueueSignalledMode::AUTO) {
   queue.queue.state = State::DESTROYED;
 }
@@ -53,12 +53,23 @@ int LoopbackNode::stop() {
 int LoopbackNode::_read(struct Sample *smps[], unsigned cnt) {
   int avail;
 
-  struct Sample *cpys[cnt];
-
-  avail = queue_signalled_pull_many(&queue, (void **)cpys, cnt);
-
-  sample_copy_many(smps, cpys, avail);
-  sample_decref_many(cpys, avail);
+  struct Sample *pulled[cnt];
+
+  avail = queue_signalled_pull_many(&queue, (void **)pulled, cnt);
+
+  for (int i = 0; i < avail; i++) {
+    /* The reader takes over the reference of the writer, unless the sample is
+     * still used by someone else who might observe changes of the reader.
+     */
+    if (copy || pulled[i]->refcnt > 1 ||
+        pulled[i]->capacity < smps[i]->capacity) {
+      sample_copy(smps[i], pulled[i]);
+      sample_decref(pulled[i]);
+    } else {
+      sample_decref(smps[i]);
+      smps[i] = pulled[i];
+    }
+  }
 
   return avail;
 }
@@ -87,7 +98,8 @@ std::vector<int> LoopbackNode::getPollFDs() {
 
 const std::string &LoopbackNode::getDetails() {
   if (details.empty()) {
-    details = fmt::format("queuelen={}", queuelen);
+    details = fmt::format("queuelen={}, copy={}", queuelen,
+                          copy ? "yes" : "no");
   }
 
   return details;
@@ -99,8 +111,8 @@ int LoopbackNode::parse(json_t *json) {
   json_error_t err;
   int ret;
 
-  ret = json_unpack_ex(json, &err, 0, "{ s?: i, s?: s }", "queuelen", &queuelen,
-                       "mode", &mode_str);
+  ret = json_unpack_ex(json, &err, 0, "{ s?: i, s?: s, s?: b }", "queuelen",
+                       &queuelen, "mode", &mode_str, "copy", &copy);
   if (ret)
     throw ConfigError(json, err, "node-config-node-loopback");
 
@@ -110,6 +122,10 @@ int LoopbackNode::parse(json_t *json) {
 #ifdef HAVE_EVENTFD
     else if (!strcmp(mode_str, "eventfd"))
       mode = QueueSignalledMode::EVENTFD;
+#endif
+#ifdef __linux__
+    else if (!strcmp(mode_str, "futex"))
+      mode = QueueSignalledMode::FUTEX;
 #endif
     else if (!strcmp(mode_str, "pthread"))
       mode = QueueSignalledMode::PTHREAD;
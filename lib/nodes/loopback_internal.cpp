@@ -39,7 +39,10 @@ InternalLoopbackNode::InternalLoopbackNode(Node *src, unsigned id, unsigned ql)
 
   in.signals = source->getInputSignals(false);
 
-  ret = queue_signalled_init(&queue, queuelen);
+  // Only the master path writes and only the secondary path reads
+  ret = queue_signalled_init(&queue, queuelen, memory::default_type,
+                             QueueSignalledMode::AUTO,
+                             (int)QueueSignalledFlags::SPSC);
   if (ret)
     throw RuntimeError("Failed to initialize queue");
 
@@ -5,13 +5,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <chrono>
 #include <cstring>
+#include <thread>
 
 #include <mosquitto.h>
 
 #include <villas/exceptions.hpp>
+#include <villas/node/config.hpp>
 #include <villas/node_compat.hpp>
 #include <villas/nodes/mqtt.hpp>
+#include <villas/stats.hpp>
 #include <villas/utils.hpp>
 
 using namespace villas;
@@ -65,6 +69,29 @@ static void mqtt_disconnect_cb(struct mosquitto *mosq, void *ctx, int result) {
   auto *m = n->getData<struct mqtt>();
 
   n->logger->info("Disconnected from broker {}", m->host);
+
+  /* Unsent messages with QoS 0 are discarded by libmosquitto without
+   * invoking the publish callback. Messages with a higher QoS are kept and
+   * retried once the connection has been re-established. */
+  if (m->qos == 0 && m->publish) {
+    pthread_mutex_lock(&m->async.mutex);
+    m->async.inflight = 0;
+    pthread_cond_signal(&m->async.cond);
+    pthread_mutex_unlock(&m->async.mutex);
+  }
+}
+
+static void mqtt_publish_cb(struct mosquitto *mosq, void *ctx, int mid) {
+  auto *n = (NodeCompat *)ctx;
+  auto *m = n->getData<struct mqtt>();
+
+  pthread_mutex_lock(&m->async.mutex);
+
+  if (m->async.inflight > 0)
+    m->async.inflight--;
+
+  pthread_cond_signal(&m->async.cond);
+  pthread_mutex_unlock(&m->async.mutex);
 }
 
 static void mqtt_message_cb(struct mosquitto *mosq, void *ctx,
@@ -130,6 +157,7 @@ int villas::node::mqtt_init(NodeCompat *n) {
   mosquitto_disconnect_callback_set(m->client, mqtt_disconnect_cb);
   mosquitto_message_callback_set(m->client, mqtt_message_cb);
   mosquitto_subscribe_callback_set(m->client, mqtt_subscribe_cb);
+  mosquitto_publish_callback_set(m->client, mqtt_publish_cb);
 
   m->formatter = nullptr;
 
@@ -139,6 +167,13 @@ int villas::node::mqtt_init(NodeCompat *n) {
   m->retain = 0;
   m->keepalive = 5; // 5 second, minimum required for libmosquitto
 
+  m->async.queuelen = 1024;
+  m->async.max_inflight = 20; // Default of libmosquitto
+
+  // Used by the callbacks of libmosquitto until the client is destroyed
+  pthread_mutex_init(&m->async.mutex, nullptr);
+  pthread_cond_init(&m->async.cond, nullptr);
+
   m->host = nullptr;
   m->username = nullptr;
   m->password = nullptr;
@@ -172,17 +207,30 @@ int villas::node::mqtt_parse(NodeCompat *n, json_t *json) {
   json_t *json_ssl = nullptr;
   json_t *json_format = nullptr;
 
-  ret = json_unpack_ex(json, &err, 0,
-                       "{ s?: { s?: s }, s?: { s?: s }, s?: o, s: s, s?: i, "
-                       "s?: i, s?: i, s?: b, s?: s, s?: s, s?: o }",
-                       "out", "publish", &publish, "in", "subscribe",
-                       &subscribe, "format", &json_format, "host", &host,
-                       "port", &m->port, "qos", &m->qos, "keepalive",
-                       &m->keepalive, "retain", &m->retain, "username",
-                       &username, "password", &password, "ssl", &json_ssl);
+  int queuelen = m->async.queuelen;
+
+  ret = json_unpack_ex(
+      json, &err, 0,
+      "{ s?: { s?: s, s?: i, s?: i }, s?: { s?: s }, s?: o, s: s, s?: i, "
+      "s?: i, s?: i, s?: b, s?: s, s?: s, s?: o }",
+      "out", "publish", &publish, "queuelen", &queuelen, "max_inflight",
+      &m->async.max_inflight, "in", "subscribe", &subscribe, "format",
+      &json_format, "host", &host, "port", &m->port, "qos", &m->qos,
+      "keepalive", &m->keepalive, "retain", &m->retain, "username", &username,
+      "password", &password, "ssl", &json_ssl);
   if (ret)
     throw ConfigError(json, err, "node-config-node-mqtt");
 
+  if (queuelen <= 0)
+    throw ConfigError(json, "node-config-node-mqtt-queuelen",
+                      "Setting 'out.queuelen' must be positive");
+
+  if (m->async.max_inflight < 0)
+    throw ConfigError(json, "node-config-node-mqtt-max-inflight",
+                      "Setting 'out.max_inflight' must not be negative");
+
+  m->async.queuelen = queuelen;
+
   m->host = strdup(host);
   m->publish = publish ? strdup(publish) : nullptr;
   m->subscribe = subscribe ? strdup(subscribe) : nullptr;
@@ -293,7 +341,8 @@ char *villas::node::mqtt_print(NodeCompat *n) {
     strcatf(&buf, ", username=%s", m->username);
 
   if (m->publish)
-    strcatf(&buf, ", out.publish=%s", m->publish);
+    strcatf(&buf, ", out.publish=%s, out.queuelen=%u, out.max_inflight=%d",
+            m->publish, m->async.queuelen, m->async.max_inflight);
 
   if (m->subscribe)
     strcatf(&buf, ", in.subscribe=%s", m->subscribe);
@@ -307,6 +356,9 @@ int villas::node::mqtt_destroy(NodeCompat *n) {
 
   mosquitto_destroy(m->client);
 
+  pthread_cond_destroy(&m->async.cond);
+  pthread_mutex_destroy(&m->async.mutex);
+
   ret = pool_destroy(&m->pool);
   if (ret)
     return ret;
@@ -336,10 +388,136 @@ int villas::node::mqtt_destroy(NodeCompat *n) {
   return 0;
 }
 
+static void *mqtt_async_publisher(void *ctx) {
+  auto *n = (NodeCompat *)ctx;
+  auto *m = n->getData<struct mqtt>();
+
+  unsigned batch = std::max(n->out.vectorize, 1U);
+  struct Sample *smps[batch];
+  char data[DEFAULT_FORMAT_BUFFER_LENGTH];
+
+  while (true) {
+    // Everything which has been queued in the meantime is sent together
+    int pulled =
+        queue_signalled_pull_many(&m->async.queue, (void **)smps, batch);
+    if (pulled < 0)
+      break; // Closed by mqtt_async_stop()
+
+    for (int sent = 0; sent < pulled;) {
+      // Limit the number of messages which are held by libmosquitto
+      pthread_mutex_lock(&m->async.mutex);
+      while (m->async.max_inflight > 0 &&
+             m->async.inflight >= m->async.max_inflight && !m->async.stopping)
+        pthread_cond_wait(&m->async.cond, &m->async.mutex);
+      pthread_mutex_unlock(&m->async.mutex);
+
+      /* Formats report the size which would have been required if the
+       * samples did not fit, so we halve the batch until they do. */
+      size_t wbytes = 0;
+      int cnt = pulled - sent, ret;
+      while (true) {
+        ret = m->formatter->sprint(data, sizeof(data), &wbytes, smps + sent,
+                                   cnt);
+        if (ret < 0 || (ret == cnt && wbytes <= sizeof(data)) || cnt == 1)
+          break;
+
+        cnt /= 2;
+      }
+
+      if (ret != cnt || wbytes > sizeof(data)) {
+        n->logger->warn("Failed to format sample: reason={}, bytes={}", ret,
+                        wbytes);
+        m->async.dropped += cnt;
+        sent += cnt;
+        continue;
+      }
+
+      // The callback might be invoked before mosquitto_publish() returns
+      m->async.inflight++;
+
+      int err = mosquitto_publish(m->client, nullptr /* mid */, m->publish,
+                                  wbytes, data, m->qos, m->retain);
+      if (err != MOSQ_ERR_SUCCESS) {
+        n->logger->debug("Publish failed: {}", mosquitto_strerror(err));
+
+        m->async.inflight--;
+        m->async.dropped += ret;
+      }
+
+      sent += ret;
+    }
+
+    sample_decref_many(smps, pulled);
+  }
+
+  return nullptr;
+}
+
+static void mqtt_async_start(NodeCompat *n) {
+  int ret;
+  auto *m = n->getData<struct mqtt>();
+
+  m->async.inflight = 0;
+  m->async.dropped = 0;
+  m->async.stopping = 0;
+
+  ret = pool_init(&m->async.pool, m->async.queuelen,
+                  SAMPLE_LENGTH(std::max(n->getOutputSignalsMaxCount(), 1U)));
+  if (ret)
+    throw RuntimeError("Failed to initialize pool");
+
+  /* Sized like the pool: every sample copied by mqtt_write() finds a slot
+   * in the queue, so only the pool decides which samples are dropped. */
+  ret = queue_signalled_init(&m->async.queue, m->async.queuelen);
+  if (ret)
+    throw RuntimeError("Failed to initialize queue");
+
+  ret = pthread_create(&m->async.thread, nullptr, mqtt_async_publisher, n);
+  if (ret)
+    throw RuntimeError("Failed to create publisher thread");
+}
+
+static void mqtt_async_stop(NodeCompat *n) {
+  int ret;
+  auto *m = n->getData<struct mqtt>();
+
+  // Give the publisher some time to drain the queue
+  for (int i = 0; i < 100 && queue_signalled_available(&m->async.queue) > 0;
+       i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  pthread_mutex_lock(&m->async.mutex);
+  m->async.stopping = 1;
+  pthread_cond_signal(&m->async.cond);
+  pthread_mutex_unlock(&m->async.mutex);
+
+  ret = queue_signalled_close(&m->async.queue);
+  if (ret)
+    throw RuntimeError("Failed to close queue");
+
+  ret = pthread_join(m->async.thread, nullptr);
+  if (ret)
+    throw RuntimeError("Failed to join publisher thread");
+
+  ret = queue_signalled_destroy(&m->async.queue);
+  if (ret)
+    throw RuntimeError("Failed to destroy queue");
+
+  ret = pool_destroy(&m->async.pool);
+  if (ret)
+    throw RuntimeError("Failed to destroy pool");
+}
+
 int villas::node::mqtt_start(NodeCompat *n) {
   int ret;
   auto *m = n->getData<struct mqtt>();
 
+  if (m->publish) {
+    ret = mosquitto_max_inflight_messages_set(m->client, m->async.max_inflight);
+    if (ret != MOSQ_ERR_SUCCESS)
+      goto mosquitto_error;
+  }
+
   if (m->username && m->password) {
     ret = mosquitto_username_pw_set(m->client, m->username, m->password);
     if (ret != MOSQ_ERR_SUCCESS)
@@ -370,6 +548,10 @@ int villas::node::mqtt_start(NodeCompat *n) {
   if (ret != MOSQ_ERR_SUCCESS)
     goto mosquitto_error;
 
+  // Started last, so that the publisher thread does not leak if we fail
+  if (m->publish)
+    mqtt_async_start(n);
+
   return 0;
 
 mosquitto_error:
@@ -382,6 +564,10 @@ int villas::node::mqtt_stop(NodeCompat *n) {
   int ret;
   auto *m = n->getData<struct mqtt>();
 
+  // Queued samples are published before disconnecting
+  if (m->publish)
+    mqtt_async_stop(n);
+
   ret = mosquitto_disconnect(m->client);
   if (ret != MOSQ_ERR_SUCCESS)
     goto mosquitto_error;
@@ -448,29 +634,50 @@ int villas::node::mqtt_read(NodeCompat *n, struct Sample *const smps[],
   return pulled;
 }
 
+/* Queue samples for mqtt_async_publisher().
+ *
+ * The calling path never waits for the broker. Samples which do not fit into
+ * the pool, or whose publication failed, are accounted as dropped. */
 int villas::node::mqtt_write(NodeCompat *n, struct Sample *const smps[],
                              unsigned cnt) {
   int ret;
   auto *m = n->getData<struct mqtt>();
 
-  size_t wbytes;
+  if (!m->publish) {
+    n->logger->warn(
+        "No publish possible because no publish topic is configured");
+    return cnt;
+  }
 
-  char data[1500];
+  struct Sample *cpys[cnt];
 
-  ret = m->formatter->sprint(data, sizeof(data), &wbytes, smps, cnt);
-  if (ret < 0)
-    return ret;
+  // An exhausted pool means that the broker does not keep up
+  ret = sample_alloc_many(&m->async.pool, cpys, cnt);
+  unsigned avail = std::max(ret, 0);
 
-  if (m->publish) {
-    ret = mosquitto_publish(m->client, nullptr /* mid */, m->publish, wbytes,
-                            data, m->qos, m->retain);
-    if (ret != MOSQ_ERR_SUCCESS) {
-      n->logger->warn("Publish failed: {}", mosquitto_strerror(ret));
-      return -abs(ret);
-    }
-  } else
-    n->logger->warn(
-        "No publish possible because no publish topic is configured");
+  sample_copy_many(cpys, smps, avail);
+
+  // Fails only if the publisher has already been stopped
+  ret = queue_signalled_push_many(&m->async.queue, (void **)cpys, avail);
+  if (ret < (int)avail) {
+    sample_decref_many(cpys + std::max(ret, 0), avail - std::max(ret, 0));
+    if (ret < 0)
+      return ret;
+  }
+
+  size_t dropped = m->async.dropped.exchange(0) + cnt - avail;
+  if (dropped > 0)
+    n->logger->debug("Queue overrun or failed publish: dropped={}", dropped);
+
+  auto stats = n->getStats();
+  if (stats) {
+    if (dropped > 0)
+      stats->update(Stats::Metric::MQTT_DROPPED, dropped);
+
+    stats->update(Stats::Metric::MQTT_QUEUED,
+                  queue_signalled_available(&m->async.queue));
+    stats->update(Stats::Metric::MQTT_INFLIGHT, m->async.inflight);
+  }
 
   return cnt;
 }
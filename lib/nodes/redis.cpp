@@ -6,7 +6,9 @@
  */
 
 #include <chrono>
+#include <iterator>
 #include <unordered_map>
+#include <vector>
 
 #include <sys/time.h>
 
@@ -33,6 +35,13 @@ static void redis_on_message(NodeCompat *n, const std::string &channel,
 static std::unordered_map<sw::redis::ConnectionOptions, RedisConnection *>
     connections;
 
+// Field of a stream entry which holds the encoded samples.
+static const char *redis_stream_field = "data";
+
+using RedisAttrs = std::vector<std::pair<std::string, std::string>>;
+using RedisItem = std::pair<std::string, sw::redis::Optional<RedisAttrs>>;
+using RedisItemStream = std::vector<RedisItem>;
+
 RedisConnection::RedisConnection(const sw::redis::ConnectionOptions &opts)
     : context(opts), subscriber(context.subscriber()),
       logger(Log::get("nodes:redis")) {
@@ -248,6 +257,115 @@ out:
   sample_decref_many(smps + pushed, alloc - pushed);
 }
 
+static void redis_on_entries(NodeCompat *n, const RedisItemStream &items) {
+  auto *r = n->getData<struct redis>();
+
+  int alloc, scanned = 0, pushed = 0;
+  unsigned cnt = items.size();
+  struct Sample *smps[cnt];
+
+  alloc = sample_alloc_many(&r->pool, smps, cnt);
+  if (alloc < 0) {
+    n->logger->error("Failed to allocate samples");
+    return;
+  } else if ((unsigned)alloc < cnt)
+    n->logger->warn("Pool underrun");
+
+  for (auto &item : items) {
+    // Entries which have been deleted after being delivered have no fields
+    if (!item.second)
+      continue;
+
+    for (auto &attr : *item.second) {
+      if (attr.first != redis_stream_field || scanned >= alloc)
+        continue;
+
+      size_t rbytes;
+      int ret = r->formatter->sscan(attr.second.c_str(), attr.second.size(),
+                                    &rbytes, smps + scanned, alloc - scanned);
+      if (ret < 0) {
+        n->logger->warn("Failed to decode entry {}", item.first);
+        continue;
+      }
+
+      scanned += ret;
+    }
+  }
+
+  pushed = queue_signalled_push_many(&r->queue, (void **)smps, scanned);
+  if (pushed < 0) {
+    n->logger->error("Failed to enqueue");
+    pushed = 0;
+  } else if (pushed != scanned)
+    n->logger->warn("Queue underrun");
+
+  sample_decref_many(smps + pushed, alloc - pushed);
+}
+
+static void redis_stream_loop(NodeCompat *n) {
+  auto *r = n->getData<struct redis>();
+
+  /* Blocking reads use a connection of their own in order to not stall
+   * other commands on the shared one. The block timeout must expire before
+   * the socket timeout and bounds the time it takes to stop the node. */
+  sw::redis::Redis redis(r->options);
+
+  auto block = std::chrono::milliseconds(100);
+  if (r->options.socket_timeout.count() > 0)
+    block = std::min(block, r->options.socket_timeout / 2);
+
+  // Resolved by redis_start() before the thread has been started
+  std::string id = r->last_id;
+
+  while (!r->stopping) {
+    std::vector<std::pair<std::string, RedisItemStream>> streams;
+
+    try {
+      if (r->group.empty())
+        redis.xread(r->key, id, block, n->in.vectorize,
+                    std::back_inserter(streams));
+      else
+        redis.xreadgroup(r->group, r->consumer, r->key, ">", block,
+                         n->in.vectorize, false, std::back_inserter(streams));
+    } catch (const sw::redis::TimeoutError &e) {
+      continue;
+    } catch (const sw::redis::Error &e) {
+      n->logger->error("Failed to read from stream: {}", e.what());
+      std::this_thread::sleep_for(block);
+      continue;
+    }
+
+    for (auto &stream : streams) {
+      auto &items = stream.second;
+      if (items.empty())
+        continue;
+
+      redis_on_entries(n, items);
+
+      if (r->group.empty()) {
+        id = items.back().first;
+        continue;
+      }
+
+      std::vector<std::string> ids;
+      for (auto &item : items)
+        ids.push_back(item.first);
+
+      try {
+        redis.xack(r->key, r->group, ids.begin(), ids.end());
+      } catch (const sw::redis::Error &e) {
+        n->logger->error("Failed to acknowledge entries: {}", e.what());
+      }
+    }
+  }
+}
+
+// Samples are delivered through the queue rather than read on demand.
+static bool redis_is_queued(const struct redis *r) {
+  return r->notify || r->mode == RedisMode::CHANNEL ||
+         r->mode == RedisMode::STREAM;
+}
+
 int villas::node::redis_init(NodeCompat *n) {
   auto *r = n->getData<struct redis>();
 
@@ -255,10 +373,17 @@ int villas::node::redis_init(NodeCompat *n) {
   r->formatter = nullptr;
   r->notify = true;
   r->rate = 1.0;
+  r->maxlen = 10000;
+  r->stopping = false;
 
   new (&r->options) sw::redis::ConnectionOptions;
   new (&r->task) Task();
   new (&r->key) std::string();
+  new (&r->group) std::string();
+  new (&r->consumer) std::string();
+  new (&r->last_id) std::string();
+  new (&r->pipeline) std::unique_ptr<sw::redis::Pipeline>();
+  new (&r->thread) std::thread();
 
   /* We need a timeout in order for RedisConnection::loop() to properly
    * terminate after the node is stopped */
@@ -276,9 +401,15 @@ int villas::node::redis_destroy(NodeCompat *n) {
 
   using string = std::string;
   using redis_co = sw::redis::ConnectionOptions;
+  using pipeline_ptr = std::unique_ptr<sw::redis::Pipeline>;
 
   r->options.~redis_co();
   r->key.~string();
+  r->group.~string();
+  r->consumer.~string();
+  r->last_id.~string();
+  r->pipeline.~pipeline_ptr();
+  r->thread.~thread();
   r->task.~Task();
 
   ret = queue_signalled_destroy(&r->queue);
@@ -308,6 +439,9 @@ int villas::node::redis_parse(NodeCompat *n, json_t *json) {
   const char *uri = nullptr;
   const char *key = nullptr;
   const char *channel = nullptr;
+  const char *group = nullptr;
+  const char *consumer = nullptr;
+  json_int_t maxlen = -1;
   int keepalive = -1;
   int db = -1;
   int notify = -1;
@@ -318,12 +452,14 @@ int villas::node::redis_parse(NodeCompat *n, json_t *json) {
   ret = json_unpack_ex(
       json, &err, 0,
       "{ s?: o, s?: s, s?: s, s?: i, s?: s, s?: s, s?: s, s?: i, s?: { s?: F, "
-      "s?: F }, s?: o, s?: b, s?: s, s?: s, s?: s, s?: b, s?: F }",
+      "s?: F }, s?: o, s?: b, s?: s, s?: s, s?: s, s?: b, s?: F, s?: I, "
+      "s?: s, s?: s }",
       "format", &json_format, "uri", &uri, "host", &host, "port",
       &r->options.port, "path", &path, "user", &user, "password", &password,
       "db", &db, "timeout", "connect", &connect_timeout, "socket",
       &socket_timeout, "ssl", &json_ssl, "keepalive", &keepalive, "mode", &mode,
-      "key", &key, "channel", &channel, "notify", &notify, "rate", &r->rate);
+      "key", &key, "channel", &channel, "notify", &notify, "rate", &r->rate,
+      "maxlen", &maxlen, "group", &group, "consumer", &consumer);
   if (ret)
     throw ConfigError(json, err, "node-config-node-redis",
                       "Failed to parse node configuration");
@@ -368,6 +504,8 @@ int villas::node::redis_parse(NodeCompat *n, json_t *json) {
       r->mode = RedisMode::HASH;
     else if (!strcmp(mode, "channel") || !strcmp(mode, "pub-sub"))
       r->mode = RedisMode::CHANNEL;
+    else if (!strcmp(mode, "stream") || !strcmp(mode, "xadd-xread"))
+      r->mode = RedisMode::STREAM;
     else
       throw ConfigError(json, "node-config-node-redis-mode",
                         "Invalid Redis mode: {}", mode);
@@ -382,7 +520,7 @@ int villas::node::redis_parse(NodeCompat *n, json_t *json) {
     throw ConfigError(json_format, "node-config-node-redis-format",
                       "Invalid format configuration");
 
-  if (key && r->mode == RedisMode::KEY)
+  if (key && (r->mode == RedisMode::KEY || r->mode == RedisMode::STREAM))
     r->key = key;
   if (channel && r->mode == RedisMode::CHANNEL)
     r->key = channel;
@@ -390,6 +528,22 @@ int villas::node::redis_parse(NodeCompat *n, json_t *json) {
   if (notify >= 0)
     r->notify = notify != 0;
 
+  // Streams
+  if (maxlen >= 0)
+    r->maxlen = maxlen;
+
+  if (group || consumer) {
+    if (r->mode != RedisMode::STREAM)
+      throw ConfigError(json, "node-config-node-redis-group",
+                        "Consumer groups are only supported in stream mode");
+
+    if (group)
+      r->group = group;
+
+    if (consumer)
+      r->consumer = consumer;
+  }
+
   // Connection options
   if (uri)
     r->options = make_redis_connection_options(uri);
@@ -446,6 +600,13 @@ char *villas::node::redis_print(NodeCompat *n) {
   if (!r->notify)
     ss << ", rate=" << r->rate;
 
+  if (r->mode == RedisMode::STREAM) {
+    ss << ", maxlen=" << r->maxlen;
+
+    if (!r->group.empty())
+      ss << ", group=" << r->group << ", consumer=" << r->consumer;
+  }
+
   ss << ", " << r->options;
 
   return strdup(ss.str().c_str());
@@ -461,6 +622,9 @@ int villas::node::redis_prepare(NodeCompat *n) {
   if (r->key.empty())
     r->key = n->getNameShort();
 
+  if (r->consumer.empty())
+    r->consumer = n->getNameShort();
+
   ret = queue_signalled_init(&r->queue, 1024);
   if (ret)
     return ret;
@@ -481,7 +645,7 @@ int villas::node::redis_start(NodeCompat *n) {
 
   r->formatter->start(n->getInputSignals(false), ~(int)SampleFlags::HAS_OFFSET);
 
-  if (!r->notify)
+  if (!redis_is_queued(r))
     r->task.setRate(r->rate);
 
   switch (r->mode) {
@@ -496,6 +660,42 @@ int villas::node::redis_start(NodeCompat *n) {
       r->conn->subscribe(n, pattern);
     }
     break;
+
+  case RedisMode::STREAM:
+    if (!r->group.empty()) {
+      try {
+        r->conn->context.xgroup_create(r->key, r->group, "$", true);
+      } catch (const sw::redis::ReplyError &e) {
+        // Other instances might have created the group already
+        if (std::string(e.what()).find("BUSYGROUP") == std::string::npos)
+          throw RuntimeError("Failed to create consumer group: {}", e.what());
+      }
+    }
+
+    if (n->in.enabled) {
+      /* Without a consumer group, we continue after the last entry which
+       * has been added before the node was started. This is resolved here
+       * rather than in the thread, as entries added after redis_start()
+       * returned must not be skipped. */
+      if (r->group.empty()) {
+        try {
+          RedisItemStream last;
+          r->conn->context.xrevrange(r->key, "+", "-", 1,
+                                     std::back_inserter(last));
+
+          r->last_id = last.empty() ? "0-0" : last.front().first;
+        } catch (const sw::redis::Error &e) {
+          throw RuntimeError("Failed to get last entry of stream: {}",
+                             e.what());
+        }
+      }
+
+      r->stopping = false;
+      r->thread = std::thread(redis_stream_loop, n);
+    }
+
+    // Streams do not need the subscriber
+    return 0;
   }
 
   r->conn->start();
@@ -507,11 +707,19 @@ int villas::node::redis_stop(NodeCompat *n) {
   int ret;
   auto *r = n->getData<struct redis>();
 
-  r->conn->stop();
+  if (r->mode == RedisMode::STREAM) {
+    r->stopping = true;
 
-  if (!r->notify)
+    if (r->thread.joinable())
+      r->thread.join();
+  } else
+    r->conn->stop();
+
+  if (!redis_is_queued(r))
     r->task.stop();
 
+  r->pipeline.reset();
+
   switch (r->mode) {
   case RedisMode::CHANNEL:
     r->conn->unsubscribe(n, r->key);
@@ -524,6 +732,9 @@ int villas::node::redis_stop(NodeCompat *n) {
       r->conn->unsubscribe(n, pattern);
     }
     break;
+
+  case RedisMode::STREAM:
+    break;
   }
 
   ret = queue_signalled_close(&r->queue);
@@ -538,7 +749,7 @@ int villas::node::redis_read(NodeCompat *n, struct Sample *const smps[],
   auto *r = n->getData<struct redis>();
 
   // Wait for new data
-  if (r->notify || r->mode == RedisMode::CHANNEL) {
+  if (redis_is_queued(r)) {
     int pulled_cnt;
     struct Sample *pulled_smps[cnt];
 
@@ -564,17 +775,46 @@ int villas::node::redis_write(NodeCompat *n, struct Sample *const smps[],
 
   switch (r->mode) {
   case RedisMode::CHANNEL:
-    for (unsigned i = 0; i < cnt; i++) {
-      char buf[1500];
-      size_t wbytes;
-
-      ret = r->formatter->sprint(buf, sizeof(buf), &wbytes, &smps[i], cnt);
-      if (ret < 0)
-        return ret;
-
-      auto value = std::string_view(buf, wbytes);
+  case RedisMode::STREAM:
+    /* All commands of a write are sent in a single round-trip.
+     * The pipeline uses a dedicated connection which is re-established after
+     * a failure. */
+    try {
+      if (!r->pipeline)
+        r->pipeline = std::make_unique<sw::redis::Pipeline>(
+            r->conn->context.pipeline());
+
+      for (unsigned i = 0; i < cnt; i++) {
+        char buf[DEFAULT_FORMAT_BUFFER_LENGTH];
+        size_t wbytes;
+
+        ret = r->formatter->sprint(buf, sizeof(buf), &wbytes, &smps[i], 1);
+        if (ret < 0) {
+          r->pipeline->discard();
+          return ret;
+        }
+
+        auto value = std::string_view(buf, wbytes);
+
+        if (r->mode == RedisMode::CHANNEL)
+          r->pipeline->publish(r->key, value);
+        else {
+          std::pair<std::string_view, std::string_view> attrs[] = {
+              {redis_stream_field, value}};
+
+          if (r->maxlen > 0)
+            r->pipeline->xadd(r->key, "*", attrs, attrs + 1, r->maxlen, true);
+          else
+            r->pipeline->xadd(r->key, "*", attrs, attrs + 1);
+        }
+      }
+
+      r->pipeline->exec();
+    } catch (const sw::redis::Error &e) {
+      n->logger->error("Failed to write: {}", e.what());
 
-      r->conn->context.publish(r->key, value);
+      r->pipeline.reset();
+      return -1;
     }
     break;
 
@@ -618,7 +858,8 @@ int villas::node::redis_write(NodeCompat *n, struct Sample *const smps[],
 int villas::node::redis_poll_fds(NodeCompat *n, int fds[]) {
   auto *r = n->getData<struct redis>();
 
-  fds[0] = r->notify ? queue_signalled_fd(&r->queue) : r->task.getFD();
+  fds[0] = redis_is_queued(r) ? queue_signalled_fd(&r->queue)
+                               : r->task.getFD();
 
   return 1;
 }
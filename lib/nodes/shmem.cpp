@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <cerrno>
 #include <cstring>
 
 #include <fcntl.h>
@@ -33,7 +34,11 @@ int villas::node::shmem_init(NodeCompat *n) {
   shm->conf.queuelen = -1;
   shm->conf.samplelen = -1;
   shm->conf.polling = false;
+  shm->conf.mode = QueueSignalledMode::AUTO;
   shm->exec = nullptr;
+  shm->in_name = nullptr;
+  shm->out_name = nullptr;
+  shm->broadcast = 0;
 
   return 0;
 }
@@ -43,21 +48,40 @@ int villas::node::shmem_parse(NodeCompat *n, json_t *json) {
   const char *val, *mode_str = nullptr;
 
   int ret;
+  int bcast_in = 0, bcast_out = 0;
   json_t *json_exec = nullptr;
   json_error_t err;
 
   ret = json_unpack_ex(
-      json, &err, 0, "{ s: { s: s }, s: { s: s }, s?: i, s?: o, s?: s }", "out",
-      "name", &shm->out_name, "in", "name", &shm->in_name, "queuelen",
-      &shm->conf.queuelen, "exec", &json_exec, "mode", &mode_str);
+      json, &err, 0,
+      "{ s?: { s: s, s?: b }, s?: { s: s, s?: b }, s?: i, s?: o, s?: s }",
+      "out", "name", &shm->out_name, "broadcast", &bcast_out, "in", "name",
+      &shm->in_name, "broadcast", &bcast_in, "queuelen", &shm->conf.queuelen,
+      "exec", &json_exec, "mode", &mode_str);
   if (ret)
     throw ConfigError(json, err, "node-config-node-shmem");
 
+  shm->broadcast = bcast_in || bcast_out;
+
+  if (shm->broadcast) {
+    if ((shm->in_name && !bcast_in) || (shm->out_name && !bcast_out))
+      throw ConfigError(json, "node-config-node-shmem-broadcast",
+                        "Broadcast rings and queues can not be mixed");
+  } else if (!shm->in_name || !shm->out_name)
+    throw ConfigError(json, "node-config-node-shmem",
+                      "Settings 'in.name' and 'out.name' are required");
+
   if (mode_str) {
     if (!strcmp(mode_str, "polling"))
       shm->conf.polling = true;
     else if (!strcmp(mode_str, "pthread"))
-      shm->conf.polling = false;
+      shm->conf.mode = QueueSignalledMode::PTHREAD;
+#ifdef __linux__
+    else if (!strcmp(mode_str, "futex"))
+      shm->conf.mode = QueueSignalledMode::FUTEX;
+#endif
+    else if (!strcmp(mode_str, "auto"))
+      shm->conf.mode = QueueSignalledMode::AUTO;
     else
       throw SystemError("Unknown mode '{}'", mode_str);
   }
@@ -105,6 +129,37 @@ int villas::node::shmem_prepare(NodeCompat *n) {
   return 0;
 }
 
+static void shmem_broadcast_start(NodeCompat *n) {
+  auto *shm = n->getData<struct shmem>();
+  int ret;
+
+  if (shm->out_name) {
+    ret = shmem_bcast_create(shm->out_name, &shm->bcast_out,
+                             shm->conf.queuelen, shm->conf.samplelen);
+    if (ret < 0)
+      throw SystemError("Failed to create broadcast ring '{}'", shm->out_name);
+  }
+
+  if (shm->in_name) {
+    // Wait for the writer to create the ring
+    bool waiting = false;
+    while (shmem_bcast_attach(shm->in_name, &shm->bcast_in) < 0) {
+      if (errno != ENOENT && errno != EAGAIN)
+        throw SystemError("Failed to attach to broadcast ring '{}'",
+                          shm->in_name);
+
+      if (!waiting) {
+        n->logger->info("Waiting for broadcast ring '{}'", shm->in_name);
+        waiting = true;
+      }
+
+      usleep(100000);
+    }
+
+    shm->lost = 0;
+  }
+}
+
 int villas::node::shmem_start(NodeCompat *n) {
   auto *shm = n->getData<struct shmem>();
   int ret;
@@ -117,6 +172,12 @@ int villas::node::shmem_start(NodeCompat *n) {
     sleep(1);
   }
 
+  if (shm->broadcast) {
+    shmem_broadcast_start(n);
+
+    return 0;
+  }
+
   ret = shmem_int_open(shm->out_name, shm->in_name, &shm->intf, &shm->conf);
   if (ret < 0)
     throw SystemError("Opening shared memory interface failed (ret={})", ret);
@@ -126,6 +187,23 @@ int villas::node::shmem_start(NodeCompat *n) {
 
 int villas::node::shmem_stop(NodeCompat *n) {
   auto *shm = n->getData<struct shmem>();
+  int ret;
+
+  if (shm->broadcast) {
+    if (shm->out_name) {
+      ret = shmem_bcast_close(&shm->bcast_out);
+      if (ret)
+        return ret;
+    }
+
+    if (shm->in_name) {
+      ret = shmem_bcast_close(&shm->bcast_in);
+      if (ret)
+        return ret;
+    }
+
+    return 0;
+  }
 
   return shmem_int_close(&shm->intf);
 }
@@ -136,6 +214,31 @@ int villas::node::shmem_read(NodeCompat *n, struct Sample *const smps[],
   int recv;
   struct Sample *shared_smps[cnt];
 
+  if (shm->broadcast) {
+    if (!shm->in_name)
+      return -1;
+
+    recv = shmem_bcast_read(&shm->bcast_in, smps, cnt);
+    if (recv < 0) {
+      n->logger->info("Broadcast ring has been closed.");
+
+      n->setState(State::STOPPING);
+
+      return recv;
+    }
+
+    if (shm->bcast_in.lost != shm->lost) {
+      n->logger->warn("Missed {} samples of broadcast ring",
+                      shm->bcast_in.lost - shm->lost);
+      shm->lost = shm->bcast_in.lost;
+    }
+
+    for (int i = 0; i < recv; i++)
+      smps[i]->signals = n->getInputSignals(false);
+
+    return recv;
+  }
+
   do {
     recv = shmem_int_read(&shm->intf, shared_smps, cnt);
   } while (recv == 0);
@@ -168,6 +271,13 @@ int villas::node::shmem_write(NodeCompat *n, struct Sample *const smps[],
       *shared_smps[cnt]; // Samples need to be copied to the shared pool first
   int avail, pushed, copied;
 
+  if (shm->broadcast) {
+    if (!shm->out_name)
+      return -1;
+
+    return shmem_bcast_write(&shm->bcast_out, smps, cnt);
+  }
+
   avail = sample_alloc_many(&shm->intf.write.shared->pool, shared_smps, cnt);
   if (avail != (int)cnt)
     n->logger->warn("Pool underrun for shmem node {}", shm->out_name);
@@ -188,9 +298,13 @@ char *villas::node::shmem_print(NodeCompat *n) {
   char *buf = nullptr;
 
   strcatf(&buf, "out_name=%s, in_name=%s, queuelen=%d, polling=%s",
-          shm->out_name, shm->in_name, shm->conf.queuelen,
+          shm->out_name ? shm->out_name : "",
+          shm->in_name ? shm->in_name : "", shm->conf.queuelen,
           shm->conf.polling ? "yes" : "no");
 
+  if (shm->broadcast)
+    strcatf(&buf, ", broadcast=yes");
+
   if (shm->exec) {
     strcatf(&buf, ", exec='");
 
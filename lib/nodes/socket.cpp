@@ -5,11 +5,17 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <vector>
 
 #include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
 #include <netinet/ip.h>
+#include <netinet/udp.h>
+#include <poll.h>
 #include <unistd.h>
 
 #include <villas/compat.hpp>
@@ -17,11 +23,14 @@
 #include <villas/nodes/socket.hpp>
 #include <villas/queue.h>
 #include <villas/sample.hpp>
+#include <villas/stats.hpp>
 #include <villas/super_node.hpp>
 #include <villas/utils.hpp>
 
 #ifdef WITH_SOCKET_LAYER_ETH
+#include <linux/if_packet.h>
 #include <netinet/ether.h>
+#include <sys/mman.h>
 #endif // WITH_SOCKET_LAYER_ETH
 
 #ifdef WITH_NETEM
@@ -29,6 +38,11 @@
 #include <villas/kernel/nl.hpp>
 #endif // WITH_NETEM
 
+#ifdef WITH_LIBURING
+#include <liburing.h>
+#include <sys/eventfd.h>
+#endif // WITH_LIBURING
+
 #define MAX_CONNECTION_RETRIES 40
 #define RETRIES_DELAY 2
 
@@ -41,6 +55,24 @@ using namespace villas::kernel;
 static NodeCompatType p;
 static NodeCompatFactory ncp(&p);
 
+#ifdef WITH_LIBURING
+static void socket_uring_start(NodeCompat *n);
+static void socket_uring_stop(NodeCompat *n);
+static int socket_read_uring(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt);
+static int socket_write_uring(NodeCompat *n, struct Sample *const smps[],
+                              unsigned cnt);
+#endif // WITH_LIBURING
+
+#ifdef WITH_SOCKET_LAYER_ETH
+static void socket_ring_start(NodeCompat *n);
+static void socket_ring_stop(NodeCompat *n);
+static int socket_read_ring(NodeCompat *n, struct Sample *const smps[],
+                            unsigned cnt);
+static int socket_write_ring(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt);
+#endif // WITH_SOCKET_LAYER_ETH
+
 int villas::node::socket_type_start(villas::node::SuperNode *sn) {
 #ifdef WITH_NETEM
   if (sn != nullptr) {
@@ -116,6 +148,19 @@ char *villas::node::socket_print(NodeCompat *n) {
 
   buf = strf("layer=%s, in.address=%s, out.address=%s", layer, local, remote);
 
+  if (s->batch)
+    strcatf(&buf, ", batch=yes");
+
+  if (s->backend == SocketBackend::IO_URING)
+    strcatf(&buf, ", io_backend=io_uring");
+  else if (s->backend == SocketBackend::PACKET_MMAP)
+    strcatf(&buf, ", io_backend=packet_mmap");
+
+  if (s->timestamping.rx || s->timestamping.tx)
+    strcatf(&buf, ", timestamping.rx=%s, timestamping.tx=%s",
+            s->timestamping.rx ? "yes" : "no",
+            s->timestamping.tx ? "yes" : "no");
+
   if (s->multicast.enabled) {
     char group[INET_ADDRSTRLEN];
     char interface[INET_ADDRSTRLEN];
@@ -166,6 +211,53 @@ int villas::node::socket_check(NodeCompat *n) {
   }
 #endif // WITH_SOCKET_LAYER_ETH
 
+  if (s->batch && (s->layer == SocketLayer::TCP_CLIENT ||
+                   s->layer == SocketLayer::TCP_SERVER))
+    throw RuntimeError("Setting 'batch' is not supported by TCP layers");
+
+  if ((s->gso || s->gro) && s->layer != SocketLayer::UDP)
+    throw RuntimeError("Settings 'out.gso' and 'in.gro' require the UDP layer");
+
+  if ((s->gso || s->gro) && !s->batch)
+    throw RuntimeError("Settings 'out.gso' and 'in.gro' require 'batch'");
+
+  if (s->backend == SocketBackend::IO_URING) {
+    if (s->layer == SocketLayer::TCP_CLIENT ||
+        s->layer == SocketLayer::TCP_SERVER)
+      throw RuntimeError("The io_uring backend is not supported by TCP layers");
+
+    if (s->verify_source)
+      throw RuntimeError(
+          "Setting 'verify_source' is not supported by the io_uring backend");
+
+    if (s->gso || s->gro)
+      throw RuntimeError("Settings 'out.gso' and 'in.gro' are not supported by "
+                         "the io_uring backend");
+  }
+
+  if (s->backend == SocketBackend::PACKET_MMAP &&
+      s->layer != SocketLayer::ETH)
+    throw RuntimeError("The packet_mmap backend requires the eth layer");
+
+  if (s->timestamping.rx || s->timestamping.tx) {
+    if (s->layer != SocketLayer::UDP && s->layer != SocketLayer::IP &&
+        s->layer != SocketLayer::ETH)
+      throw RuntimeError(
+          "Setting 'timestamping' requires the udp, ip or eth layer");
+
+    if (s->backend == SocketBackend::IO_URING)
+      throw RuntimeError(
+          "Setting 'timestamping' is not supported by the io_uring backend");
+  }
+
+  if (s->timestamping.tx) {
+    if (s->layer == SocketLayer::ETH)
+      throw RuntimeError("TX timestamps are not supported by the eth layer");
+
+    if (s->gso)
+      throw RuntimeError("TX timestamps are not supported with 'out.gso'");
+  }
+
   if (s->multicast.enabled) {
     if (s->in.saddr.sa.sa_family != AF_INET)
       throw RuntimeError("Multicast is only supported by IPv4");
@@ -303,15 +395,84 @@ int villas::node::socket_start(NodeCompat *n) {
 #endif // __linux__
   }
 
-  s->out.buflen = SOCKET_INITIAL_BUFFER_LEN;
-  s->out.buf = new char[s->out.buflen];
-  if (!s->out.buf)
-    throw MemoryAllocationError();
+  /* With batching, each direction uses a vector of fixed-size datagram
+   * buffers. Otherwise a single buffer is used which grows on demand.
+   * UDP GSO / GRO super-buffers can carry up to SOCKET_GSO_MAX_SEGMENTS
+   * datagrams. */
+  auto alloc = [s](auto &d, unsigned vectorize, bool offload) {
+    if (s->batch && offload) {
+      d.batchlen = std::clamp(vectorize / SOCKET_GSO_MAX_SEGMENTS, 1U,
+                              (unsigned)SOCKET_MAX_BATCH);
+      d.buflen = SOCKET_INITIAL_BUFFER_LEN;
+    } else if (s->batch) {
+      d.batchlen = std::clamp(vectorize, 1U, (unsigned)SOCKET_MAX_BATCH);
+      d.buflen = SOCKET_BATCH_BUFFER_LEN;
+    } else {
+      d.batchlen = 1;
+      d.buflen = SOCKET_INITIAL_BUFFER_LEN;
+    }
 
-  s->in.buflen = SOCKET_INITIAL_BUFFER_LEN;
-  s->in.buf = new char[s->in.buflen];
-  if (!s->in.buf)
-    throw MemoryAllocationError();
+    d.buf = new char[d.buflen * d.batchlen];
+    d.ctrl = new char[d.batchlen * SOCKET_CONTROL_LEN];
+    if (!d.buf || !d.ctrl)
+      throw MemoryAllocationError();
+
+    if (s->batch) {
+      d.msgs = new struct mmsghdr[d.batchlen];
+      d.iovs = new struct iovec[d.batchlen];
+      d.addrs = new union sockaddr_union[d.batchlen];
+      if (!d.msgs || !d.iovs || !d.addrs)
+        throw MemoryAllocationError();
+    }
+  };
+
+  alloc(s->out, n->out.vectorize, s->gso);
+  alloc(s->in, n->in.vectorize, s->gro);
+
+  if (s->gro) {
+    int en = 1;
+
+    ret = setsockopt(s->sd, SOL_UDP, UDP_GRO, &en, sizeof(en));
+    if (ret)
+      throw SystemError("Failed to enable UDP GRO");
+  }
+
+  // Frames of the packet_mmap RX ring always carry a timestamp
+  int tsflags = 0;
+  if (s->timestamping.rx && s->backend != SocketBackend::PACKET_MMAP)
+    tsflags |= SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+
+  if (s->timestamping.tx) {
+    tsflags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+               SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+
+    s->timestamping.key = 0;
+    s->timestamping.samples =
+        new struct SocketTxSample[SOCKET_TIMESTAMP_HISTORY]();
+    s->timestamping.datagrams =
+        new struct SocketTxDatagram[SOCKET_TIMESTAMP_HISTORY]();
+    if (!s->timestamping.samples || !s->timestamping.datagrams)
+      throw MemoryAllocationError();
+
+    pthread_mutex_init(&s->timestamping.mutex, nullptr);
+  }
+
+  if (tsflags) {
+    ret = setsockopt(s->sd, SOL_SOCKET, SO_TIMESTAMPING, &tsflags,
+                     sizeof(tsflags));
+    if (ret)
+      throw SystemError("Failed to enable kernel timestamps");
+  }
+
+#ifdef WITH_LIBURING
+  if (s->backend == SocketBackend::IO_URING)
+    socket_uring_start(n);
+#endif // WITH_LIBURING
+
+#ifdef WITH_SOCKET_LAYER_ETH
+  if (s->backend == SocketBackend::PACKET_MMAP)
+    socket_ring_start(n);
+#endif // WITH_SOCKET_LAYER_ETH
 
   return 0;
 }
@@ -338,6 +499,14 @@ int villas::node::socket_stop(NodeCompat *n) {
       throw SystemError("Failed to leave multicast group");
   }
 
+#ifdef WITH_LIBURING
+  socket_uring_stop(n);
+#endif // WITH_LIBURING
+
+#ifdef WITH_SOCKET_LAYER_ETH
+  socket_ring_stop(n);
+#endif // WITH_SOCKET_LAYER_ETH
+
   if (s->sd >= 0) {
     // Close client socket descriptor.
     if (s->layer == SocketLayer::TCP_SERVER) {
@@ -358,6 +527,29 @@ int villas::node::socket_stop(NodeCompat *n) {
   delete[] s->in.buf;
   delete[] s->out.buf;
 
+  delete[] s->in.msgs;
+  delete[] s->in.iovs;
+  delete[] s->in.addrs;
+  delete[] s->in.ctrl;
+  delete[] s->out.msgs;
+  delete[] s->out.iovs;
+  delete[] s->out.addrs;
+  delete[] s->out.ctrl;
+
+  s->in.msgs = s->out.msgs = nullptr;
+  s->in.iovs = s->out.iovs = nullptr;
+  s->in.addrs = s->out.addrs = nullptr;
+  s->in.ctrl = s->out.ctrl = nullptr;
+
+  if (s->timestamping.samples)
+    pthread_mutex_destroy(&s->timestamping.mutex);
+
+  delete[] s->timestamping.samples;
+  delete[] s->timestamping.datagrams;
+
+  s->timestamping.samples = nullptr;
+  s->timestamping.datagrams = nullptr;
+
   return 0;
 }
 
@@ -404,50 +596,138 @@ static void socket_tcp_connection(NodeCompat *n, Socket *s) {
   }
 }
 
-int villas::node::socket_read(NodeCompat *n, struct Sample *const smps[],
-                              unsigned cnt) {
+// Get the kernel RX timestamp of a datagram. Returns nullptr if there is none.
+static const struct timespec *socket_rx_timestamp(struct Socket *s,
+                                                  struct msghdr *hdr,
+                                                  struct timespec *ts) {
+  if (!s->timestamping.rx)
+    return nullptr;
+
+  for (auto *cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      struct scm_timestamping tss;
+
+      memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+
+      *ts = tss.ts[0]; // Software timestamp
+
+      return ts;
+    }
+  }
+
+  return nullptr;
+}
+
+/* Collect the kernel TX timestamps of sent datagrams from the error queue.
+ *
+ * The timestamps are identified by the SOF_TIMESTAMPING_OPT_ID key which the
+ * kernel increments for each datagram sent over the socket. Only keys which
+ * we have recorded for our own datagrams are accepted.
+ */
+static void socket_tx_timestamps(NodeCompat *n) {
   int ret;
   auto *s = n->getData<struct Socket>();
 
-  char *ptr;
-  ssize_t bytes;
-  size_t rbytes;
+  char ctrl[SOCKET_CONTROL_LEN];
 
-  union sockaddr_union src;
-  socklen_t srclen = sizeof(src);
+  while (true) {
+    struct msghdr hdr = {};
 
-  // Receive next sample
+    hdr.msg_control = ctrl;
+    hdr.msg_controllen = sizeof(ctrl);
 
-  if (s->layer == SocketLayer::TCP_CLIENT) {
-    // Receive data from server.
-    if (!s->tcp_connected)
-      socket_tcp_connection(n, s);
+    ret = recvmsg(s->sd, &hdr, MSG_ERRQUEUE | MSG_DONTWAIT);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
 
-    bytes = recv(s->sd, s->in.buf, s->in.buflen, 0);
-  } else if (s->layer == SocketLayer::TCP_SERVER) {
-    // Receive data from client.
-    if (!s->tcp_connected)
-      socket_tcp_connection(n, s);
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        n->logger->warn("Failed to read error queue: {}", strerror(errno));
 
-    bytes = recv(s->clt_sd, s->in.buf, s->in.buflen, 0);
-  } else {
-    bytes = recvfrom(s->sd, s->in.buf, s->in.buflen, 0, &src.sa, &srclen);
+      break;
+    }
+
+    struct scm_timestamping tss;
+    struct sock_extended_err ee;
+    bool has_ts = false, has_ee = false;
+
+    for (auto *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+         cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type == SCM_TIMESTAMPING) {
+        memcpy(&tss, CMSG_DATA(cmsg), sizeof(tss));
+        has_ts = true;
+      } else if ((cmsg->cmsg_level == SOL_IP &&
+                  cmsg->cmsg_type == IP_RECVERR) ||
+                 (cmsg->cmsg_level == SOL_IPV6 &&
+                  cmsg->cmsg_type == IPV6_RECVERR)) {
+        memcpy(&ee, CMSG_DATA(cmsg), sizeof(ee));
+        has_ee = ee.ee_origin == SO_EE_ORIGIN_TIMESTAMPING;
+      }
+    }
+
+    if (!has_ts || !has_ee)
+      continue;
+
+    pthread_mutex_lock(&s->timestamping.mutex);
+
+    auto &d = s->timestamping.datagrams[ee.ee_data % SOCKET_TIMESTAMP_HISTORY];
+    if (d.key == ee.ee_data)
+      d.ts = tss.ts[0];
+
+    pthread_mutex_unlock(&s->timestamping.mutex);
   }
+}
 
-  if (bytes < 0) {
-    if (errno == EINTR)
-      return -1;
+// Remember the datagram in which samples are sent to find its TX timestamp.
+static void socket_tx_record(struct Socket *s, uint32_t key,
+                             struct Sample *const smps[], unsigned cnt) {
+  pthread_mutex_lock(&s->timestamping.mutex);
 
-    throw SystemError("Failed recvfrom()");
-  } else if (bytes == 0) {
-    if (s->layer == SocketLayer::TCP_CLIENT ||
-        s->layer == SocketLayer::TCP_SERVER)
-      s->tcp_connected = false;
+  auto &d = s->timestamping.datagrams[key % SOCKET_TIMESTAMP_HISTORY];
 
-    return 0;
+  d.key = key;
+  d.ts = {};
+
+  for (unsigned i = 0; i < cnt; i++) {
+    auto &e = s->timestamping.samples[smps[i]->sequence %
+                                      SOCKET_TIMESTAMP_HISTORY];
+
+    e.sequence = smps[i]->sequence;
+    e.key = key;
+  }
+
+  pthread_mutex_unlock(&s->timestamping.mutex);
+}
+
+// Forget the recorded datagram of samples which have not been sent.
+static void socket_tx_discard(struct Socket *s, struct Sample *const smps[],
+                              unsigned cnt) {
+  pthread_mutex_lock(&s->timestamping.mutex);
+
+  for (unsigned i = 0; i < cnt; i++) {
+    auto &e = s->timestamping.samples[smps[i]->sequence %
+                                      SOCKET_TIMESTAMP_HISTORY];
+
+    if (e.sequence == smps[i]->sequence)
+      e.sequence = UINT64_MAX;
   }
 
-  ptr = s->in.buf;
+  pthread_mutex_unlock(&s->timestamping.mutex);
+}
+
+/* Decode a single datagram into smps[] after stripping the IP header.
+ *
+ * If given, ts is the kernel RX timestamp of the datagram.
+ */
+static int socket_decode(NodeCompat *n, char *ptr, ssize_t bytes,
+                         union sockaddr_union *src, const struct timespec *ts,
+                         struct Sample *const smps[], unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+
+  size_t rbytes;
 
   // Strip IP header from packet
   if (s->layer == SocketLayer::IP) {
@@ -460,19 +740,20 @@ int villas::node::socket_read(NodeCompat *n, struct Sample *const smps[],
   /* SOCK_RAW IP sockets to not provide the IP protocol number via recvmsg()
    * So we simply set it ourself. */
   if (s->layer == SocketLayer::IP) {
-    switch (src.sa.sa_family) {
+    switch (src->sa.sa_family) {
     case AF_INET:
-      src.sin.sin_port = s->out.saddr.sin.sin_port;
+      src->sin.sin_port = s->out.saddr.sin.sin_port;
       break;
 
     case AF_INET6:
-      src.sin6.sin6_port = s->out.saddr.sin6.sin6_port;
+      src->sin6.sin6_port = s->out.saddr.sin6.sin6_port;
       break;
     }
   }
 
-  if (s->verify_source && socket_compare_addr(&src.sa, &s->out.saddr.sa) != 0) {
-    char *buf = socket_print_addr(reinterpret_cast<struct sockaddr *>(&src));
+  if (s->verify_source &&
+      socket_compare_addr(&src->sa, &s->out.saddr.sa) != 0) {
+    char *buf = socket_print_addr(reinterpret_cast<struct sockaddr *>(src));
     n->logger->warn("Received packet from unauthorized source: {}", buf);
     free(buf);
 
@@ -484,122 +765,1085 @@ int villas::node::socket_read(NodeCompat *n, struct Sample *const smps[],
     n->logger->warn("Received invalid packet: ret={}, bytes={}, rbytes={}", ret,
                     bytes, rbytes);
 
+  for (int i = 0; i < ret && ts; i++) {
+    smps[i]->ts.received = *ts;
+    smps[i]->flags |= (int)SampleFlags::HAS_TS_RECEIVED;
+  }
+
   return ret;
 }
 
-int villas::node::socket_write(NodeCompat *n, struct Sample *const smps[],
-                               unsigned cnt) {
-  auto *s = n->getData<struct Socket>();
+// Get the segment size of a datagram which has been coalesced by UDP GRO.
+static size_t socket_gro_size(struct msghdr *hdr) {
+  for (auto *cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int segsz;
+
+      memcpy(&segsz, CMSG_DATA(cmsg), sizeof(segsz));
+
+      return segsz;
+    }
+  }
+
+  return 0;
+}
 
+/* Receive up to cnt datagrams with a single recvmmsg() call.
+ *
+ * Each datagram is decoded independently into the next free samples.
+ */
+static int socket_read_batch(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt) {
   int ret;
-  ssize_t bytes;
-  size_t wbytes;
+  auto *s = n->getData<struct Socket>();
 
-retry:
-  ret = s->formatter->sprint(s->out.buf, s->out.buflen, &wbytes, smps, cnt);
-  if (ret < 0) {
-    n->logger->warn("Failed to format payload: reason={}", ret);
-    return ret;
+  unsigned vlen = std::min(cnt, s->in.batchlen);
+  unsigned nread = 0;
+
+  /* A coalesced datagram carries up to SOCKET_GSO_MAX_SEGMENTS samples.
+   * Only receive as many as fit into the sample array. */
+  if (s->gro)
+    vlen = std::clamp(cnt / SOCKET_GSO_MAX_SEGMENTS, 1U, s->in.batchlen);
+
+  for (unsigned i = 0; i < vlen; i++) {
+    auto *hdr = &s->in.msgs[i].msg_hdr;
+
+    s->in.iovs[i].iov_base = s->in.buf + i * s->in.buflen;
+    s->in.iovs[i].iov_len = s->in.buflen;
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->msg_name = &s->in.addrs[i];
+    hdr->msg_namelen = sizeof(s->in.addrs[i]);
+    hdr->msg_iov = &s->in.iovs[i];
+    hdr->msg_iovlen = 1;
+    hdr->msg_control = s->in.ctrl + i * SOCKET_CONTROL_LEN;
+    hdr->msg_controllen = SOCKET_CONTROL_LEN;
   }
 
-  if (wbytes == 0) {
-    n->logger->warn("Failed to format payload: wbytes={}", wbytes);
-    return -1;
+  // Block until the first datagram arrives. Then drain the rest.
+  ret = recvmmsg(s->sd, s->in.msgs, vlen, MSG_WAITFORONE, nullptr);
+  if (ret < 0) {
+    if (errno == EINTR)
+      return -1;
+
+    throw SystemError("Failed recvmmsg()");
   }
 
-  if (wbytes > s->out.buflen) {
-    s->out.buflen = wbytes;
+  if (s->timestamping.tx)
+    socket_tx_timestamps(n);
 
-    delete[] s->out.buf;
-    s->out.buf = new char[s->out.buflen];
-    if (!s->out.buf)
-      throw MemoryAllocationError();
+  auto stats = n->getStats();
+  if (stats)
+    stats->update(Stats::Metric::SOCKET_BATCH_RECV, ret);
 
-    goto retry;
+  if ((unsigned)ret < vlen)
+    n->logger->trace("Partial recvmmsg(): received={}, expected={}", ret,
+                     vlen);
+
+  for (int i = 0; i < ret; i++) {
+    auto *msg = &s->in.msgs[i];
+
+    if (msg->msg_hdr.msg_flags & MSG_TRUNC) {
+      n->logger->warn("Received truncated datagram: bytes={}", msg->msg_len);
+      continue;
+    }
+
+    if (nread == cnt) {
+      n->logger->warn("Dropped {} datagrams due to insufficient samples",
+                      ret - i);
+      break;
+    }
+
+    char *buf = s->in.buf + i * s->in.buflen;
+    size_t segsz = socket_gro_size(&msg->msg_hdr);
+    if (!segsz)
+      segsz = msg->msg_len;
+
+    struct timespec tsbuf;
+    auto *ts = socket_rx_timestamp(s, &msg->msg_hdr, &tsbuf);
+
+    // Split coalesced datagrams back into their segments
+    for (size_t off = 0; off < msg->msg_len && nread < cnt; off += segsz) {
+      size_t len = std::min<size_t>(segsz, msg->msg_len - off);
+
+      int decoded = socket_decode(n, buf + off, len, &s->in.addrs[i], ts,
+                                  &smps[nread], cnt - nread);
+      if (decoded > 0)
+        nread += decoded;
+    }
   }
 
-  // Send message
-  socklen_t addrlen = 0;
-  switch (s->in.saddr.ss.ss_family) {
-  case AF_INET:
-    addrlen = sizeof(struct sockaddr_in);
-    break;
+  return nread;
+}
 
-  case AF_INET6:
-    addrlen = sizeof(struct sockaddr_in6);
-    break;
+int villas::node::socket_read(NodeCompat *n, struct Sample *const smps[],
+                              unsigned cnt) {
+  auto *s = n->getData<struct Socket>();
 
-  case AF_UNIX:
-    addrlen = SUN_LEN(&s->out.saddr.sun);
-    break;
+  ssize_t bytes;
+
+  union sockaddr_union src;
+  struct iovec iov = {.iov_base = s->in.buf, .iov_len = s->in.buflen};
+  struct msghdr hdr = {};
+
+  hdr.msg_name = &src;
+  hdr.msg_namelen = sizeof(src);
+  hdr.msg_iov = &iov;
+  hdr.msg_iovlen = 1;
+  hdr.msg_control = s->in.ctrl;
+  hdr.msg_controllen = SOCKET_CONTROL_LEN;
+
+#ifdef WITH_LIBURING
+  if (s->uring)
+    return socket_read_uring(n, smps, cnt);
+#endif // WITH_LIBURING
 
 #ifdef WITH_SOCKET_LAYER_ETH
-  case AF_PACKET:
-    addrlen = sizeof(struct sockaddr_ll);
-    break;
+  if (s->ring)
+    return socket_read_ring(n, smps, cnt);
 #endif // WITH_SOCKET_LAYER_ETH
-  default:
-    addrlen = sizeof(s->in.saddr);
-  }
 
-retry2:
+  if (s->batch)
+    return socket_read_batch(n, smps, cnt);
+
+  // Receive next sample
+
   if (s->layer == SocketLayer::TCP_CLIENT) {
-    // Send data to TCP server.
-    bytes = send(s->sd, s->out.buf, wbytes, 0);
+    // Receive data from server.
+    if (!s->tcp_connected)
+      socket_tcp_connection(n, s);
+
+    bytes = recv(s->sd, s->in.buf, s->in.buflen, 0);
   } else if (s->layer == SocketLayer::TCP_SERVER) {
-    // Send data to TCP client.
-    bytes = send(s->clt_sd, s->out.buf, wbytes, 0);
+    // Receive data from client.
+    if (!s->tcp_connected)
+      socket_tcp_connection(n, s);
+
+    bytes = recv(s->clt_sd, s->in.buf, s->in.buflen, 0);
   } else {
-    bytes = sendto(s->sd, s->out.buf, wbytes, 0,
-                   (struct sockaddr *)&s->out.saddr, addrlen);
+    bytes = recvmsg(s->sd, &hdr, 0);
   }
 
   if (bytes < 0) {
-    if ((errno == EPERM) || (errno == ENOENT && s->layer == SocketLayer::UNIX))
-      n->logger->warn("Failed sendto(): {}", strerror(errno));
-    else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-      n->logger->warn("Blocking sendto()");
-      goto retry2;
-    } else
-      n->logger->warn("Failed sendto(): {}", strerror(errno));
-  } else if ((size_t)bytes < wbytes)
-    n->logger->warn("Partial sendto()");
+    if (errno == EINTR)
+      return -1;
 
-  return cnt;
-}
+    throw SystemError("Failed recvfrom()");
+  } else if (bytes == 0) {
+    if (s->layer == SocketLayer::TCP_CLIENT ||
+        s->layer == SocketLayer::TCP_SERVER)
+      s->tcp_connected = false;
 
-int villas::node::socket_parse(NodeCompat *n, json_t *json) {
-  int ret;
-  auto *s = n->getData<struct Socket>();
+    return 0;
+  }
 
-  const char *local, *remote;
-  const char *layer = nullptr;
+  if (s->timestamping.tx)
+    socket_tx_timestamps(n);
 
-  json_error_t err;
-  json_t *json_multicast = nullptr;
-  json_t *json_format = nullptr;
+  struct timespec tsbuf;
+  auto *ts = socket_rx_timestamp(s, &hdr, &tsbuf);
 
-  // Default values
-  s->layer = SocketLayer::UDP;
-  s->verify_source = 0;
+  return socket_decode(n, s->in.buf, bytes, &src, ts, smps, cnt);
+}
 
-  ret = json_unpack_ex(
-      json, &err, 0, "{ s?: s, s?: o, s: { s: s }, s: { s: s, s?: b, s?: o } }",
-      "layer", &layer, "format", &json_format, "out", "address", &remote, "in",
-      "address", &local, "verify_source", &s->verify_source, "multicast",
-      &json_multicast);
-  if (ret)
-    throw ConfigError(json, err, "node-config-node-socket");
+static socklen_t socket_remote_addrlen(struct Socket *s) {
+  switch (s->in.saddr.ss.ss_family) {
+  case AF_INET:
+    return sizeof(struct sockaddr_in);
 
-  // Format
-  if (s->formatter)
-    delete s->formatter;
-  s->formatter = json_format ? FormatFactory::make(json_format)
+  case AF_INET6:
+    return sizeof(struct sockaddr_in6);
+
+  case AF_UNIX:
+    return SUN_LEN(&s->out.saddr.sun);
+
+#ifdef WITH_SOCKET_LAYER_ETH
+  case AF_PACKET:
+    return sizeof(struct sockaddr_ll);
+#endif // WITH_SOCKET_LAYER_ETH
+  default:
+    return sizeof(s->in.saddr);
+  }
+}
+
+/* Send each sample as a separate datagram.
+ *
+ * Up to SOCKET_MAX_BATCH datagrams are passed to a single sendmmsg() call.
+ */
+static int socket_write_batch(NodeCompat *n, struct Sample *const smps[],
+                              unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+
+  socklen_t addrlen = socket_remote_addrlen(s);
+  auto stats = n->getStats();
+
+  // The sample of each datagram, to discard the keys of unsent datagrams
+  struct Sample *msgsmps[SOCKET_MAX_BATCH];
+
+  for (unsigned off = 0; off < cnt; off += s->out.batchlen) {
+    unsigned vlen = std::min(cnt - off, s->out.batchlen);
+    unsigned msgs = 0;
+
+    for (unsigned i = 0; i < vlen; i++) {
+      auto *hdr = &s->out.msgs[msgs].msg_hdr;
+      char *buf = s->out.buf + msgs * s->out.buflen;
+      size_t wbytes = 0;
+
+      ret = s->formatter->sprint(buf, s->out.buflen, &wbytes, &smps[off + i],
+                                 1);
+      if (ret < 0 || wbytes == 0 || wbytes > s->out.buflen) {
+        n->logger->warn("Failed to format payload: reason={}, wbytes={}", ret,
+                        wbytes);
+        continue;
+      }
+
+      s->out.iovs[msgs].iov_base = buf;
+      s->out.iovs[msgs].iov_len = wbytes;
+
+      memset(hdr, 0, sizeof(*hdr));
+      hdr->msg_name = &s->out.saddr;
+      hdr->msg_namelen = addrlen;
+      hdr->msg_iov = &s->out.iovs[msgs];
+      hdr->msg_iovlen = 1;
+
+      /* The datagram is recorded before it is sent, as its TX timestamp
+       * might be collected by the receiving thread right away. */
+      if (s->timestamping.tx)
+        socket_tx_record(s, s->timestamping.key + msgs, &smps[off + i], 1);
+
+      msgsmps[msgs++] = smps[off + i];
+    }
+
+    // sendmmsg() might send less datagrams than requested
+    unsigned sent = 0;
+    bool blocked = false;
+    while (sent < msgs) {
+      ret = sendmmsg(s->sd, &s->out.msgs[sent], msgs - sent, 0);
+      if (ret < 0) {
+        if (errno == EINTR)
+          continue;
+
+        // Wait until the socket buffer has space again
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          if (!blocked)
+            n->logger->warn("Blocking sendmmsg()");
+
+          blocked = true;
+
+          struct pollfd pfd = {.fd = s->sd, .events = POLLOUT};
+
+          ret = poll(&pfd, 1, -1);
+          if (ret < 0 && errno != EINTR)
+            throw SystemError("Failed to poll for socket buffer space");
+
+          continue;
+        }
+
+        n->logger->warn("Failed sendmmsg(): {}", strerror(errno));
+        break;
+      }
+
+      if (stats)
+        stats->update(Stats::Metric::SOCKET_BATCH_SENT, ret);
+
+      if ((unsigned)ret < msgs - sent)
+        n->logger->debug("Partial sendmmsg(): sent={}, expected={}", ret,
+                         msgs - sent);
+
+      sent += ret;
+    }
+
+    // The kernel only assigns timestamp keys to datagrams which are sent
+    if (s->timestamping.tx) {
+      s->timestamping.key += sent;
+
+      socket_tx_discard(s, &msgsmps[sent], msgs - sent);
+    }
+  }
+
+  if (s->timestamping.tx)
+    socket_tx_timestamps(n);
+
+  return cnt;
+}
+
+/* Send bursts of equally sized datagrams as UDP GSO super-buffers.
+ *
+ * The kernel splits each super-buffer into datagrams of the segment size.
+ * Only the last datagram of a super-buffer may be shorter.
+ */
+static int socket_write_gso(NodeCompat *n, struct Sample *const smps[],
+                            unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+
+  auto stats = n->getStats();
+  size_t maxlen = std::min<size_t>(s->out.buflen, SOCKET_GSO_MAX_LEN);
+
+  char ctrl[CMSG_SPACE(sizeof(uint16_t))];
+
+  for (unsigned off = 0; off < cnt;) {
+    size_t len = 0, segsz = 0;
+    unsigned segs = 0;
+
+    while (off < cnt && segs < SOCKET_GSO_MAX_SEGMENTS) {
+      size_t wbytes = 0;
+
+      ret = s->formatter->sprint(s->out.buf + len, maxlen - len, &wbytes,
+                                 &smps[off], 1);
+      if (ret < 0 || wbytes == 0 || wbytes > maxlen - len) {
+        // Flush the current super-buffer before giving up on the sample
+        if (segs > 0)
+          break;
+
+        n->logger->warn("Failed to format payload: reason={}, wbytes={}", ret,
+                        wbytes);
+        off++;
+        continue;
+      }
+
+      if (segs == 0)
+        segsz = wbytes;
+      else if (wbytes > segsz)
+        break; // Starts the next super-buffer
+
+      len += wbytes;
+      segs++;
+      off++;
+
+      if (wbytes < segsz)
+        break; // A shorter datagram must be the last segment
+    }
+
+    if (segs == 0)
+      continue;
+
+    struct iovec iov = {.iov_base = s->out.buf, .iov_len = len};
+    struct msghdr hdr = {};
+
+    hdr.msg_name = &s->out.saddr;
+    hdr.msg_namelen = socket_remote_addrlen(s);
+    hdr.msg_iov = &iov;
+    hdr.msg_iovlen = 1;
+
+    if (segs > 1) {
+      uint16_t gso_size = segsz;
+
+      hdr.msg_control = ctrl;
+      hdr.msg_controllen = sizeof(ctrl);
+
+      auto *cmsg = CMSG_FIRSTHDR(&hdr);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(gso_size));
+      memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+    }
+
+  retry:
+    ret = sendmsg(s->sd, &hdr, 0);
+    if (ret < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        n->logger->warn("Blocking sendmsg()");
+        goto retry;
+      }
+
+      n->logger->warn("Failed sendmsg(): {}", strerror(errno));
+      continue;
+    }
+
+    if (stats)
+      stats->update(Stats::Metric::SOCKET_BATCH_SENT, segs);
+  }
+
+  return cnt;
+}
+
+#ifdef WITH_SOCKET_LAYER_ETH
+// Offset of the payload within a frame of the TX ring.
+#define SOCKET_RING_TX_OFFSET TPACKET_ALIGN(sizeof(struct tpacket3_hdr))
+
+#define SOCKET_RING_TX_FRAMES                                                  \
+  (SOCKET_RING_TX_BLOCKS * SOCKET_RING_BLOCK_SIZE / SOCKET_RING_FRAME_SIZE)
+
+/* State of the packet_mmap backend.
+ *
+ * The RX ring is divided into blocks which the kernel fills with frames of
+ * variable size (TPACKET_V3). A block is handed over to us once it is full or
+ * its retire timeout has expired. The TX ring consists of fixed-size frames
+ * which are flushed to the kernel by a single sendto().
+ * Both rings are mapped into a single contiguous memory region.
+ */
+struct villas::node::SocketPacketRing {
+  char *map;
+  size_t maplen;
+
+  char *rx;                   // The first block of the RX ring.
+  unsigned rxblock;           // Index of the current RX block.
+  struct tpacket3_hdr *rxpkt; // Next frame in the current RX block.
+  unsigned rxleft;            // Number of frames left in the current RX block.
+
+  char *tx;         // The first frame of the TX ring.
+  unsigned txframe; // Index of the next TX frame.
+};
+
+static void socket_ring_start(NodeCompat *n) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *r = new struct SocketPacketRing();
+  if (!r)
+    throw MemoryAllocationError();
+
+  int version = TPACKET_V3;
+  ret = setsockopt(s->sd, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version));
+  if (ret)
+    throw SystemError("Failed to select TPACKET_V3");
+
+  struct tpacket_req3 req = {};
+
+  req.tp_block_size = SOCKET_RING_BLOCK_SIZE;
+  req.tp_frame_size = SOCKET_RING_FRAME_SIZE;
+  req.tp_block_nr = SOCKET_RING_RX_BLOCKS;
+  req.tp_frame_nr =
+      SOCKET_RING_RX_BLOCKS * SOCKET_RING_BLOCK_SIZE / SOCKET_RING_FRAME_SIZE;
+  req.tp_retire_blk_tov = SOCKET_RING_TIMEOUT;
+
+  ret = setsockopt(s->sd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+  if (ret)
+    throw SystemError("Failed to setup RX ring");
+
+  req.tp_block_nr = SOCKET_RING_TX_BLOCKS;
+  req.tp_frame_nr = SOCKET_RING_TX_FRAMES;
+  req.tp_retire_blk_tov = 0;
+
+  ret = setsockopt(s->sd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req));
+  if (ret)
+    throw SystemError("Failed to setup TX ring");
+
+  r->maplen = (SOCKET_RING_RX_BLOCKS + SOCKET_RING_TX_BLOCKS) *
+              SOCKET_RING_BLOCK_SIZE;
+  r->map = (char *)mmap(nullptr, r->maplen, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, s->sd, 0);
+  if (r->map == MAP_FAILED)
+    throw SystemError("Failed to map packet rings");
+
+  r->rx = r->map;
+  r->tx = r->map + SOCKET_RING_RX_BLOCKS * SOCKET_RING_BLOCK_SIZE;
+
+  s->ring = r;
+}
+
+static void socket_ring_stop(NodeCompat *n) {
+  auto *s = n->getData<struct Socket>();
+  auto *r = s->ring;
+
+  if (!r)
+    return;
+
+  munmap(r->map, r->maplen);
+
+  delete r;
+
+  s->ring = nullptr;
+}
+
+static int socket_read_ring(NodeCompat *n, struct Sample *const smps[],
+                            unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *r = s->ring;
+
+  unsigned nread = 0, frames = 0;
+
+  while (nread < cnt) {
+    char *block = r->rx + r->rxblock * SOCKET_RING_BLOCK_SIZE;
+    auto *bd = (struct tpacket_block_desc *)block;
+
+    uint32_t status =
+        __atomic_load_n(&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE);
+    if (!(status & TP_STATUS_USER)) {
+      // Only block if we have not received anything yet
+      if (nread > 0 || frames > 0)
+        break;
+
+      struct pollfd pfd = {.fd = s->sd, .events = POLLIN | POLLERR};
+
+      ret = poll(&pfd, 1, -1);
+      if (ret < 0) {
+        if (errno == EINTR)
+          return -1;
+
+        throw SystemError("Failed to poll for RX ring");
+      }
+
+      continue;
+    }
+
+    if (!r->rxpkt) {
+      r->rxpkt =
+          (struct tpacket3_hdr *)(block + bd->hdr.bh1.offset_to_first_pkt);
+      r->rxleft = bd->hdr.bh1.num_pkts;
+    }
+
+    while (r->rxleft > 0 && nread < cnt) {
+      auto *pkt = r->rxpkt;
+
+      if (pkt->tp_snaplen < pkt->tp_len)
+        n->logger->warn("Received truncated frame: bytes={}", pkt->tp_len);
+      else {
+        union sockaddr_union src;
+
+        // The link-layer address follows the frame header
+        memcpy(&src.sll,
+               (char *)pkt + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)),
+               sizeof(src.sll));
+
+        struct timespec ts = {.tv_sec = pkt->tp_sec, .tv_nsec = pkt->tp_nsec};
+
+        int decoded = socket_decode(
+            n, (char *)pkt + pkt->tp_mac, pkt->tp_snaplen, &src,
+            s->timestamping.rx ? &ts : nullptr, &smps[nread], cnt - nread);
+        if (decoded > 0)
+          nread += decoded;
+      }
+
+      r->rxpkt = (struct tpacket3_hdr *)((char *)pkt + pkt->tp_next_offset);
+      r->rxleft--;
+      frames++;
+    }
+
+    // Hand the block back to the kernel
+    if (r->rxleft == 0) {
+      __atomic_store_n(&bd->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                       __ATOMIC_RELEASE);
+
+      r->rxpkt = nullptr;
+      r->rxblock = (r->rxblock + 1) % SOCKET_RING_RX_BLOCKS;
+    }
+  }
+
+  auto stats = n->getStats();
+  if (stats && frames > 0)
+    stats->update(Stats::Metric::SOCKET_BATCH_RECV, frames);
+
+  return nread;
+}
+
+// Pass all frames of the TX ring which are ready to the kernel.
+static void socket_ring_flush(NodeCompat *n, unsigned frames, bool wait) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+
+retry:
+  ret = sendto(s->sd, nullptr, 0, wait ? 0 : MSG_DONTWAIT,
+               (struct sockaddr *)&s->out.saddr, socket_remote_addrlen(s));
+  if (ret < 0) {
+    if (errno == EINTR)
+      goto retry;
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK)
+      n->logger->warn("Failed sendto(): {}", strerror(errno));
+  }
+
+  auto stats = n->getStats();
+  if (stats && frames > 0)
+    stats->update(Stats::Metric::SOCKET_BATCH_SENT, frames);
+}
+
+static int socket_write_ring(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *r = s->ring;
+
+  unsigned per_frame = s->batch ? 1 : cnt;
+  unsigned queued = 0;
+
+  for (unsigned off = 0; off < cnt; off += per_frame) {
+    char *frame = r->tx + r->txframe * SOCKET_RING_FRAME_SIZE;
+    auto *hdr = (struct tpacket3_hdr *)frame;
+
+    // Only block if the ring is full
+    while (__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) !=
+           TP_STATUS_AVAILABLE) {
+      if (hdr->tp_status & TP_STATUS_WRONG_FORMAT) {
+        n->logger->warn("Kernel rejected frame of TX ring");
+
+        hdr->tp_status = TP_STATUS_AVAILABLE;
+        break;
+      }
+
+      socket_ring_flush(n, queued, true);
+      queued = 0;
+    }
+
+    char *buf = frame + SOCKET_RING_TX_OFFSET;
+    size_t buflen = SOCKET_RING_FRAME_SIZE - SOCKET_RING_TX_OFFSET;
+    size_t wbytes = 0;
+
+    ret = s->formatter->sprint(buf, buflen, &wbytes, &smps[off],
+                               std::min(per_frame, cnt - off));
+    if (ret < 0 || wbytes == 0 || wbytes > buflen) {
+      n->logger->warn("Failed to format payload: reason={}, wbytes={}", ret,
+                      wbytes);
+      continue;
+    }
+
+    hdr->tp_len = wbytes;
+    hdr->tp_next_offset = 0;
+
+    __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST,
+                     __ATOMIC_RELEASE);
+
+    r->txframe = (r->txframe + 1) % SOCKET_RING_TX_FRAMES;
+    queued++;
+  }
+
+  if (queued > 0)
+    socket_ring_flush(n, queued, false);
+
+  return cnt;
+}
+#endif // WITH_SOCKET_LAYER_ETH
+
+#ifdef WITH_LIBURING
+// The buffer group of the provided receive buffers.
+#define SOCKET_URING_BGID 0
+
+/* State of the io_uring backend.
+ *
+ * Receives are kept armed by a multishot recv which picks its buffers from a
+ * ring of provided buffers. Sends are submitted to a separate ring without
+ * waiting for their completion. Completed sends are collected lazily.
+ */
+struct villas::node::SocketUring {
+  struct io_uring rx;
+  struct io_uring tx;
+
+  struct io_uring_buf_ring *br; // Provided receive buffers.
+  char *rxbufs;
+
+  char *txbufs;
+  struct msghdr txmsgs[SOCKET_URING_ENTRIES];
+  struct iovec txiovs[SOCKET_URING_ENTRIES];
+  std::vector<unsigned> txfree; // Indices of unused send buffers.
+
+  int efd; // An eventfd(2) which is signaled for each receive completion.
+};
+
+// (Re-)arm the multishot receive request.
+static void socket_uring_arm(struct Socket *s) {
+  int ret;
+  auto *u = s->uring;
+
+  auto *sqe = io_uring_get_sqe(&u->rx);
+  if (!sqe)
+    throw RuntimeError("Failed to get io_uring submission queue entry");
+
+  io_uring_prep_recv_multishot(sqe, s->sd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = SOCKET_URING_BGID;
+
+  ret = io_uring_submit(&u->rx);
+  if (ret < 0)
+    throw RuntimeError("Failed to submit receive request: {}", strerror(-ret));
+}
+
+// Release the buffers of completed sends. Optionally wait for one.
+static void socket_uring_reap(NodeCompat *n, bool wait) {
+  int ret;
+  auto *u = n->getData<struct Socket>()->uring;
+
+  struct io_uring_cqe *cqe;
+
+  ret = wait ? io_uring_wait_cqe(&u->tx, &cqe)
+             : io_uring_peek_cqe(&u->tx, &cqe);
+  while (ret == 0) {
+    if (cqe->res < 0)
+      n->logger->warn("Failed to send datagram: {}", strerror(-cqe->res));
+
+    u->txfree.push_back(io_uring_cqe_get_data64(cqe));
+    io_uring_cqe_seen(&u->tx, cqe);
+
+    ret = io_uring_peek_cqe(&u->tx, &cqe);
+  }
+}
+
+static void socket_uring_start(NodeCompat *n) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *u = new struct SocketUring();
+  if (!u)
+    throw MemoryAllocationError();
+
+  ret = io_uring_queue_init(SOCKET_URING_ENTRIES, &u->rx, 0);
+  if (ret)
+    throw RuntimeError("Failed to setup io_uring: {}", strerror(-ret));
+
+  ret = io_uring_queue_init(SOCKET_URING_ENTRIES, &u->tx, 0);
+  if (ret)
+    throw RuntimeError("Failed to setup io_uring: {}", strerror(-ret));
+
+  u->br = io_uring_setup_buf_ring(&u->rx, SOCKET_URING_ENTRIES,
+                                  SOCKET_URING_BGID, 0, &ret);
+  if (!u->br)
+    throw RuntimeError("Failed to register receive buffers: {}",
+                       strerror(-ret));
+
+  u->rxbufs = new char[SOCKET_URING_ENTRIES * SOCKET_BATCH_BUFFER_LEN];
+  u->txbufs = new char[SOCKET_URING_ENTRIES * SOCKET_BATCH_BUFFER_LEN];
+  if (!u->rxbufs || !u->txbufs)
+    throw MemoryAllocationError();
+
+  int mask = io_uring_buf_ring_mask(SOCKET_URING_ENTRIES);
+  for (unsigned i = 0; i < SOCKET_URING_ENTRIES; i++) {
+    io_uring_buf_ring_add(u->br, u->rxbufs + i * SOCKET_BATCH_BUFFER_LEN,
+                          SOCKET_BATCH_BUFFER_LEN, i, mask, i);
+    u->txfree.push_back(i);
+  }
+
+  io_uring_buf_ring_advance(u->br, SOCKET_URING_ENTRIES);
+
+  // The eventfd makes receive completions pollable by the path
+  u->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (u->efd < 0)
+    throw SystemError("Failed to create eventfd");
+
+  ret = io_uring_register_eventfd(&u->rx, u->efd);
+  if (ret)
+    throw RuntimeError("Failed to register eventfd: {}", strerror(-ret));
+
+  s->uring = u;
+
+  socket_uring_arm(s);
+}
+
+static void socket_uring_stop(NodeCompat *n) {
+  auto *s = n->getData<struct Socket>();
+  auto *u = s->uring;
+
+  if (!u)
+    return;
+
+  // Wait until all pending sends have been completed
+  while (u->txfree.size() < SOCKET_URING_ENTRIES)
+    socket_uring_reap(n, true);
+
+  io_uring_free_buf_ring(&u->rx, u->br, SOCKET_URING_ENTRIES,
+                         SOCKET_URING_BGID);
+
+  io_uring_queue_exit(&u->rx);
+  io_uring_queue_exit(&u->tx);
+
+  close(u->efd);
+
+  delete[] u->rxbufs;
+  delete[] u->txbufs;
+  delete u;
+
+  s->uring = nullptr;
+}
+
+static int socket_read_uring(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *u = s->uring;
+
+  struct io_uring_cqe *cqe;
+  unsigned nread = 0;
+  uint64_t evts;
+
+  // Reset the eventfd before draining the completion queue
+  ret = read(u->efd, &evts, sizeof(evts));
+  if (ret < 0 && errno != EAGAIN)
+    throw SystemError("Failed to read from eventfd");
+
+  // Block if we have not been woken up by the poll of the path
+  ret = io_uring_peek_cqe(&u->rx, &cqe);
+  if (ret == -EAGAIN)
+    ret = io_uring_wait_cqe(&u->rx, &cqe);
+
+  if (ret == -EINTR)
+    return -1;
+  else if (ret < 0)
+    throw RuntimeError("Failed to wait for completion: {}", strerror(-ret));
+
+  while (ret == 0 && nread < cnt) {
+    bool rearm = !(cqe->flags & IORING_CQE_F_MORE);
+
+    if (cqe->res < 0) {
+      // All buffers are in use. The request is re-armed below.
+      if (cqe->res != -ENOBUFS)
+        n->logger->warn("Failed to receive datagram: {}",
+                        strerror(-cqe->res));
+    } else if (cqe->flags & IORING_CQE_F_BUFFER) {
+      unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+      char *buf = u->rxbufs + bid * SOCKET_BATCH_BUFFER_LEN;
+
+      // Multishot receives do not provide the source address
+      union sockaddr_union src = s->out.saddr;
+
+      if (cqe->res > 0) {
+        int decoded = socket_decode(n, buf, cqe->res, &src, nullptr,
+                                    &smps[nread], cnt - nread);
+        if (decoded > 0)
+          nread += decoded;
+      }
+
+      // Hand the buffer back to the kernel
+      io_uring_buf_ring_add(u->br, buf, SOCKET_BATCH_BUFFER_LEN, bid,
+                            io_uring_buf_ring_mask(SOCKET_URING_ENTRIES), 0);
+      io_uring_buf_ring_advance(u->br, 1);
+    }
+
+    io_uring_cqe_seen(&u->rx, cqe);
+
+    if (rearm)
+      socket_uring_arm(s);
+
+    ret = io_uring_peek_cqe(&u->rx, &cqe);
+  }
+
+  // Keep the eventfd readable as long as there are pending completions
+  if (io_uring_cq_ready(&u->rx) > 0) {
+    uint64_t incr = 1;
+
+    ret = write(u->efd, &incr, sizeof(incr));
+    if (ret < 0)
+      throw SystemError("Failed to signal eventfd");
+  }
+
+  return nread;
+}
+
+static int socket_write_uring(NodeCompat *n, struct Sample *const smps[],
+                              unsigned cnt) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+  auto *u = s->uring;
+
+  socklen_t addrlen = socket_remote_addrlen(s);
+  unsigned per_datagram = s->batch ? 1 : cnt;
+  unsigned queued = 0;
+
+  socket_uring_reap(n, false);
+
+  for (unsigned off = 0; off < cnt; off += per_datagram) {
+    // Only block if all send buffers are still in flight
+    while (u->txfree.empty()) {
+      io_uring_submit(&u->tx);
+      socket_uring_reap(n, true);
+    }
+
+    unsigned slot = u->txfree.back();
+    char *buf = u->txbufs + slot * SOCKET_BATCH_BUFFER_LEN;
+    size_t wbytes = 0;
+
+    ret = s->formatter->sprint(buf, SOCKET_BATCH_BUFFER_LEN, &wbytes,
+                               &smps[off], std::min(per_datagram, cnt - off));
+    if (ret < 0 || wbytes == 0 || wbytes > SOCKET_BATCH_BUFFER_LEN) {
+      n->logger->warn("Failed to format payload: reason={}, wbytes={}", ret,
+                      wbytes);
+      continue;
+    }
+
+    auto *sqe = io_uring_get_sqe(&u->tx);
+    if (!sqe)
+      throw RuntimeError("Failed to get io_uring submission queue entry");
+
+    u->txfree.pop_back();
+
+    u->txiovs[slot].iov_base = buf;
+    u->txiovs[slot].iov_len = wbytes;
+
+    memset(&u->txmsgs[slot], 0, sizeof(u->txmsgs[slot]));
+    u->txmsgs[slot].msg_name = &s->out.saddr;
+    u->txmsgs[slot].msg_namelen = addrlen;
+    u->txmsgs[slot].msg_iov = &u->txiovs[slot];
+    u->txmsgs[slot].msg_iovlen = 1;
+
+    io_uring_prep_sendmsg(sqe, s->sd, &u->txmsgs[slot], 0);
+    io_uring_sqe_set_data64(sqe, slot);
+
+    queued++;
+  }
+
+  if (queued > 0) {
+    ret = io_uring_submit(&u->tx);
+    if (ret < 0)
+      n->logger->warn("Failed to submit send requests: {}", strerror(-ret));
+  }
+
+  return cnt;
+}
+#endif // WITH_LIBURING
+
+int villas::node::socket_write(NodeCompat *n, struct Sample *const smps[],
+                               unsigned cnt) {
+  auto *s = n->getData<struct Socket>();
+
+  int ret;
+  ssize_t bytes;
+  size_t wbytes;
+
+#ifdef WITH_LIBURING
+  if (s->uring)
+    return socket_write_uring(n, smps, cnt);
+#endif // WITH_LIBURING
+
+#ifdef WITH_SOCKET_LAYER_ETH
+  if (s->ring)
+    return socket_write_ring(n, smps, cnt);
+#endif // WITH_SOCKET_LAYER_ETH
+
+  if (s->gso)
+    return socket_write_gso(n, smps, cnt);
+
+  if (s->batch)
+    return socket_write_batch(n, smps, cnt);
+
+retry:
+  ret = s->formatter->sprint(s->out.buf, s->out.buflen, &wbytes, smps, cnt);
+  if (ret < 0) {
+    n->logger->warn("Failed to format payload: reason={}", ret);
+    return ret;
+  }
+
+  if (wbytes == 0) {
+    n->logger->warn("Failed to format payload: wbytes={}", wbytes);
+    return -1;
+  }
+
+  if (wbytes > s->out.buflen) {
+    s->out.buflen = wbytes;
+
+    delete[] s->out.buf;
+    s->out.buf = new char[s->out.buflen];
+    if (!s->out.buf)
+      throw MemoryAllocationError();
+
+    goto retry;
+  }
+
+  // Send message
+  socklen_t addrlen = socket_remote_addrlen(s);
+
+  /* The datagram is recorded before it is sent, as its TX timestamp might
+   * be collected by the receiving thread right away. */
+  if (s->timestamping.tx)
+    socket_tx_record(s, s->timestamping.key, smps, cnt);
+
+retry2:
+  if (s->layer == SocketLayer::TCP_CLIENT) {
+    // Send data to TCP server.
+    bytes = send(s->sd, s->out.buf, wbytes, 0);
+  } else if (s->layer == SocketLayer::TCP_SERVER) {
+    // Send data to TCP client.
+    bytes = send(s->clt_sd, s->out.buf, wbytes, 0);
+  } else {
+    bytes = sendto(s->sd, s->out.buf, wbytes, 0,
+                   (struct sockaddr *)&s->out.saddr, addrlen);
+  }
+
+  if (bytes < 0) {
+    if ((errno == EPERM) || (errno == ENOENT && s->layer == SocketLayer::UNIX))
+      n->logger->warn("Failed sendto(): {}", strerror(errno));
+    else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      n->logger->warn("Blocking sendto()");
+      goto retry2;
+    } else
+      n->logger->warn("Failed sendto(): {}", strerror(errno));
+
+    // The kernel did not assign the key to a datagram
+    if (s->timestamping.tx)
+      socket_tx_discard(s, smps, cnt);
+  } else {
+    if ((size_t)bytes < wbytes)
+      n->logger->warn("Partial sendto()");
+
+    if (s->timestamping.tx) {
+      s->timestamping.key++;
+      socket_tx_timestamps(n);
+    }
+  }
+
+  return cnt;
+}
+
+int villas::node::socket_parse(NodeCompat *n, json_t *json) {
+  int ret;
+  auto *s = n->getData<struct Socket>();
+
+  const char *local, *remote;
+  const char *layer = nullptr;
+
+  json_error_t err;
+  json_t *json_multicast = nullptr;
+  json_t *json_format = nullptr;
+  json_t *json_timestamping = nullptr;
+
+  // Default values
+  s->layer = SocketLayer::UDP;
+  s->verify_source = 0;
+  s->batch = 0;
+  s->gso = 0;
+  s->gro = 0;
+  s->timestamping.rx = 0;
+  s->timestamping.tx = 0;
+  s->backend = SocketBackend::DEFAULT;
+
+  const char *backend = nullptr;
+
+  ret = json_unpack_ex(
+      json, &err, 0,
+      "{ s?: s, s?: o, s?: b, s?: s, s?: o, s: { s: s, s?: b }, s: { s: s, "
+      "s?: b, s?: o, s?: b } }",
+      "layer", &layer, "format", &json_format, "batch", &s->batch,
+      "io_backend", &backend, "timestamping", &json_timestamping, "out",
+      "address", &remote, "gso", &s->gso, "in", "address", &local,
+      "verify_source", &s->verify_source, "multicast", &json_multicast, "gro",
+      &s->gro);
+  if (ret)
+    throw ConfigError(json, err, "node-config-node-socket");
+
+  if (json_timestamping) {
+    ret = json_unpack_ex(json_timestamping, &err, 0, "{ s?: b, s?: b }", "rx",
+                         &s->timestamping.rx, "tx", &s->timestamping.tx);
+    if (ret)
+      throw ConfigError(json_timestamping, err,
+                        "node-config-node-socket-timestamping",
+                        "Failed to parse timestamping settings");
+  }
+
+  // Format
+  if (s->formatter)
+    delete s->formatter;
+  s->formatter = json_format ? FormatFactory::make(json_format)
                              : FormatFactory::make("villas.binary");
   if (!s->formatter)
     throw ConfigError(json_format, "node-config-node-socket-format",
                       "Invalid format configuration");
 
+  // I/O backend
+  if (backend) {
+    if (!strcmp(backend, "io_uring"))
+#ifdef WITH_LIBURING
+      s->backend = SocketBackend::IO_URING;
+#else
+      throw ConfigError(json, "node-config-node-socket-io-backend",
+                        "VILLASnode has been built without io_uring support");
+#endif // WITH_LIBURING
+#ifdef WITH_SOCKET_LAYER_ETH
+    else if (!strcmp(backend, "packet_mmap"))
+      s->backend = SocketBackend::PACKET_MMAP;
+#endif // WITH_SOCKET_LAYER_ETH
+    else if (strcmp(backend, "default"))
+      throw ConfigError(json, "node-config-node-socket-io-backend",
+                        "Invalid I/O backend '{}'", backend);
+  }
+
   // IP layer
   if (layer) {
     if (!strcmp(layer, "ip"))
@@ -669,6 +1913,51 @@ int villas::node::socket_parse(NodeCompat *n, json_t *json) {
 int villas::node::socket_fds(NodeCompat *n, int fds[]) {
   auto *s = n->getData<struct Socket>();
 
+#ifdef WITH_LIBURING
+  // Completions of the io_uring backend are signaled by an eventfd
+  if (s->uring) {
+    fds[0] = s->uring->efd;
+
+    return 1;
+  }
+#endif // WITH_LIBURING
+
+  fds[0] = s->sd;
+
+  return 1;
+}
+
+/* Get the kernel TX timestamp of the datagram in which we have sent the
+ * sample with the given sequence number. */
+int villas::node::socket_tx_timestamp(NodeCompat *n, uint64_t sequence,
+                                      struct timespec *ts) {
+  int ret = -1;
+  auto *s = n->getData<struct Socket>();
+
+  if (!s->timestamping.tx || !s->timestamping.samples)
+    return -1;
+
+  socket_tx_timestamps(n);
+
+  pthread_mutex_lock(&s->timestamping.mutex);
+
+  auto &e = s->timestamping.samples[sequence % SOCKET_TIMESTAMP_HISTORY];
+  auto &d = s->timestamping.datagrams[e.key % SOCKET_TIMESTAMP_HISTORY];
+
+  if (e.sequence == sequence && d.key == e.key &&
+      (d.ts.tv_sec != 0 || d.ts.tv_nsec != 0)) {
+    *ts = d.ts;
+    ret = 0;
+  }
+
+  pthread_mutex_unlock(&s->timestamping.mutex);
+
+  return ret;
+}
+
+int villas::node::socket_netem_fds(NodeCompat *n, int fds[]) {
+  auto *s = n->getData<struct Socket>();
+
   fds[0] = s->sd;
 
   return 1;
@@ -696,5 +1985,6 @@ __attribute__((constructor(110))) static void register_plugin() {
   p.read = socket_read;
   p.write = socket_write;
   p.poll_fds = socket_fds;
-  p.netem_fds = socket_fds;
+  p.netem_fds = socket_netem_fds;
+  p.tx_timestamp = socket_tx_timestamp;
 }
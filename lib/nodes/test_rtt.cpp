@@ -66,6 +66,10 @@ int TestRTT::Case::stop() {
                      id + 1, node->cases.size(), count, sent, received, missed,
                      time_delta(&started, &stopped));
 
+  if (missing_tx > 0)
+    node->logger->warn("Received {} samples without a TX timestamp of node {}",
+                       missing_tx, node->tx_timestamps);
+
   return 0;
 }
 
@@ -112,6 +116,12 @@ int TestRTT::prepare() {
 
   in.signals = std::make_shared<SignalList>(max_values, SignalType::FLOAT);
 
+  if (!tx_timestamps.empty()) {
+    tx_sample = sample_alloc_mem(max_values);
+    if (!tx_sample)
+      throw MemoryAllocationError();
+  }
+
   return Node::prepare();
 }
 
@@ -138,6 +148,7 @@ int TestRTT::parse(json_t *json) {
   const char *output_str = ".";
   const char *prefix_str = nullptr;
   const char *mode_str = nullptr;
+  const char *tx_str = nullptr;
 
   enum Mode mode_default = Mode::AT_LEAST_COUNT;
   int count_default = 1000;
@@ -153,19 +164,23 @@ int TestRTT::parse(json_t *json) {
 
   ret = json_unpack_ex(json, &err, 0,
                        "{ s?: s, s?: s, s?: o, s?: F, s?: F, s?: o, s?: o, s: "
-                       "o, s?: b, s?: s, s?: i, s?: F }",
+                       "o, s?: b, s?: s, s?: i, s?: F, s?: s }",
                        "prefix", &prefix_str, "output", &output_str, "format",
                        &json_format, "cooldown", &cooldown_default, "warmup",
                        &warmup_default, "values", &json_values_default, "rates",
                        &json_rates_default, "cases", &json_cases, "shutdown",
                        &shutdown_, "mode", &mode_str, "count", &count_default,
-                       "duration", &duration_default);
+                       "duration", &duration_default, "tx_timestamps",
+                       &tx_str);
   if (ret)
     throw ConfigError(json, err, "node-config-node-test-rtt");
 
   output = output_str;
   prefix = prefix_str ? prefix_str : getNameShort();
 
+  if (tx_str)
+    tx_timestamps = tx_str;
+
   if (shutdown_ > 0)
     shutdown = shutdown_ > 0;
 
@@ -348,6 +363,13 @@ int TestRTT::start() {
 
   formatter->start(getInputSignals(false), ~(int)SampleFlags::HAS_DATA);
 
+  if (!tx_timestamps.empty()) {
+    tx_node = sn ? sn->getNode(tx_timestamps) : nullptr;
+    if (!tx_node)
+      throw RuntimeError("Failed to find node {} for TX timestamps",
+                         tx_timestamps);
+  }
+
   current = cases.begin();
 
   task.setRate(current->rate);
@@ -359,6 +381,11 @@ int TestRTT::start() {
   return 0;
 }
 
+TestRTT::~TestRTT() {
+  if (tx_sample)
+    sample_free(tx_sample);
+}
+
 int TestRTT::stop() {
   int ret;
 
@@ -472,7 +499,18 @@ int TestRTT::_write(struct Sample *smps[], unsigned cnt) {
       continue;
     }
 
-    formatter->print(stream, smps[i]);
+    /* Measure from the time at which the kernel has sent the sample,
+     * instead of the time at which we have generated it. */
+    struct timespec ts_tx;
+    if (tx_node && tx_node->getTxTimestamp(smp->sequence, &ts_tx) == 0) {
+      sample_copy(tx_sample, smp);
+
+      tx_sample->ts.origin = ts_tx;
+      smp = tx_sample;
+    } else if (tx_node)
+      current->missing_tx++;
+
+    formatter->print(stream, smp);
     current->received++;
   }
 
@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <atomic>
 #include <cstring>
 
 #include <zmq.h>
@@ -14,8 +15,11 @@
 #endif
 
 #include <villas/exceptions.hpp>
+#include <villas/node/config.hpp>
+#include <villas/node/memory.hpp>
 #include <villas/node_compat.hpp>
 #include <villas/nodes/zeromq.hpp>
+#include <villas/pool.hpp>
 #include <villas/queue.h>
 #include <villas/super_node.hpp>
 #include <villas/utils.hpp>
@@ -90,6 +94,14 @@ int villas::node::zeromq_init(NodeCompat *n) {
   z->in.pending = 0;
   z->out.pending = 0;
 
+  z->in.hwm = -1;
+  z->out.hwm = -1;
+
+  z->multipart = 0;
+  z->buffers = 1024;
+  z->buffer_size = DEFAULT_FORMAT_BUFFER_LENGTH;
+  z->pool = nullptr;
+
   ret = list_init(&z->in.endpoints);
   if (ret)
     return ret;
@@ -146,17 +158,31 @@ int villas::node::zeromq_parse(NodeCompat *n, json_t *json) {
   json_t *json_curve = nullptr;
   json_t *json_format = nullptr;
 
-  ret = json_unpack_ex(json, &err, 0,
-                       "{ s?: { s?: o, s?: s, s?: b }, s?: { s?: o, s?: s, s?: "
-                       "b }, s?: o, s?: s, s?: b, s?: o }",
-                       "in", "subscribe", &json_in_ep, "filter", &in_filter,
-                       "bind", &z->in.bind, "out", "publish", &json_out_ep,
-                       "filter", &out_filter, "bind", &z->out.bind, "curve",
-                       &json_curve, "pattern", &type, "ipv6", &z->ipv6,
-                       "format", &json_format);
+  int buffers = -1, buffer_size = -1;
+
+  ret = json_unpack_ex(
+      json, &err, 0,
+      "{ s?: { s?: o, s?: s, s?: b, s?: i }, s?: { s?: o, s?: s, s?: b, s?: i, "
+      "s?: b, s?: i, s?: i }, s?: o, s?: s, s?: b, s?: o }",
+      "in", "subscribe", &json_in_ep, "filter", &in_filter, "bind",
+      &z->in.bind, "hwm", &z->in.hwm, "out", "publish", &json_out_ep, "filter",
+      &out_filter, "bind", &z->out.bind, "hwm", &z->out.hwm, "multipart",
+      &z->multipart, "buffers", &buffers, "buffer_size", &buffer_size, "curve",
+      &json_curve, "pattern", &type, "ipv6", &z->ipv6, "format", &json_format);
   if (ret)
     throw ConfigError(json, err, "node-config-node-zeromq");
 
+  if (buffers == 0 || buffers < -1 || buffer_size == 0 || buffer_size < -1)
+    throw ConfigError(json, "node-config-node-zeromq",
+                      "Settings 'out.buffers' and 'out.buffer_size' must be "
+                      "positive");
+
+  if (buffers > 0)
+    z->buffers = buffers;
+
+  if (buffer_size > 0)
+    z->buffer_size = buffer_size;
+
   z->in.filter = in_filter ? strdup(in_filter) : nullptr;
   z->out.filter = out_filter ? strdup(out_filter) : nullptr;
 
@@ -226,6 +252,13 @@ int villas::node::zeromq_parse(NodeCompat *n, json_t *json) {
                         "Invalid type for ZeroMQ node: {}", n->getNameShort());
   }
 
+#ifdef ZMQ_BUILD_DISH
+  if (z->multipart && z->pattern == zeromq::Pattern::RADIODISH)
+    throw ConfigError(json, "node-config-node-zeromq-multipart",
+                      "The radiodish pattern does not support multipart "
+                      "messages");
+#endif
+
   return 0;
 }
 
@@ -275,6 +308,15 @@ char *villas::node::zeromq_print(NodeCompat *n) {
   if (z->out.filter)
     strcatf(&buf, ", out.filter=%s", z->out.filter);
 
+  if (z->in.hwm >= 0)
+    strcatf(&buf, ", in.hwm=%d", z->in.hwm);
+
+  if (z->out.hwm >= 0)
+    strcatf(&buf, ", out.hwm=%d", z->out.hwm);
+
+  strcatf(&buf, ", out.multipart=%s, out.buffers=%u",
+          z->multipart ? "yes" : "no", z->buffers);
+
   return buf;
 }
 
@@ -287,6 +329,25 @@ int villas::node::zeromq_check(NodeCompat *n) {
   return 0;
 }
 
+/* Send buffers of a node.
+ *
+ * The node and each buffer which is held by ZeroMQ own a reference.
+ * The pool is freed once the last of them has been released. */
+struct villas::node::ZeroMQPool {
+  struct Pool pool;
+  std::atomic<unsigned> refcnt;
+};
+
+static void zeromq_pool_decref(struct ZeroMQPool *zp) {
+  if (zp->refcnt.fetch_sub(1) > 1)
+    return;
+
+  int ret __attribute__((unused));
+  ret = pool_destroy(&zp->pool);
+
+  delete zp;
+}
+
 int villas::node::zeromq_type_start(villas::node::SuperNode *sn) {
   context = zmq_ctx_new();
 
@@ -303,6 +364,20 @@ int villas::node::zeromq_start(NodeCompat *n) {
 
   z->formatter->start(n->getInputSignals(false), ~(int)SampleFlags::HAS_OFFSET);
 
+  z->pool = new struct ZeroMQPool;
+  if (!z->pool)
+    throw MemoryAllocationError();
+
+  z->pool->refcnt = 1;
+
+  ret = pool_init(&z->pool->pool, z->buffers, z->buffer_size, &memory::heap);
+  if (ret) {
+    delete z->pool;
+    z->pool = nullptr;
+
+    return ret;
+  }
+
   switch (z->pattern) {
 #ifdef ZMQ_BUILD_DISH
   case zeromq::Pattern::RADIODISH:
@@ -396,6 +471,14 @@ int villas::node::zeromq_start(NodeCompat *n) {
     if (ret)
       goto fail;
 
+    if (d->hwm >= 0) {
+      int opt = d == &z->in ? ZMQ_RCVHWM : ZMQ_SNDHWM;
+
+      ret = zmq_setsockopt(d->socket, opt, &d->hwm, sizeof(d->hwm));
+      if (ret)
+        goto fail;
+    }
+
     // Monitor events on the server
     ret = zmq_socket_monitor(d->socket, mon_ep, ZMQ_EVENT_ALL);
     if (ret < 0)
@@ -456,6 +539,10 @@ int villas::node::zeromq_start(NodeCompat *n) {
 fail:
   n->logger->info("Failed to start: {}", zmq_strerror(errno));
 
+  // No buffers have been handed out yet
+  zeromq_pool_decref(z->pool);
+  z->pool = nullptr;
+
   return ret;
 }
 
@@ -475,6 +562,14 @@ int villas::node::zeromq_stop(NodeCompat *n) {
       return ret;
   }
 
+  /* ZeroMQ releases the buffers of messages which are still queued
+   * asynchronously after the sockets have been closed. The last one of
+   * them frees the pool. */
+  if (z->pool)
+    zeromq_pool_decref(z->pool);
+
+  z->pool = nullptr;
+
   return 0;
 }
 
@@ -500,7 +595,8 @@ int villas::node::zeromq_destroy(NodeCompat *n) {
 
 int villas::node::zeromq_read(NodeCompat *n, struct Sample *const smps[],
                               unsigned cnt) {
-  int recv, ret;
+  int ret;
+  unsigned recv = 0;
   auto *z = n->getData<struct zeromq>();
 
   zmq_msg_t m;
@@ -521,13 +617,25 @@ int villas::node::zeromq_read(NodeCompat *n, struct Sample *const smps[],
     }
   }
 
-  // Receive payload
-  ret = zmq_msg_recv(&m, z->in.socket, 0);
-  if (ret < 0)
-    return ret;
+  // Receive all frames of the message and decode them in place
+  do {
+    ret = zmq_msg_recv(&m, z->in.socket, 0);
+    if (ret < 0) {
+      zmq_msg_close(&m);
+      return ret;
+    }
 
-  recv = z->formatter->sscan((const char *)zmq_msg_data(&m), zmq_msg_size(&m),
-                             nullptr, smps, cnt);
+    if (recv < cnt) {
+      ret = z->formatter->sscan((const char *)zmq_msg_data(&m),
+                                zmq_msg_size(&m), nullptr, smps + recv,
+                                cnt - recv);
+      if (ret < 0)
+        n->logger->warn("Received an invalid frame");
+      else
+        recv += ret;
+    } else
+      n->logger->debug("Skipping frame which exceeds the vectorization");
+  } while (zmq_msg_more(&m));
 
   ret = zmq_msg_close(&m);
   if (ret)
@@ -536,55 +644,97 @@ int villas::node::zeromq_read(NodeCompat *n, struct Sample *const smps[],
   return recv;
 }
 
-int villas::node::zeromq_write(NodeCompat *n, struct Sample *const smps[],
-                               unsigned cnt) {
+static void zeromq_free_buffer(void *data, void *hint) {
+  auto *zp = (struct ZeroMQPool *)hint;
+
+  if (zp) {
+    pool_put(&zp->pool, data);
+    zeromq_pool_decref(zp);
+  } else
+    delete[] (char *)data;
+}
+
+// Encodes samples into a send buffer and sends them as a single frame.
+static int zeromq_send_frame(NodeCompat *n, struct Sample *const smps[],
+                             unsigned cnt, int flags) {
   int ret;
   auto *z = n->getData<struct zeromq>();
 
   size_t wbytes;
   zmq_msg_t m;
 
-  char data[DEFAULT_FORMAT_BUFFER_LENGTH];
+  // All buffers might still be referenced by queued messages
+  struct ZeroMQPool *p = z->pool;
+  auto *buf = (char *)pool_get(&p->pool);
+  if (buf)
+    p->refcnt++;
+  else {
+    p = nullptr;
+    buf = new char[z->buffer_size];
+    if (!buf)
+      throw MemoryAllocationError();
+  }
 
-  ret = z->formatter->sprint(data, sizeof(data), &wbytes, smps, cnt);
-  if (ret <= 0)
+  ret = z->formatter->sprint(buf, z->buffer_size, &wbytes, smps, cnt);
+  if (ret < (int)cnt || wbytes > z->buffer_size) {
+    n->logger->warn("Encoded samples exceed the size of a send buffer");
+    zeromq_free_buffer(buf, p);
     return -1;
+  }
 
-  ret = zmq_msg_init_size(&m, wbytes);
+  ret = zmq_msg_init_data(&m, buf, wbytes, zeromq_free_buffer, p);
+  if (ret) {
+    zeromq_free_buffer(buf, p);
+    return ret;
+  }
 
-  if (z->out.filter) {
-    switch (z->pattern) {
 #ifdef ZMQ_BUILD_DISH
-    case zeromq::Pattern::RADIODISH:
-      ret = zmq_msg_set_group(&m, z->out.filter);
-      if (ret < 0)
-        goto fail;
-      break;
+  if (z->out.filter && z->pattern == zeromq::Pattern::RADIODISH) {
+    ret = zmq_msg_set_group(&m, z->out.filter);
+    if (ret < 0)
+      goto out;
+  }
 #endif
 
-    case zeromq::Pattern::PUBSUB: // Send envelope
-      zmq_send(z->out.socket, z->out.filter, strlen(z->out.filter),
-               ZMQ_SNDMORE);
-      break;
-    }
-  }
+  // The buffer is released by ZeroMQ once the message has been sent
+  ret = zmq_msg_send(&m, z->out.socket, flags);
 
-  memcpy(zmq_msg_data(&m), data, wbytes);
+#ifdef ZMQ_BUILD_DISH
+out:
+#endif
+  zmq_msg_close(&m);
 
-  ret = zmq_msg_send(&m, z->out.socket, 0);
-  if (ret < 0)
-    goto fail;
+  return ret < 0 ? ret : (int)cnt;
+}
 
-  ret = zmq_msg_close(&m);
-  if (ret < 0)
-    return ret;
+int villas::node::zeromq_write(NodeCompat *n, struct Sample *const smps[],
+                               unsigned cnt) {
+  int ret;
+  auto *z = n->getData<struct zeromq>();
 
-  return cnt;
+  if (z->out.filter && z->pattern == zeromq::Pattern::PUBSUB) {
+    // Send envelope
+    zmq_send(z->out.socket, z->out.filter, strlen(z->out.filter),
+             ZMQ_SNDMORE);
+  }
 
-fail:
-  zmq_msg_close(&m);
+  // With multipart, each sample is sent in its own frame of a single message
+  unsigned frames = z->multipart ? cnt : 1;
+  unsigned per_frame = z->multipart ? 1 : cnt;
 
-  return ret;
+  for (unsigned i = 0; i < frames; i++) {
+    ret = zeromq_send_frame(n, &smps[i * per_frame], per_frame,
+                            i < frames - 1 ? ZMQ_SNDMORE : 0);
+    if (ret < 0) {
+      // Terminate the message which has already been started
+      if (i > 0 || (z->out.filter && z->pattern == zeromq::Pattern::PUBSUB))
+        zmq_send(z->out.socket, nullptr, 0, 0);
+
+      return i > 0 ? (int)(i * per_frame) : ret;
+    }
+  }
+
+  return cnt;
 }
 
 int villas::node::zeromq_poll_fds(NodeCompat *n, int fds[]) {
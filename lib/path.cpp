@@ -10,7 +10,11 @@
 #include <cstring>
 #include <unordered_map>
 
+#include <linux/capability.h>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include <villas/colors.hpp>
@@ -22,6 +26,7 @@
 #include <villas/node/memory.hpp>
 #include <villas/path.hpp>
 #include <villas/path_destination.hpp>
+#include <villas/path_scheduler.hpp>
 #include <villas/path_source.hpp>
 #include <villas/pool.hpp>
 #include <villas/queue.h>
@@ -58,8 +63,7 @@ void *Path::runSingle() {
     if (ret <= 0)
       continue;
 
-    for (auto pd : destinations)
-      pd->write();
+    writeDestinations();
   }
 
   return nullptr;
@@ -68,50 +72,147 @@ void *Path::runSingle() {
 /* Main thread function per path:
  *     read samples from source -> write samples to destinations
  *
- * This variant of the path uses poll() to listen on an event from
- * all path sources.
+ * This variant of the path uses epoll(7) to listen on an event from
+ * all path sources. Only ready sources are returned by the kernel.
+ * All of them are drained before the destinations are written once.
  */
 void *Path::runPoll() {
+  std::vector<struct epoll_event> evs(pfds.size());
+
   while (state == State::STARTED) {
-    int ret = ::poll(pfds.data(), pfds.size(), -1);
-    if (ret < 0)
+    int ret = busy_poll > 0 ? waitBusy(evs.data(), evs.size())
+                            : epoll_wait(epfd, evs.data(), evs.size(), -1);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+
       throw SystemError("Failed to poll");
+    }
 
-    logger->debug("Returned from poll(2): ret={}", ret);
+    logger->debug("Returned from epoll_wait(2): ret={}", ret);
 
-    for (unsigned i = 0; i < pfds.size(); i++) {
-      auto &pfd = pfds[i];
+    /* Expirations of the timeout timer are coalesced and handled after the
+     * sources. This avoids sending a stale sample if a source became ready
+     * during the same wake-up. */
+    int timer = -1;
+    for (int i = 0; i < ret; i++) {
+      unsigned slot = evs[i].data.u32;
 
-      if (pfd.revents & POLLIN) {
-        // Timeout: re-enqueue the last sample
-        if (pfd.fd == timeout.getFD()) {
-          timeout.wait();
+      if (pfdSources[slot] < 0)
+        timer = slot;
+      else
+        processEvent(slot);
+    }
 
-          last_sample->sequence = last_sequence++;
+    if (timer >= 0)
+      processEvent(timer);
 
-          PathDestination::enqueueAll(this, &last_sample, 1);
-        }
-        // A source is ready to receive samples
-        else {
-          auto ps = sources[i];
+    writeDestinations();
+  }
 
-          ps->read(i);
-        }
-      }
+  return nullptr;
+}
+
+static inline uint64_t monotonic_ns() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Check if the process has the CAP_NET_ADMIN capability in its effective set.
+static bool hasNetAdmin() {
+  struct __user_cap_header_struct hdr = {.version = _LINUX_CAPABILITY_VERSION_3,
+                                         .pid = 0};
+  struct __user_cap_data_struct data[_LINUX_CAPABILITY_U32S_3] = {};
+
+  if (syscall(SYS_capget, &hdr, data))
+    return false;
+
+  return data[CAP_TO_INDEX(CAP_NET_ADMIN)].effective &
+         CAP_TO_MASK(CAP_NET_ADMIN);
+}
+
+/* Adaptive spin-then-block wait.
+ *
+ * We first spin on non-blocking epoll_wait(2) calls for the configured budget
+ * to avoid the wake-up latency of the scheduler. If no source gets ready, we
+ * fall back to a blocking wait.
+ */
+int Path::waitBusy(struct epoll_event *evs, int maxevents) {
+  int ret;
+  uint64_t start = monotonic_ns();
+  uint64_t deadline = start + busy_poll * 1000ULL;
+  uint64_t now;
+
+  do {
+    ret = epoll_wait(epfd, evs, maxevents, 0);
+    now = monotonic_ns();
+
+    if (ret != 0) {
+      spinTime.fetch_add(now - start, std::memory_order_relaxed);
+      return ret;
+    }
+
+    if (busy_poll_pause)
+      utils::cpuRelax();
+  } while (now < deadline);
+
+  spinTime.fetch_add(now - start, std::memory_order_relaxed);
+
+  ret = epoll_wait(epfd, evs, maxevents, -1);
+
+  blockTime.fetch_add(monotonic_ns() - now, std::memory_order_relaxed);
+
+  return ret;
+}
+
+void Path::processEvent(unsigned i) {
+  int s = pfdSources[i];
+
+  // Timeout: re-enqueue the last sample
+  if (s < 0) {
+    timeout.wait();
+
+    last_sample->sequence = last_sequence++;
+
+    /* The last sample gets updated by the path sources.
+     * Hence we must hand out a copy to the destinations. */
+    auto *smp = sample_clone(last_sample);
+    if (!smp) {
+      logger->warn("Pool underrun in path {}", this->toString());
+      return;
     }
 
-    for (auto pd : destinations)
-      pd->write();
+    auto *times = trace ? trace->getTimes(smp) : nullptr;
+    if (times)
+      times->read = times->enqueued = trace->now();
+
+    PathDestination::enqueueAll(this, &smp, 1);
+
+    sample_decref(smp);
   }
+  // A source is ready to receive samples
+  else {
+    auto ps = sources[s];
 
-  return nullptr;
+    ps->read(s);
+  }
+}
+
+void Path::writeDestinations() {
+  for (auto pd : destinations)
+    pd->write();
 }
 
 Path::Path()
-    : state(State::INITIALIZED), mode(Mode::ANY), timeout(CLOCK_MONOTONIC),
+    : scheduler(nullptr), spinTime(0), blockTime(0), state(State::INITIALIZED),
+      mode(Mode::ANY), epfd(-1), timeout(CLOCK_MONOTONIC),
       rate(0), // Disabled
-      affinity(0), enabled(true), poll(-1), reversed(false), builtin(true),
-      original_sequence_no(-1), queuelen(DEFAULT_QUEUE_LENGTH),
+      affinity(0), enabled(true), poll(-1), thread(-1), busy_poll(0),
+      busy_poll_socket(0), busy_poll_pause(true), reversed(false),
+      builtin(true), original_sequence_no(-1), queuelen(DEFAULT_QUEUE_LENGTH),
       logger(Log::get(fmt::format("path:{}", id++))) {
   uuid_clear(uuid);
 
@@ -119,9 +220,13 @@ Path::Path()
 }
 
 void Path::startPoll() {
+  int ret;
+
   pfds.clear();
+  pfdSources.clear();
 
-  for (auto ps : sources) {
+  for (unsigned i = 0; i < sources.size(); i++) {
+    auto ps = sources[i];
     auto fds = ps->getNode()->getPollFDs();
     for (auto fd : fds) {
       if (fd < 0)
@@ -132,6 +237,15 @@ void Path::startPoll() {
       struct pollfd pfd = {.fd = fd, .events = POLLIN};
 
       pfds.push_back(pfd);
+      pfdSources.push_back(i);
+
+      // Let the kernel busy poll the device queue of socket-based nodes
+      if (busy_poll_socket > 0 &&
+          setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_socket,
+                     sizeof(busy_poll_socket)) &&
+          errno != ENOTSOCK)
+        logger->warn("Failed to enable SO_BUSY_POLL for node {}: {}",
+                     ps->getNode()->getName(), strerror(errno));
     }
   }
 
@@ -146,6 +260,21 @@ void Path::startPoll() {
                          this->toString());
 
     pfds.push_back(pfd);
+    pfdSources.push_back(-1);
+  }
+
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epfd < 0)
+    throw SystemError("Failed to create epoll set for path {}",
+                      this->toString());
+
+  for (unsigned i = 0; i < pfds.size(); i++) {
+    struct epoll_event ev = {.events = EPOLLIN, .data = {.u32 = i}};
+
+    ret = epoll_ctl(epfd, EPOLL_CTL_ADD, pfds[i].fd, &ev);
+    if (ret)
+      throw SystemError("Failed to add file descriptor to epoll set of path {}",
+                        this->toString());
   }
 }
 
@@ -253,6 +382,10 @@ void Path::prepare(NodeList &nodes) {
     ps->mappings.push_back(me);
   }
 
+  // Compile flat mapping plans for each source
+  for (auto ps : sources)
+    ps->plan.compile(ps->mappings, signals->size());
+
   // Prepare path destinations
   int mt_cnt = 0;
   for (auto pd : destinations) {
@@ -282,6 +415,8 @@ void Path::prepare(NodeList &nodes) {
       poll = 1;
     else if (sources.size() > 1)
       poll = 1;
+    else if (busy_poll > 0 || busy_poll_socket > 0)
+      poll = 1;
     else
       poll = 0;
   }
@@ -297,13 +432,27 @@ void Path::prepare(NodeList &nodes) {
 
   // Prepare pool
   auto osigs = getOutputSignals();
-  unsigned pool_size = std::max(1UL, destinations.size()) * queuelen;
 
-  ret = pool_init(&pool, pool_size, SAMPLE_LENGTH(osigs->size()), pool_mt);
+  /* Samples are shared between all destinations.
+   * Only destinations with write hooks need private copies.
+   */
+  unsigned cow_destinations = std::count_if(
+      destinations.begin(), destinations.end(),
+      [](const PathDestination::Ptr &pd) { return pd->hasWriteHooks(); });
+  unsigned pool_size = (1 + cow_destinations) * queuelen;
+
+  // Headroom for the blocks cached by the path and destination threads
+  pool_size += (1 + destinations.size()) * DEFAULT_POOL_CACHE_SIZE;
+
+  ret = pool_init(&pool, pool_size, SAMPLE_LENGTH(osigs->size()), pool_mt,
+                  (int)PoolFlags::THREAD_CACHE);
   if (ret)
     throw RuntimeError("Failed to initialize pool of path: {}",
                        this->toString());
 
+  if (trace)
+    trace->setPool(&pool);
+
   logger->debug("Prepared path {} with {} output signals:", this->toString(),
                 osigs->size());
   if (logger->level() <= spdlog::level::debug)
@@ -315,7 +464,8 @@ void Path::prepare(NodeList &nodes) {
 }
 
 void Path::parse(json_t *json, NodeList &nodes, const uuid_t sn_uuid) {
-  int ret, en = -1, rev = -1;
+  int ret, en = -1, rev = -1, thrd = -1, trc = -1, pse = -1,
+      bltn = -1;
 
   json_error_t err;
   json_t *json_in;
@@ -328,13 +478,17 @@ void Path::parse(json_t *json, NodeList &nodes, const uuid_t sn_uuid) {
 
   ret = json_unpack_ex(json, &err, 0,
                        "{ s: o, s?: o, s?: o, s?: b, s?: b, s?: b, s?: i, s?: "
-                       "s, s?: b, s?: F, s?: o, s?: b, s?: s, s?: i }",
+                       "s, s?: b, s?: F, s?: o, s?: b, s?: s, s?: i, s?: b, "
+                       "s?: i, s?: i, s?: b, s?: b }",
                        "in", &json_in, "out", &json_out, "hooks", &json_hooks,
-                       "reverse", &rev, "enabled", &en, "builtin", &builtin,
+                       "reverse", &rev, "enabled", &en, "builtin", &bltn,
                        "queuelen", &queuelen, "mode", &mode_str, "poll", &poll,
                        "rate", &rate, "mask", &json_mask,
                        "original_sequence_no", &original_sequence_no, "uuid",
-                       &uuid_str, "affinity", &affinity);
+                       &uuid_str, "affinity", &affinity, "thread", &thrd,
+                       "busy_poll", &busy_poll, "busy_poll_socket",
+                       &busy_poll_socket, "busy_poll_pause", &pse, "trace",
+                       &trc);
   if (ret)
     throw ConfigError(json, err, "node-config-path",
                       "Failed to parse path configuration");
@@ -345,6 +499,18 @@ void Path::parse(json_t *json, NodeList &nodes, const uuid_t sn_uuid) {
   if (rev >= 0)
     reversed = rev != 0;
 
+  if (thrd >= 0)
+    thread = thrd != 0;
+
+  if (bltn >= 0)
+    builtin = bltn != 0;
+
+  if (trc > 0)
+    trace = std::make_unique<PathTrace>();
+
+  if (pse >= 0)
+    busy_poll_pause = pse != 0;
+
   // Optional settings
   if (mode_str) {
     if (!strcmp(mode_str, "any"))
@@ -406,6 +572,15 @@ void Path::parse(json_t *json, NodeList &nodes, const uuid_t sn_uuid) {
   if (json_mask)
     parseMask(json_mask, nodes);
 
+  /* Raising SO_BUSY_POLL above the system default requires CAP_NET_ADMIN.
+   * We check it once here instead of failing for each socket on every start. */
+  if (busy_poll_socket > 0 && !hasNetAdmin()) {
+    logger->warn("Setting 'busy_poll_socket' of path {} requires the "
+                 "CAP_NET_ADMIN capability. Disabling it",
+                 this->toString());
+    busy_poll_socket = 0;
+  }
+
   config = json;
   state = State::PARSED;
 }
@@ -443,6 +618,16 @@ void Path::check() {
     throw RuntimeError("Setting 'rate' of path {} must be a positive number.",
                        this->toString());
 
+  if (busy_poll < 0)
+    throw RuntimeError(
+        "Setting 'busy_poll' of path {} must be a positive number.",
+        this->toString());
+
+  if (busy_poll_socket < 0)
+    throw RuntimeError(
+        "Setting 'busy_poll_socket' of path {} must be a positive number.",
+        this->toString());
+
   if (!std::has_single_bit(queuelen)) {
     queuelen = std::bit_ceil(queuelen);
     logger->warn("Queue length should always be a power of 2. Adjusting to {}",
@@ -467,6 +652,16 @@ void Path::checkPrepared() {
     if (rate > 0)
       throw RuntimeError("Setting 'poll' must be activated when used together "
                          "with setting 'rate'");
+
+    // Busy polling spins on the file descriptors of the sources
+    if (busy_poll > 0)
+      throw RuntimeError("Setting 'poll' must be activated when used together "
+                         "with setting 'busy_poll'");
+
+    // The socket option is only applied to the polled file descriptors
+    if (busy_poll_socket > 0)
+      throw RuntimeError("Setting 'poll' must be activated when used together "
+                         "with setting 'busy_poll_socket'");
   } else {
     if (rate <= 0) {
       // Check that all path sources provide a file descriptor for polling if fixed rate is disabled
@@ -481,12 +676,42 @@ void Path::checkPrepared() {
   }
 }
 
-void Path::start() {
+void Path::start(PathScheduler *sched) {
   int ret;
   const char *mode_str;
 
   assert(state == State::PREPARED);
 
+  /* All paths share the worker pool unless a dedicated thread has been
+   * requested with the 'thread' setting. A path without polling is only
+   * eligible if its source provides a file descriptor for the workers. */
+  bool shared = sched && sched->isEnabled() && thread != 1;
+  if (shared && poll <= 0) {
+    for (auto ps : sources) {
+      if (ps->getNode()->getFactory()->getFlags() &
+          (int)NodeFactory::Flags::SUPPORTS_POLL)
+        continue;
+
+      if (thread == 0)
+        logger->warn("Path {} can not use a shared worker as node {} does "
+                     "not support polling. Using a dedicated thread",
+                     this->toString(), ps->getNode()->getName());
+
+      shared = false;
+      break;
+    }
+  }
+
+  // A spinning path would starve all other paths of a shared worker
+  if (shared && busy_poll > 0) {
+    if (thread == 0)
+      logger->warn("Path {} can not use a shared worker as busy polling is "
+                   "enabled. Using a dedicated thread",
+                   this->toString());
+
+    shared = false;
+  }
+
   switch (mode) {
   case Mode::ANY:
     mode_str = "any";
@@ -503,12 +728,14 @@ void Path::start() {
 
   logger->info("Starting path {}: #signals={}/{}, #hooks={}, #sources={}, "
                "#destinations={}, mode={}, poll={}, mask=0b{:b}, rate={}, "
-               "enabled={}, reversed={}, queuelen={}, original_sequence_no={}",
+               "enabled={}, reversed={}, queuelen={}, original_sequence_no={}, "
+               "thread={}, busy_poll={}, busy_poll_socket={}",
                this->toString(), signals->size(), getOutputSignals()->size(),
                hooks.size(), sources.size(), destinations.size(), mode_str,
                poll ? "yes" : "no", mask.to_ullong(), rate,
                isEnabled() ? "yes" : "no", isReversed() ? "yes" : "no",
-               queuelen, original_sequence_no ? "yes" : "no");
+               queuelen, original_sequence_no ? "yes" : "no",
+               shared ? "shared" : "dedicated", busy_poll, busy_poll_socket);
 
 #ifdef WITH_HOOKS
   hooks.start();
@@ -518,6 +745,12 @@ void Path::start() {
 
   received.reset();
 
+  spinTime = 0;
+  blockTime = 0;
+
+  if (trace)
+    trace->reset();
+
   // We initialize the initial sample
   last_sample = sample_alloc(&pool);
   if (!last_sample)
@@ -534,11 +767,24 @@ void Path::start() {
     last_sample->data[i] = sig->init;
   }
 
-  if (poll > 0)
+  // Shared workers always wait on the file descriptors of the sources
+  if (poll > 0 || shared)
     startPoll();
 
   state = State::STARTED;
 
+  if (shared) {
+    if (affinity)
+      logger->warn("Setting 'affinity' of path {} is ignored as it runs in "
+                   "a shared worker",
+                   this->toString());
+
+    scheduler = sched;
+    scheduler->add(this);
+
+    return;
+  }
+
   /* Start one thread per path for sending to destinations
    *
    * Special case: If the path only has a single source and this source
@@ -561,25 +807,42 @@ void Path::stop() {
 
   logger->info("Stopping path: {}", this->toString());
 
-  if (state != State::STOPPING)
+  if (scheduler) {
+    /* Waits until the worker has finished processing this path.
+     * Its file descriptors are removed from the epoll set of the worker
+     * before the path is stopped, so they can not trigger any more. */
+    scheduler->remove(this);
+    scheduler = nullptr;
+
+    state = State::STOPPING;
+  } else {
     state = State::STOPPING;
 
-  /* Cancel the thread in case is currently in a blocking syscall.
-   *
-   * We dont care if the thread has already been terminated.
-   */
-  ret = pthread_cancel(tid);
-  if (ret && ret != ESRCH)
-    throw RuntimeError("Failed to cancel path thread");
+    /* Cancel the thread in case is currently in a blocking syscall.
+     *
+     * We dont care if the thread has already been terminated.
+     */
+    ret = pthread_cancel(tid);
+    if (ret && ret != ESRCH)
+      throw RuntimeError("Failed to cancel path thread");
 
-  ret = pthread_join(tid, nullptr);
-  if (ret)
-    throw RuntimeError("Failed to join path thread");
+    ret = pthread_join(tid, nullptr);
+    if (ret)
+      throw RuntimeError("Failed to join path thread");
+  }
+
+  if (epfd >= 0) {
+    close(epfd);
+    epfd = -1;
+  }
 
 #ifdef WITH_HOOKS
   hooks.stop();
 #endif // WITH_HOOKS
 
+  if (trace)
+    trace->print(logger, false);
+
   sample_decref(last_sample);
 
   state = State::STOPPED;
@@ -664,6 +927,8 @@ json_t *Path::toJson() const {
   json_t *json_sources = json_array();
   json_t *json_destinations = json_array();
 
+  auto cache = pool_cache_stats(&pool);
+
   for (auto ps : sources)
     json_array_append_new(json_sources,
                           json_string(ps->node->getNameShort().c_str()));
@@ -674,14 +939,22 @@ json_t *Path::toJson() const {
 
   json_t *json_path = json_pack(
       "{ s: s, s: s, s: s, s: b, s: b s: b, s: b, s: b, s: b s: i, s: o, s: o, "
-      "s: o, s: o }",
+      "s: o, s: o, s: i, s: i, s: b, s: f, s: f, s: { s: I, s: I, s: I } }",
       "uuid", uuid::toString(uuid).c_str(), "state",
       stateToString(state).c_str(), "mode", mode == Mode::ANY ? "any" : "all",
       "enabled", enabled, "builtin", builtin, "reversed", reversed,
       "original_sequence_no", original_sequence_no, "last_sequence",
       last_sequence, "poll", poll, "queuelen", queuelen, "signals",
       json_signals, "hooks", json_hooks, "in", json_sources, "out",
-      json_destinations);
+      json_destinations, "busy_poll", busy_poll, "busy_poll_socket",
+      busy_poll_socket, "busy_poll_pause", busy_poll_pause, "spin_time",
+      spinTime.load(std::memory_order_relaxed) * 1e-9, "block_time",
+      blockTime.load(std::memory_order_relaxed) * 1e-9, "pool",
+      "cache_hits", (json_int_t)cache.hits, "cache_misses",
+      (json_int_t)cache.misses, "cached", (json_int_t)cache.cached);
+
+  if (trace)
+    json_object_set_new(json_path, "trace", trace->toJson());
 
   return json_path;
 }
@@ -7,6 +7,7 @@
 
 #include <villas/exceptions.hpp>
 #include <villas/node.hpp>
+#include <villas/node/config.hpp>
 #include <villas/node/memory.hpp>
 #include <villas/path.hpp>
 #include <villas/path_destination.hpp>
@@ -29,36 +30,36 @@ PathDestination::~PathDestination() {
 int PathDestination::prepare(int queuelen) {
   int ret;
 
-  ret = queue_init(&queue, queuelen);
+  /* The queue is only accessed by the thread of the path which
+   * enqueues to and writes from it. */
+  ret = queue_init(&queue, queuelen, memory::default_type,
+                   (int)QueueFlags::SPSC);
   if (ret)
     return ret;
 
   return 0;
 }
 
-void PathDestination::enqueueAll(Path *p, const struct Sample *const smps[],
+void PathDestination::enqueueAll(Path *p, struct Sample *const smps[],
                                  unsigned cnt) {
-  unsigned enqueued, cloned;
-
-  struct Sample *clones[cnt];
-
-  cloned = sample_clone_many(clones, smps, cnt);
-  if (cloned < cnt)
-    p->logger->warn("Pool underrun in path {}", p->toString());
+  unsigned enqueued;
 
+  /* All destinations share the very same samples.
+   * Each queue holds its own reference to them. Samples are copied
+   * lazily in PathDestination::write() only if a destination node
+   * has write hooks which might alter them.
+   */
   for (auto pd : p->destinations) {
-    enqueued = queue_push_many(&pd->queue, (void **)clones, cloned);
+    enqueued = queue_push_many(&pd->queue, (void **)smps, cnt);
     if (enqueued != cnt)
       p->logger->warn("Queue overrun for path {}", p->toString());
 
     // Increase reference counter of these samples as they are now also owned by the queue
-    sample_incref_many(clones, cloned);
+    sample_incref_many(smps, enqueued);
 
     p->logger->trace("Enqueued {} samples to destination {} of path {}",
                      enqueued, pd->node->getName(), p->toString());
   }
-
-  sample_decref_many(clones, cloned);
 }
 
 void PathDestination::write() {
@@ -67,6 +68,10 @@ void PathDestination::write() {
   int allocated;
 
   struct Sample *smps[cnt];
+  uint64_t t_read[cnt];
+
+  auto *trace = path->trace.get();
+  uint64_t t_dequeued = 0;
 
   // As long as there are still samples in the queue
   while (true) {
@@ -82,6 +87,32 @@ void PathDestination::write() {
         "Dequeued {} samples from queue of node {} which is part of path {}",
         allocated, node->getName(), path->toString());
 
+    if (trace) {
+      t_dequeued = trace->now();
+
+      // Looked up before the samples might get replaced by private copies
+      for (int i = 0; i < allocated; i++) {
+        auto *times = trace->getTimes(smps[i]);
+        if (times) {
+          trace->update(PathTrace::Stage::QUEUE, times->enqueued, t_dequeued);
+          t_read[i] = times->read;
+        } else
+          t_read[i] = 0;
+      }
+    }
+
+    // Get private copies of shared samples before write hooks alter them
+    if (hasWriteHooks()) {
+      int copied = sample_unshare_many(smps, allocated);
+      if (copied < 0) {
+        path->logger->warn("Pool underrun for destination {} of path {}",
+                           node->getName(), path->toString());
+
+        sample_decref_many(smps, allocated);
+        continue;
+      }
+    }
+
     sent = node->write(smps, allocated);
     if (sent < 0) {
       path->logger->error("Failed to sent {} samples to node {}: reason={}",
@@ -91,12 +122,31 @@ void PathDestination::write() {
       path->logger->debug("Partial write to node {}: written={}, expected={}",
                           node->getName(), sent, allocated);
 
+    if (trace) {
+      uint64_t t_written = trace->now();
+
+      trace->update(PathTrace::Stage::WRITE, t_dequeued, t_written, allocated);
+
+      for (int i = 0; i < allocated; i++) {
+        if (t_read[i])
+          trace->update(PathTrace::Stage::TOTAL, t_read[i], t_written);
+      }
+    }
+
     int released = sample_decref_many(smps, allocated);
 
     path->logger->trace("Released {} samples back to memory pool", released);
   }
 }
 
+bool PathDestination::hasWriteHooks() const {
+#ifdef WITH_HOOKS
+  return node->out.hooks.size() > 0;
+#else
+  return false;
+#endif // WITH_HOOKS
+}
+
 void PathDestination::check() {
   if (!node->isEnabled())
     throw RuntimeError("Destination {} is not enabled", node->getName());
@@ -0,0 +1,254 @@
+/* Shared worker pool for paths.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cerrno>
+
+#include <poll.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <villas/cpuset.hpp>
+#include <villas/exceptions.hpp>
+#include <villas/path.hpp>
+#include <villas/path_scheduler.hpp>
+
+using namespace villas;
+using namespace villas::node;
+using namespace villas::utils;
+
+PathScheduler::PathScheduler()
+    : state(State::INITIALIZED), numWorkers(0), affinity(0),
+      logger(Log::get("path_scheduler")) {}
+
+PathScheduler::~PathScheduler() { stop(); }
+
+void PathScheduler::parse(json_t *json) {
+  int ret, num = 0;
+
+  json_error_t err;
+
+  ret = json_unpack_ex(json, &err, 0, "{ s?: i, s?: i }", "workers", &num,
+                       "affinity", &affinity);
+  if (ret)
+    throw ConfigError(json, err, "node-config-scheduler",
+                      "Failed to parse scheduler configuration");
+
+  if (num < 0)
+    throw ConfigError(json, "node-config-scheduler",
+                      "Setting 'workers' must be a positive number");
+
+  numWorkers = num;
+
+  state = State::PARSED;
+}
+
+void PathScheduler::start() {
+  int ret;
+
+  if (!isEnabled() || state == State::STARTED)
+    return;
+
+  // Each worker is pinned to a single core of the affinity mask
+  CpuSet cset((unsigned)affinity);
+
+  std::vector<int> cpus;
+  for (unsigned i = 0; i < sizeof(affinity) * 8; i++) {
+    if (cset.isSet(i))
+      cpus.push_back(i);
+  }
+
+  for (unsigned i = 0; i < numWorkers; i++) {
+    auto w = std::make_unique<Worker>();
+
+    w->scheduler = this;
+    w->paths = 0;
+    w->running = true;
+    w->cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+
+    w->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (w->epfd < 0)
+      throw SystemError("Failed to create epoll set");
+
+    w->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (w->efd < 0)
+      throw SystemError("Failed to create eventfd");
+
+    // The wake-up eventfd is registered without an event
+    struct epoll_event ev = {.events = EPOLLIN, .data = {.ptr = nullptr}};
+
+    ret = epoll_ctl(w->epfd, EPOLL_CTL_ADD, w->efd, &ev);
+    if (ret)
+      throw SystemError("Failed to add eventfd to epoll set");
+
+    ret = pthread_create(&w->tid, nullptr, runWrapper, w.get());
+    if (ret)
+      throw RuntimeError("Failed to create path worker thread");
+
+    if (w->cpu >= 0) {
+      cpu_set_t cset_pin;
+
+      CPU_ZERO(&cset_pin);
+      CPU_SET(w->cpu, &cset_pin);
+
+      ret = pthread_setaffinity_np(w->tid, sizeof(cset_pin), &cset_pin);
+      if (ret)
+        throw SystemError("Failed to set CPU affinity of path worker");
+    }
+
+    workers.push_back(std::move(w));
+  }
+
+  logger->info("Started {} path workers", numWorkers);
+
+  state = State::STARTED;
+}
+
+void PathScheduler::stop() {
+  int ret;
+
+  if (state != State::STARTED)
+    return;
+
+  for (auto &w : workers) {
+    w->running = false;
+
+    uint64_t incr = 1;
+    ret = write(w->efd, &incr, sizeof(incr));
+    if (ret < 0)
+      throw SystemError("Failed to wake-up path worker");
+
+    ret = pthread_join(w->tid, nullptr);
+    if (ret)
+      throw RuntimeError("Failed to join path worker thread");
+
+    close(w->efd);
+    close(w->epfd);
+  }
+
+  workers.clear();
+
+  state = State::STOPPED;
+}
+
+void PathScheduler::add(Path *p) {
+  int ret;
+
+  assert(state == State::STARTED);
+
+  auto it = std::min_element(workers.begin(), workers.end(),
+                             [](const auto &a, const auto &b) {
+                               return a->paths < b->paths;
+                             });
+  auto *w = it->get();
+
+  std::lock_guard<std::mutex> guard(w->mutex);
+
+  for (unsigned i = 0; i < p->pfds.size(); i++) {
+    auto e = std::make_unique<Event>();
+
+    e->path = p;
+    e->slot = i;
+
+    struct epoll_event ev = {.events = EPOLLIN, .data = {.ptr = e.get()}};
+
+    ret = epoll_ctl(w->epfd, EPOLL_CTL_ADD, p->pfds[i].fd, &ev);
+    if (ret)
+      throw SystemError("Failed to add file descriptor of path {} to epoll set",
+                        p->toString());
+
+    w->events.push_back(std::move(e));
+  }
+
+  w->paths++;
+
+  logger->debug("Assigned path {} to worker {}", p->toString(),
+                it - workers.begin());
+}
+
+void PathScheduler::remove(Path *p) {
+  for (auto &w : workers) {
+    std::lock_guard<std::mutex> guard(w->mutex);
+
+    bool found = false;
+    for (auto &e : w->events) {
+      if (e->path != p)
+        continue;
+
+      // The file descriptor might have already been closed by the node.
+      epoll_ctl(w->epfd, EPOLL_CTL_DEL, p->pfds[e->slot].fd, nullptr);
+
+      e->path = nullptr;
+      found = true;
+    }
+
+    if (found)
+      w->paths--;
+  }
+}
+
+void *PathScheduler::runWrapper(void *arg) {
+  auto *w = (Worker *)arg;
+
+  w->scheduler->run(w);
+
+  return nullptr;
+}
+
+void PathScheduler::run(Worker *w) {
+  struct epoll_event evs[64];
+  std::vector<Path *> triggered;
+
+  while (w->running) {
+    int ret = epoll_wait(w->epfd, evs, std::size(evs), -1);
+    if (ret < 0) {
+      if (errno == EINTR)
+        continue;
+
+      throw SystemError("Failed to wait for events");
+    }
+
+    std::lock_guard<std::mutex> guard(w->mutex);
+
+    triggered.clear();
+
+    for (int i = 0; i < ret; i++) {
+      auto *e = (Event *)evs[i].data.ptr;
+
+      // Wake-up by PathScheduler::stop()
+      if (!e) {
+        uint64_t cnt;
+        if (read(w->efd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN)
+          throw SystemError("Failed to read from eventfd");
+
+        continue;
+      }
+
+      auto *p = e->path;
+      if (!p)
+        continue;
+
+      /* The file descriptors are level-triggered. We stop watching a path
+       * which is not started anymore, as it would wake us up right away. */
+      if (p->getState() != State::STARTED) {
+        epoll_ctl(w->epfd, EPOLL_CTL_DEL, p->pfds[e->slot].fd, nullptr);
+        continue;
+      }
+
+      p->processEvent(e->slot);
+
+      if (std::find(triggered.begin(), triggered.end(), p) == triggered.end())
+        triggered.push_back(p);
+    }
+
+    // Paths are flushed only once per wake-up
+    for (auto *p : triggered)
+      p->writeDestinations();
+  }
+}
@@ -15,6 +15,7 @@
 #include <villas/path_destination.hpp>
 #include <villas/path_source.hpp>
 #include <villas/sample.hpp>
+#include <villas/timing.hpp>
 #include <villas/utils.hpp>
 
 using namespace villas;
@@ -24,9 +25,13 @@ PathSource::PathSource(Path *p, Node *n) : node(n), path(p), masked(false) {
   int ret;
 
   int pool_size = std::max(DEFAULT_QUEUE_LENGTH, 20 * node->in.vectorize);
+
+  // Headroom for the blocks cached by the path and secondary path threads
+  pool_size += 4 * DEFAULT_POOL_CACHE_SIZE;
+
   ret = pool_init(&pool, pool_size,
                   SAMPLE_LENGTH(node->getInputSignalsMaxCount()),
-                  node->getMemoryType());
+                  node->getMemoryType(), (int)PoolFlags::THREAD_CACHE);
   if (ret)
     throw RuntimeError("Failed to initialize pool");
 }
@@ -47,11 +52,19 @@ int PathSource::read(int i) {
   struct Sample *muxed_smps[cnt];
   struct Sample **tomux_smps;
 
+  auto *trace = path->trace.get();
+  uint64_t t_start = 0, t_read = 0, t_muxed = 0;
+
   // Fill smps[] free sample blocks from the pool
   allocated = sample_alloc_many(&pool, read_smps, cnt);
   if (allocated != cnt)
     path->logger->warn("Pool underrun for path source {}", node->getName());
 
+  // Only polled sources are known to be ready before they are read
+  bool ready = path->poll > 0 || path->scheduler;
+  if (trace && ready)
+    t_start = trace->now();
+
   // Read ready samples and store them to blocks pointed by smps[]
   recv = node->read(read_smps, allocated);
   if (recv == 0) {
@@ -73,6 +86,23 @@ int PathSource::read(int i) {
     path->logger->warn("Partial read for path {}: read={}, expected={}",
                        path->toString(), recv, allocated);
 
+  /* The following stages start once the read returned, as Node::read() of
+   * a source which has not been polled might block until samples arrive.
+   * The read stage is measured from the time at which the node received each
+   * sample instead. Without it, only reads of polled sources are counted. */
+  if (trace) {
+    t_read = trace->now();
+
+    struct timespec now = time_now();
+    for (int j = 0; j < recv; j++) {
+      if (read_smps[j]->flags & (int)SampleFlags::HAS_TS_RECEIVED)
+        trace->update(PathTrace::Stage::READ,
+                      time_delta(&read_smps[j]->ts.received, &now));
+      else if (ready)
+        trace->update(PathTrace::Stage::READ, t_start, t_read);
+    }
+  }
+
   // Let the master path sources forward received samples to their secondaries
   writeToSecondaries(read_smps, recv);
 
@@ -84,16 +114,18 @@ int PathSource::read(int i) {
     tomux = 1;
   }
 
+  muxed_initialized = sample_alloc_many(&path->pool, muxed_smps, tomux);
+  if (muxed_initialized < tomux) {
+    path->logger->error("Pool underrun in path {}", path->toString());
+    enqueued = -1;
+    goto read_decref_muxed_smps;
+  }
+
   for (int i = 0; i < tomux; i++) {
-    muxed_smps[i] = i == 0 ? sample_clone(path->last_sample)
-                           : sample_clone(muxed_smps[i - 1]);
-    if (!muxed_smps[i]) {
-      path->logger->error("Pool underrun in path {}", path->toString());
-      muxed_initialized = i == 0 ? 0 : i - 1;
-      enqueued = -1;
-      goto read_decref_muxed_smps;
-    }
+    const struct Sample *prev =
+        i == 0 ? path->last_sample : muxed_smps[i - 1];
 
+    muxed_smps[i]->signals = path->signals;
     muxed_smps[i]->flags = tomux_smps[i]->flags;
 
     if (path->original_sequence_no) {
@@ -107,17 +139,10 @@ int PathSource::read(int i) {
       muxed_smps[i]->flags |= (int)SampleFlags::HAS_SEQUENCE;
     }
 
-    /* We reset the sample length after each restart of the simulation.
-     * This is necessary for the test_rtt node to work properly.
-     */
-    if (tomux_smps[i]->flags & (int)SampleFlags::NEW_SIMULATION)
-      muxed_smps[i]->length = 0;
-
     muxed_smps[i]->ts = tomux_smps[i]->ts;
-    ret = mappings.remap(muxed_smps[i], tomux_smps[i]);
+    ret = plan.apply(muxed_smps[i], tomux_smps[i], prev);
     if (ret < 0) {
       enqueued = ret;
-      muxed_initialized = i;
       goto read_decref_muxed_smps;
     }
 
@@ -126,10 +151,14 @@ int PathSource::read(int i) {
     else
       muxed_smps[i]->flags &= ~(int)SampleFlags::HAS_DATA;
   }
-  muxed_initialized = tomux;
 
   sample_copy(path->last_sample, muxed_smps[tomux - 1]);
 
+  if (trace) {
+    t_muxed = trace->now();
+    trace->update(PathTrace::Stage::MUX, t_read, t_muxed, tomux);
+  }
+
 #ifdef WITH_HOOKS
   toenqueue = path->hooks.process(muxed_smps, tomux);
   if (toenqueue == -1) {
@@ -146,6 +175,19 @@ int PathSource::read(int i) {
   toenqueue = tomux;
 #endif
 
+  if (trace) {
+    uint64_t t_hooked = trace->now();
+    trace->update(PathTrace::Stage::HOOKS, t_muxed, t_hooked, tomux);
+
+    for (int i = 0; i < toenqueue; i++) {
+      auto *times = trace->getTimes(muxed_smps[i]);
+      if (times) {
+        times->read = t_read;
+        times->enqueued = t_hooked;
+      }
+    }
+  }
+
   path->received.set(i);
 
   path->logger->trace("Source nodes: received=0b{:b}, mask=0b{:b}",
@@ -0,0 +1,101 @@
+/* Per-stage latency tracing of the path pipeline.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <fmt/format.h>
+
+#include <villas/exceptions.hpp>
+#include <villas/path_trace.hpp>
+
+using namespace villas;
+using namespace villas::node;
+
+PathTrace::PathTrace(int buckets, int warmup)
+    : histograms(NUM_STAGES, Hist(buckets, warmup)), pool(nullptr) {
+  int ret;
+
+  ret = tsc_init(&tsc);
+  if (ret)
+    throw RuntimeError("Failed to initialize TSC for path tracing");
+
+  period = 1.0 / tsc.frequency;
+}
+
+void PathTrace::reset() {
+  for (auto &h : histograms)
+    h.reset();
+}
+
+void PathTrace::setPool(const struct Pool *p) {
+  pool = p;
+  samples.assign(p->len / p->blocksz, {});
+}
+
+PathTrace::SampleTimes *PathTrace::getTimes(const struct Sample *smp) {
+  if (!pool)
+    return nullptr;
+
+  auto off = (const char *)smp - pool_buffer(pool);
+  if (off < 0 || (size_t)off >= pool->len)
+    return nullptr;
+
+  return &samples[off / pool->blocksz];
+}
+
+json_t *PathTrace::toJson() const {
+  json_t *json_trace = json_object();
+
+  for (unsigned i = 0; i < NUM_STAGES; i++)
+    json_object_set_new(json_trace, stageToString((Stage)i),
+                        histograms[i].toJson());
+
+  return json_trace;
+}
+
+void PathTrace::printPeriodic(Logger logger) const {
+  std::string line;
+
+  for (unsigned i = 0; i < NUM_STAGES; i++) {
+    auto &h = histograms[i];
+
+    line += fmt::format("{}{}={:.1f}/{:.1f}", i > 0 ? ", " : "",
+                        stageToString((Stage)i), h.getMean() * 1e6,
+                        h.getTotal() > 0 ? h.getHighest() * 1e6 : 0.0);
+  }
+
+  logger->info("Stage delays (mean/max µs): {}", line);
+}
+
+void PathTrace::print(Logger logger, bool details) const {
+  for (unsigned i = 0; i < NUM_STAGES; i++) {
+    logger->info("Stage {}:", stageToString((Stage)i));
+    histograms[i].print(logger, details, "  ");
+  }
+}
+
+const char *PathTrace::stageToString(Stage s) {
+  switch (s) {
+  case Stage::READ:
+    return "read";
+
+  case Stage::MUX:
+    return "mux";
+
+  case Stage::HOOKS:
+    return "hooks";
+
+  case Stage::QUEUE:
+    return "queue";
+
+  case Stage::WRITE:
+    return "write";
+
+  case Stage::TOTAL:
+    return "total";
+  }
+
+  return "unknown";
+}
@@ -5,6 +5,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <vector>
+
 #include <villas/exceptions.hpp>
 #include <villas/kernel/kernel.hpp>
 #include <villas/log.hpp>
@@ -13,13 +19,126 @@
 #include <villas/utils.hpp>
 
 using namespace villas;
+using namespace villas::node;
+
+namespace {
+
+// A per-thread stack of free blocks of a single pool.
+struct Magazine {
+  // Is set to nullptr when the pool gets destroyed.
+  std::atomic<struct Pool *> pool;
+  size_t count;
+  void *blocks[DEFAULT_POOL_CACHE_SIZE];
+
+  /* Is set once the thread has taken blocks from the pool.
+   * Threads which only release blocks do not keep them cached. */
+  bool owner;
+
+  // Only written by the owning thread.
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+  std::atomic<size_t> cached;
+};
+
+/* All magazines of all threads.
+ *
+ * The registry is used to invalidate the magazines of a destroyed pool and
+ * to collect statistics. It is intentionally leaked as thread-local caches
+ * might be destroyed after static objects.
+ */
+struct Registry {
+  std::mutex mutex;
+  std::list<Magazine *> magazines;
+};
+
+Registry &registry() {
+  static auto *r = new Registry;
+  return *r;
+}
+
+// Return the oldest cnt blocks of the magazine to the queue.
+void flush(struct Pool *p, Magazine *m, size_t cnt) {
+  queue_push_many(&p->queue, m->blocks, cnt);
+
+  m->count -= cnt;
+  memmove(m->blocks, &m->blocks[cnt], m->count * sizeof(m->blocks[0]));
+
+  m->cached.store(m->count, std::memory_order_relaxed);
+}
+
+void inc(std::atomic<uint64_t> &counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+// The magazines of the calling thread.
+class ThreadCache {
+
+protected:
+  std::vector<Magazine *> magazines;
+
+public:
+  ~ThreadCache() {
+    auto &r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+
+    for (auto *m : magazines) {
+      auto *p = m->pool.load();
+      if (p) {
+        flush(p, m, m->count);
+
+        p->cache_hits += m->hits;
+        p->cache_misses += m->misses;
+      }
+
+      r.magazines.remove(m);
+      delete m;
+    }
+  }
+
+  Magazine *get(struct Pool *p) {
+    for (auto *m : magazines) {
+      if (m->pool.load(std::memory_order_relaxed) == p)
+        return m;
+    }
+
+    auto *m = new Magazine();
+    m->pool = p;
+    m->count = 0;
+    m->owner = false;
+
+    auto &r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+
+    // Reuse a magazine whose pool has been destroyed
+    for (auto &o : magazines) {
+      if (!o->pool) {
+        r.magazines.remove(o);
+        delete o;
+
+        o = m;
+        r.magazines.push_back(m);
+        return m;
+      }
+    }
+
+    magazines.push_back(m);
+    r.magazines.push_back(m);
+
+    return m;
+  }
+};
+
+thread_local ThreadCache cache;
+
+} // namespace
 
 const char *villas::node::pool_buffer(const struct Pool *pool) {
   return reinterpret_cast<const char *>(pool) + pool->buffer_off;
 }
 
 int villas::node::pool_init(struct Pool *p, size_t cnt, size_t blocksz,
-                            struct memory::Type *m) {
+                            struct memory::Type *m, int flags) {
   int ret;
   auto logger = Log::get("pool");
 
@@ -27,6 +146,9 @@ int villas::node::pool_init(struct Pool *p, size_t cnt, size_t blocksz,
   p->alignment = kernel::getCachelineSize();
   p->blocksz = p->alignment * CEIL(blocksz, p->alignment);
   p->len = cnt * p->blocksz;
+  p->flags = flags;
+  p->cache_hits = 0;
+  p->cache_misses = 0;
 
   logger->debug("New memory pool: alignment={}, blocksz={}, len={}, memory={}",
                 p->alignment, p->blocksz, p->len, m->name);
@@ -58,6 +180,19 @@ int villas::node::pool_destroy(struct Pool *p) {
   if (p->state == State::DESTROYED)
     return 0;
 
+  // Invalidate the cached blocks of all threads
+  if (p->flags & (int)PoolFlags::THREAD_CACHE) {
+    auto &r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+
+    for (auto *m : r.magazines) {
+      if (m->pool == p) {
+        m->pool = nullptr;
+        m->count = 0;
+      }
+    }
+  }
+
   ret = queue_destroy(&p->queue);
   if (ret)
     return ret;
@@ -72,19 +207,107 @@ int villas::node::pool_destroy(struct Pool *p) {
 
 ssize_t villas::node::pool_get_many(struct Pool *p, void *blocks[],
                                     size_t cnt) {
-  return queue_pull_many(&p->queue, blocks, cnt);
+  if (!(p->flags & (int)PoolFlags::THREAD_CACHE))
+    return queue_pull_many(&p->queue, blocks, cnt);
+
+  auto *m = cache.get(p);
+
+  m->owner = true;
+
+  // Refill the magazine with a single batch from the queue
+  if (m->count < cnt) {
+    int ret = queue_pull_many(&p->queue, &m->blocks[m->count],
+                              DEFAULT_POOL_CACHE_SIZE - m->count);
+    if (ret > 0)
+      m->count += ret;
+
+    inc(m->misses);
+  } else
+    inc(m->hits);
+
+  size_t n = std::min(cnt, m->count);
+  for (size_t i = 0; i < n; i++)
+    blocks[i] = m->blocks[--m->count];
+
+  m->cached.store(m->count, std::memory_order_relaxed);
+
+  // Requests which are larger than the magazine are served by the queue
+  if (n < cnt) {
+    int ret = queue_pull_many(&p->queue, &blocks[n], cnt - n);
+    if (ret > 0)
+      n += ret;
+  }
+
+  return n;
 }
 
 ssize_t villas::node::pool_put_many(struct Pool *p, void *blocks[],
                                     size_t cnt) {
-  return queue_push_many(&p->queue, blocks, cnt);
+  if (!(p->flags & (int)PoolFlags::THREAD_CACHE))
+    return queue_push_many(&p->queue, blocks, cnt);
+
+  auto *m = cache.get(p);
+
+  /* Blocks released by a foreign thread would be stranded in its magazine
+   * as it never takes them out again. They go straight back to the queue. */
+  if (!m->owner) {
+    inc(m->misses);
+
+    return queue_push_many(&p->queue, blocks, cnt);
+  }
+
+  if (m->count + cnt > DEFAULT_POOL_CACHE_SIZE)
+    inc(m->misses);
+  else
+    inc(m->hits);
+
+  for (size_t i = 0; i < cnt; i++) {
+    // Flush the older half of the magazine in a single batch
+    if (m->count == DEFAULT_POOL_CACHE_SIZE)
+      flush(p, m, DEFAULT_POOL_CACHE_SIZE / 2);
+
+    m->blocks[m->count++] = blocks[i];
+  }
+
+  m->cached.store(m->count, std::memory_order_relaxed);
+
+  return cnt;
 }
 
 void *villas::node::pool_get(struct Pool *p) {
   void *ptr;
-  return queue_pull(&p->queue, &ptr) == 1 ? ptr : nullptr;
+  return pool_get_many(p, &ptr, 1) == 1 ? ptr : nullptr;
 }
 
 int villas::node::pool_put(struct Pool *p, void *buf) {
-  return queue_push(&p->queue, buf);
+  return pool_put_many(p, &buf, 1);
+}
+
+void villas::node::pool_cache_flush(struct Pool *p) {
+  if (!(p->flags & (int)PoolFlags::THREAD_CACHE))
+    return;
+
+  auto *m = cache.get(p);
+
+  flush(p, m, m->count);
+}
+
+struct PoolCacheStats villas::node::pool_cache_stats(const struct Pool *p) {
+  struct PoolCacheStats stats = {.hits = p->cache_hits,
+                                 .misses = p->cache_misses,
+                                 .cached = 0};
+
+  auto &r = registry();
+  std::lock_guard<std::mutex> guard(r.mutex);
+
+  for (auto *m : r.magazines) {
+    if (m->pool != p)
+      continue;
+
+    stats.hits += m->hits.load(std::memory_order_relaxed);
+    stats.misses += m->misses.load(std::memory_order_relaxed);
+    stats.cached += m->cached.load(std::memory_order_relaxed);
+  }
+
+  return stats;
 }
@@ -31,16 +31,19 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include <villas/log.hpp>
 #include <villas/node/memory.hpp>
 #include <villas/queue.h>
 #include <villas/utils.hpp>
 
 using namespace villas;
+using namespace villas::node;
 
 // Initialize MPMC queue
 int villas::node::queue_init(struct CQueue *q, size_t size,
-                             struct memory::Type *m) {
+                             struct memory::Type *m, int flags) {
   // Queue size must be 2 exponent
   if (!std::has_single_bit(size)) {
     size_t old_size = size;
@@ -51,6 +54,9 @@ int villas::node::queue_init(struct CQueue *q, size_t size,
   }
 
   q->buffer_mask = size - 1;
+  q->flags = flags;
+  q->head_cache = 0;
+  q->tail_cache = 0;
   struct CQueue_cell *buffer =
       (struct CQueue_cell *)memory::alloc(sizeof(struct CQueue_cell) * size, m);
   if (!buffer)
@@ -95,11 +101,84 @@ size_t villas::node::queue_available(struct CQueue *q) {
          std::atomic_load_explicit(&q->head, std::memory_order_relaxed);
 }
 
+/* Single-producer, single-consumer (SPSC) variant.
+ *
+ * The cell sequence numbers are not used. Instead, the producer and consumer
+ * publish their progress only via the tail and head pointers. Each side keeps
+ * a private copy of the other side's pointer and only reloads it if the queue
+ * seems to be full / empty. This avoids bouncing cache lines between both
+ * cores for every element.
+ */
+static int queue_spsc_push_many(struct CQueue *q, void *ptr[], size_t cnt) {
+  struct CQueue_cell *buffer;
+  size_t tail, avail, i;
+
+  if (std::atomic_load_explicit(&q->state, std::memory_order_relaxed) ==
+      State::STOPPED)
+    return -1;
+
+  buffer = reinterpret_cast<struct CQueue_cell *>(reinterpret_cast<char *>(q) +
+                                                  q->buffer_off);
+  tail = std::atomic_load_explicit(&q->tail, std::memory_order_relaxed);
+
+  avail = q->buffer_mask + 1 - (tail - q->head_cache);
+  if (avail < cnt) {
+    q->head_cache =
+        std::atomic_load_explicit(&q->head, std::memory_order_acquire);
+    avail = q->buffer_mask + 1 - (tail - q->head_cache);
+  }
+
+  cnt = std::min(cnt, avail);
+  for (i = 0; i < cnt; i++)
+    buffer[(tail + i) & q->buffer_mask].data_off =
+        reinterpret_cast<char *>(ptr[i]) - reinterpret_cast<char *>(q);
+
+  // Publish all elements at once
+  if (cnt > 0)
+    std::atomic_store_explicit(&q->tail, tail + cnt, std::memory_order_release);
+
+  return cnt;
+}
+
+static int queue_spsc_pull_many(struct CQueue *q, void *ptr[], size_t cnt) {
+  struct CQueue_cell *buffer;
+  size_t head, avail, i;
+
+  if (std::atomic_load_explicit(&q->state, std::memory_order_relaxed) ==
+      State::STOPPED)
+    return -1;
+
+  buffer = reinterpret_cast<struct CQueue_cell *>(reinterpret_cast<char *>(q) +
+                                                  q->buffer_off);
+  head = std::atomic_load_explicit(&q->head, std::memory_order_relaxed);
+
+  avail = q->tail_cache - head;
+  if (avail < cnt) {
+    q->tail_cache =
+        std::atomic_load_explicit(&q->tail, std::memory_order_acquire);
+    avail = q->tail_cache - head;
+  }
+
+  cnt = std::min(cnt, avail);
+  for (i = 0; i < cnt; i++)
+    ptr[i] = reinterpret_cast<char *>(q) +
+             buffer[(head + i) & q->buffer_mask].data_off;
+
+  // Release all cells at once
+  if (cnt > 0)
+    std::atomic_store_explicit(&q->head, head + cnt, std::memory_order_release);
+
+  return cnt;
+}
+
 int villas::node::queue_push(struct CQueue *q, void *ptr) {
   struct CQueue_cell *cell, *buffer;
   size_t pos, seq;
   intptr_t diff;
 
+  if (q->flags & (int)QueueFlags::SPSC)
+    return queue_spsc_push_many(q, &ptr, 1);
+
   if (std::atomic_load_explicit(&q->state, std::memory_order_relaxed) ==
       State::STOPPED)
     return -1;
@@ -135,6 +214,9 @@ int villas::node::queue_pull(struct CQueue *q, void **ptr) {
   size_t pos, seq;
   intptr_t diff;
 
+  if (q->flags & (int)QueueFlags::SPSC)
+    return queue_spsc_pull_many(q, ptr, 1);
+
   if (std::atomic_load_explicit(&q->state, std::memory_order_relaxed) ==
       State::STOPPED)
     return -1;
@@ -169,6 +251,9 @@ int villas::node::queue_push_many(struct CQueue *q, void *ptr[], size_t cnt) {
   int ret;
   size_t i;
 
+  if (q->flags & (int)QueueFlags::SPSC)
+    return queue_spsc_push_many(q, ptr, cnt);
+
   for (ret = 0, i = 0; i < cnt; i++) {
     ret = queue_push(q, ptr[i]);
     if (ret <= 0)
@@ -185,6 +270,9 @@ int villas::node::queue_pull_many(struct CQueue *q, void *ptr[], size_t cnt) {
   int ret;
   size_t i;
 
+  if (q->flags & (int)QueueFlags::SPSC)
+    return queue_spsc_pull_many(q, ptr, cnt);
+
   for (ret = 0, i = 0; i < cnt; i++) {
     ret = queue_pull(q, &ptr[i]);
     if (ret <= 0)
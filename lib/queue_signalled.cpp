@@ -5,6 +5,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <atomic>
+#include <climits>
+
+#include <villas/kernel/kernel.hpp>
 #include <villas/node/config.hpp>
 #include <villas/queue_signalled.h>
 
@@ -12,8 +16,39 @@
 #include <sys/eventfd.h>
 #endif
 
+using namespace villas;
 using namespace villas::node;
 
+#ifdef __linux__
+static void queue_signalled_futex_wake(struct CQueueSignalled *qs) {
+  bool shared = (int)qs->flags & (int)QueueSignalledFlags::PROCESS_SHARED;
+
+  std::atomic_ref(qs->futex.seq).fetch_add(1);
+
+  if (std::atomic_ref(qs->futex.waiters).load())
+    kernel::futexWake(&qs->futex.seq, INT_MAX, shared);
+}
+
+static void queue_signalled_futex_cleanup(void *p) {
+  struct CQueueSignalled *qs = (struct CQueueSignalled *)p;
+
+  std::atomic_ref(qs->futex.waiters).fetch_sub(1);
+}
+
+// Block until the queue has been pushed to since seq has been read
+static void queue_signalled_futex_wait(struct CQueueSignalled *qs,
+                                       uint32_t seq) {
+  bool shared = (int)qs->flags & (int)QueueSignalledFlags::PROCESS_SHARED;
+
+  std::atomic_ref(qs->futex.waiters).fetch_add(1);
+
+  // The wait is a cancellation point
+  pthread_cleanup_push(queue_signalled_futex_cleanup, qs);
+  kernel::futexWait(&qs->futex.seq, seq, shared);
+  pthread_cleanup_pop(1);
+}
+#endif
+
 static void queue_signalled_cleanup(void *p) {
   struct CQueueSignalled *qs = (struct CQueueSignalled *)p;
 
@@ -28,11 +63,12 @@ int villas::node::queue_signalled_init(struct CQueueSignalled *qs, size_t size,
   int ret;
 
   qs->mode = mode;
+  qs->flags = (enum QueueSignalledFlags)flags;
 
   if (qs->mode == QueueSignalledMode::AUTO) {
 #ifdef __linux__
     if (flags & (int)QueueSignalledFlags::PROCESS_SHARED)
-      qs->mode = QueueSignalledMode::PTHREAD;
+      qs->mode = QueueSignalledMode::FUTEX;
     else {
 #ifdef HAS_EVENTFD
       qs->mode = QueueSignalledMode::EVENTFD;
@@ -45,7 +81,7 @@ int villas::node::queue_signalled_init(struct CQueueSignalled *qs, size_t size,
 #endif
   }
 
-  ret = queue_init(&qs->queue, size, mem);
+  ret = queue_init(&qs->queue, size, mem, flags & (int)QueueFlags::SPSC);
   if (ret < 0)
     return ret;
 
@@ -95,6 +131,12 @@ int villas::node::queue_signalled_init(struct CQueueSignalled *qs, size_t size,
     if (qs->eventfd < 0)
       return -2;
   }
+#endif
+#ifdef __linux__
+  else if (qs->mode == QueueSignalledMode::FUTEX) {
+    qs->futex.seq = 0;
+    qs->futex.waiters = 0;
+  }
 #endif
   else
     return -1;
@@ -121,6 +163,11 @@ int villas::node::queue_signalled_destroy(struct CQueueSignalled *qs) {
     if (ret)
       return ret;
   }
+#endif
+#ifdef __linux__
+  else if (qs->mode == QueueSignalledMode::FUTEX) {
+    // Nothing todo
+  }
 #endif
   else
     return -1;
@@ -150,6 +197,10 @@ int villas::node::queue_signalled_push(struct CQueueSignalled *qs, void *ptr) {
     if (ret < 0)
       return ret;
   }
+#endif
+#ifdef __linux__
+  else if (qs->mode == QueueSignalledMode::FUTEX)
+    queue_signalled_futex_wake(qs);
 #endif
   else
     return -1;
@@ -180,6 +231,10 @@ int villas::node::queue_signalled_push_many(struct CQueueSignalled *qs,
     if (ret < 0)
       return ret;
   }
+#endif
+#ifdef __linux__
+  else if (qs->mode == QueueSignalledMode::FUTEX)
+    queue_signalled_futex_wake(qs);
 #endif
   else
     return -1;
@@ -197,6 +252,12 @@ int villas::node::queue_signalled_pull(struct CQueueSignalled *qs, void **ptr) {
     pthread_mutex_lock(&qs->pthread.mutex);
 
   while (!pulled) {
+#ifdef __linux__
+    uint32_t seq = qs->mode == QueueSignalledMode::FUTEX
+                       ? std::atomic_ref(qs->futex.seq).load()
+                       : 0;
+#endif
+
     pulled = queue_pull(&qs->queue, ptr);
     if (pulled < 0)
       break;
@@ -213,6 +274,10 @@ int villas::node::queue_signalled_pull(struct CQueueSignalled *qs, void **ptr) {
         if (ret < 0)
           break;
       }
+#endif
+#ifdef __linux__
+      else if (qs->mode == QueueSignalledMode::FUTEX)
+        queue_signalled_futex_wait(qs, seq);
 #endif
       else
         break;
@@ -238,6 +303,12 @@ int villas::node::queue_signalled_pull_many(struct CQueueSignalled *qs,
     pthread_mutex_lock(&qs->pthread.mutex);
 
   while (!pulled) {
+#ifdef __linux__
+    uint32_t seq = qs->mode == QueueSignalledMode::FUTEX
+                       ? std::atomic_ref(qs->futex.seq).load()
+                       : 0;
+#endif
+
     pulled = queue_pull_many(&qs->queue, ptr, cnt);
     if (pulled < 0)
       break;
@@ -254,6 +325,10 @@ int villas::node::queue_signalled_pull_many(struct CQueueSignalled *qs,
         if (ret < 0)
           break;
       }
+#endif
+#ifdef __linux__
+      else if (qs->mode == QueueSignalledMode::FUTEX)
+        queue_signalled_futex_wait(qs, seq);
 #endif
       else
         break;
@@ -291,6 +366,10 @@ int villas::node::queue_signalled_close(struct CQueueSignalled *qs) {
     if (ret < 0)
       return ret;
   }
+#endif
+#ifdef __linux__
+  else if (qs->mode == QueueSignalledMode::FUTEX)
+    queue_signalled_futex_wake(qs);
 #endif
   else
     return -1;
@@ -188,6 +188,25 @@ int villas::node::sample_copy_many(struct Sample *const dsts[],
   return cnt;
 }
 
+int villas::node::sample_unshare_many(struct Sample *smps[], int cnt) {
+  int copied = 0;
+
+  for (int i = 0; i < cnt; i++) {
+    if (atomic_load(&smps[i]->refcnt) == 1)
+      continue;
+
+    struct Sample *copy = sample_clone(smps[i]);
+    if (!copy)
+      return -1;
+
+    sample_decref(smps[i]);
+    smps[i] = copy;
+    copied++;
+  }
+
+  return copied;
+}
+
 int villas::node::sample_cmp(struct Sample *a, struct Sample *b, double epsilon,
                              int flags) {
   if ((a->flags & flags) != (b->flags & flags)) {
@@ -0,0 +1,53 @@
+/* Column-major view on a batch of samples.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cassert>
+
+#include <villas/sample.hpp>
+#include <villas/sample_block.hpp>
+#include <villas/utils.hpp>
+
+using namespace villas;
+using namespace villas::node;
+
+/* The storage is aligned to a cache line by its allocator.
+ * Columns start at a multiple of a cache line within the storage. */
+static constexpr unsigned COLUMN_ALIGNMENT = CACHELINE_SIZE / sizeof(double);
+
+void SampleBlock::resize(unsigned cnt) {
+  count = cnt;
+  stride = ALIGN(cnt, COLUMN_ALIGNMENT);
+
+  size_t len = (size_t)stride * indices.size();
+  if (values.size() < len)
+    values.resize(len);
+}
+
+void SampleBlock::gatherColumn(struct Sample *const smps[], unsigned col) {
+  unsigned index = indices[col];
+  double *dst = column(col);
+
+  for (unsigned i = 0; i < count; i++) {
+    assert(index < smps[i]->length);
+
+    dst[i] = smps[i]->data[index].f;
+  }
+}
+
+void SampleBlock::scatterColumn(struct Sample *const smps[],
+                                unsigned col) const {
+  unsigned index = indices[col];
+  const double *src = column(col);
+
+  for (unsigned i = 0; i < count; i++)
+    smps[i]->data[index].f = src[i];
+}
+
+void SampleBlock::scatter(struct Sample *const smps[]) const {
+  for (unsigned col = 0; col < indices.size(); col++)
+    scatterColumn(smps, col);
+}
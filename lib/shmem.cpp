@@ -5,17 +5,26 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cerrno>
+#include <climits>
+#include <cstring>
 
 #include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
 #include <semaphore.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 
 #include <villas/kernel/kernel.hpp>
 #include <villas/node/memory.hpp>
 #include <villas/sample.hpp>
 #include <villas/shmem.hpp>
+#include <villas/timing.hpp>
 #include <villas/utils.hpp>
 
 using namespace villas;
@@ -37,9 +46,52 @@ size_t villas::node::shmem_total_size(int queuelen, int samplelen) {
          + 1024;
 }
 
+// Wait on a semaphore while checking for the exit of the peer process.
+static int shmem_int_wait(sem_t *sem, pid_t peer, double timeout) {
+  int ret;
+
+  if (peer <= 0 && timeout < 0)
+    return sem_wait(sem);
+
+  struct timespec now = time_now();
+  struct timespec tmo = time_from_double(timeout);
+  struct timespec deadline = time_add(&now, &tmo);
+  struct timespec step = time_from_double(0.1);
+
+  while (true) {
+    struct timespec until = time_add(&now, &step);
+    if (timeout >= 0 && time_cmp(&deadline, &until) < 0)
+      until = deadline;
+
+    ret = sem_timedwait(sem, &until);
+    if (!ret)
+      return 0;
+    else if (errno != ETIMEDOUT && errno != EINTR)
+      return -1;
+
+    // Check without reaping it, as this is left to the owner of the process
+    if (peer > 0) {
+      siginfo_t info = {};
+
+      ret = waitid(P_PID, peer, &info, WEXITED | WNOHANG | WNOWAIT);
+      if (ret || info.si_pid == peer) {
+        errno = ECHILD;
+        return -1;
+      }
+    }
+
+    now = time_now();
+    if (timeout >= 0 && time_cmp(&now, &deadline) >= 0) {
+      errno = ETIMEDOUT;
+      return -1;
+    }
+  }
+}
+
 int villas::node::shmem_int_open(const char *wname, const char *rname,
                                  struct ShmemInterface *shm,
-                                 struct ShmemConfig *conf) {
+                                 struct ShmemConfig *conf, pid_t peer,
+                                 double timeout) {
   char *cptr;
   int fd, ret;
   size_t len;
@@ -95,7 +147,7 @@ retry:
 
   int flags = (int)QueueSignalledFlags::PROCESS_SHARED;
   enum QueueSignalledMode mode =
-      conf->polling ? QueueSignalledMode::POLLING : QueueSignalledMode::PTHREAD;
+      conf->polling ? QueueSignalledMode::POLLING : conf->mode;
 
   ret = queue_signalled_init(&shared->queue, conf->queuelen, manager, mode,
                              flags);
@@ -119,7 +171,19 @@ retry:
   /* Post own semaphore and wait on the other one, so both processes know that
    * both regions are initialized */
   sem_post(sem_own);
-  sem_wait(sem_other);
+
+  ret = shmem_int_wait(sem_other, peer, timeout);
+  if (ret) {
+    int err = errno;
+
+    sem_unlink(wname);
+    sem_unlink(rname);
+    shm_unlink(wname);
+    munmap(base, len);
+
+    errno = err;
+    return -13;
+  }
 
   // Open and map the other region
   fd = shm_open(rname, O_RDWR, 0);
@@ -211,3 +275,265 @@ int villas::node::shmem_int_alloc(struct ShmemInterface *shm,
                                   struct Sample *smps[], unsigned cnt) {
   return sample_alloc_many(&shm->write.shared->pool, smps, cnt);
 }
+
+static struct ShmemBroadcastSlot *shmem_bcast_slot(struct ShmemBroadcast *bc,
+                                                   uint64_t pos) {
+  auto *shared = bc->shared;
+  char *slots = (char *)(shared + 1);
+
+  return (struct ShmemBroadcastSlot *)(slots + (pos & (shared->slots - 1)) *
+                                                   shared->slotsize);
+}
+
+int villas::node::shmem_bcast_create(const char *name,
+                                     struct ShmemBroadcast *bc, int slots,
+                                     int samplelen) {
+  int fd;
+
+  if (slots <= 0 || samplelen < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  size_t slotsize =
+      CEIL(sizeof(struct ShmemBroadcastSlot) + SAMPLE_DATA_LENGTH(samplelen),
+           kernel::getCachelineSize()) *
+      kernel::getCachelineSize();
+
+  slots = std::bit_ceil((unsigned)slots);
+
+  size_t len = sizeof(struct ShmemBroadcastShared) + slots * slotsize;
+
+  // Remove stale objects of previous writers
+  shm_unlink(name);
+
+  fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0)
+    return -2;
+
+  if (ftruncate(fd, len) < 0) {
+    close(fd);
+    return -3;
+  }
+
+  void *base = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return -4;
+
+  // The object is zero-filled by ftruncate()
+  auto *shared = (struct ShmemBroadcastShared *)base;
+  shared->version = SHMEM_BROADCAST_VERSION;
+  shared->slots = slots;
+  shared->slotsize = slotsize;
+  shared->samplelen = samplelen;
+
+  bc->name = name;
+  bc->base = base;
+  bc->len = len;
+  bc->shared = shared;
+  bc->cursor = 0;
+  bc->lost = 0;
+  bc->writer = true;
+  bc->closing = false;
+  bc->active = 0;
+
+  // Mark all slots as empty
+  for (int i = 0; i < slots; i++)
+    shmem_bcast_slot(bc, i)->pos = UINT64_MAX;
+
+  // Readers check the magic last
+  std::atomic_ref(shared->magic).store(SHMEM_BROADCAST_MAGIC);
+
+  return 0;
+}
+
+int villas::node::shmem_bcast_attach(const char *name,
+                                     struct ShmemBroadcast *bc) {
+  int fd;
+  struct stat sb;
+
+  fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0)
+    return -1;
+
+  if (fstat(fd, &sb) < 0 ||
+      (size_t)sb.st_size < sizeof(struct ShmemBroadcastShared)) {
+    close(fd);
+    errno = EAGAIN;
+    return -2;
+  }
+
+  void *base =
+      mmap(nullptr, sb.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+    return -3;
+
+  auto *shared = (struct ShmemBroadcastShared *)base;
+  if (std::atomic_ref(shared->magic).load() != SHMEM_BROADCAST_MAGIC ||
+      shared->version != SHMEM_BROADCAST_VERSION) {
+    munmap(base, sb.st_size);
+    errno = EAGAIN;
+    return -4;
+  }
+
+  bc->name = name;
+  bc->base = base;
+  bc->len = sb.st_size;
+  bc->shared = shared;
+  bc->cursor = std::atomic_ref(shared->head).load();
+  bc->lost = 0;
+  bc->writer = false;
+  bc->closing = false;
+  bc->active = 0;
+
+  return 0;
+}
+
+int villas::node::shmem_bcast_close(struct ShmemBroadcast *bc) {
+  auto *shared = bc->shared;
+
+  bc->closing = true;
+
+  if (bc->writer)
+    std::atomic_ref(shared->closed).store(1);
+
+  /* Wake up blocked readers. Readers of other handles go back to sleep as
+   * nothing has been written. */
+  std::atomic_ref(shared->futex).fetch_add(1);
+  kernel::futexWake(&shared->futex, INT_MAX, true);
+
+  if (bc->writer)
+    shm_unlink(bc->name);
+
+  // Wait for local readers to leave before the mapping is removed
+  while (bc->active)
+    sched_yield();
+
+  return munmap(bc->base, bc->len);
+}
+
+int villas::node::shmem_bcast_write(struct ShmemBroadcast *bc,
+                                    const struct Sample *const smps[],
+                                    unsigned cnt) {
+  auto *shared = bc->shared;
+  uint64_t head = std::atomic_ref(shared->head).load(std::memory_order_relaxed);
+
+  for (unsigned i = 0; i < cnt; i++, head++) {
+    auto *slot = shmem_bcast_slot(bc, head);
+    auto *smp = smps[i];
+
+    std::atomic_ref(slot->pos).store(UINT64_MAX, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->sequence = smp->sequence;
+    slot->ts_origin = smp->ts.origin;
+    slot->ts_received = smp->ts.received;
+    slot->flags = smp->flags;
+    slot->length = std::min(smp->length, shared->samplelen);
+
+    memcpy(slot->data, smp->data, SAMPLE_DATA_LENGTH(slot->length));
+
+    std::atomic_ref(slot->pos).store(head, std::memory_order_release);
+  }
+
+  std::atomic_ref(shared->head).store(head, std::memory_order_release);
+  std::atomic_ref(shared->futex).fetch_add(1);
+
+  if (std::atomic_ref(shared->waiters).load())
+    kernel::futexWake(&shared->futex, INT_MAX, true);
+
+  return cnt;
+}
+
+static void shmem_bcast_wait_cleanup(void *p) {
+  auto *shared = (struct ShmemBroadcastShared *)p;
+
+  std::atomic_ref(shared->waiters).fetch_sub(1);
+}
+
+static void shmem_bcast_read_cleanup(void *p) {
+  auto *bc = (struct ShmemBroadcast *)p;
+
+  bc->active--;
+}
+
+static int shmem_bcast_read_active(struct ShmemBroadcast *bc,
+                                   struct Sample *const smps[], unsigned cnt) {
+  auto *shared = bc->shared;
+  unsigned i = 0;
+
+  while (true) {
+    uint32_t seq = std::atomic_ref(shared->futex).load();
+    uint64_t head =
+        std::atomic_ref(shared->head).load(std::memory_order_acquire);
+
+    // Skip samples which have already been overwritten
+    if (head - bc->cursor > shared->slots) {
+      bc->lost += head - shared->slots - bc->cursor;
+      bc->cursor = head - shared->slots;
+    }
+
+    for (; i < cnt && bc->cursor < head; bc->cursor++) {
+      auto *slot = shmem_bcast_slot(bc, bc->cursor);
+      auto *smp = smps[i];
+
+      uint64_t pos =
+          std::atomic_ref(slot->pos).load(std::memory_order_acquire);
+      if (pos != bc->cursor) {
+        bc->lost++;
+        continue;
+      }
+
+      smp->sequence = slot->sequence;
+      smp->ts.origin = slot->ts_origin;
+      smp->ts.received = slot->ts_received;
+      smp->flags = slot->flags;
+      smp->length = std::min(slot->length, smp->capacity);
+
+      memcpy(smp->data, slot->data, SAMPLE_DATA_LENGTH(smp->length));
+
+      // Discard the sample if the writer overwrote the slot meanwhile
+      std::atomic_thread_fence(std::memory_order_acquire);
+      pos = std::atomic_ref(slot->pos).load(std::memory_order_relaxed);
+      if (pos != bc->cursor) {
+        bc->lost++;
+        continue;
+      }
+
+      i++;
+    }
+
+    if (i > 0)
+      return i;
+
+    if (std::atomic_ref(shared->closed).load() || bc->closing)
+      return -1;
+
+    std::atomic_ref(shared->waiters).fetch_add(1);
+
+    // The wait is a cancellation point
+    pthread_cleanup_push(shmem_bcast_wait_cleanup, shared);
+    kernel::futexWait(&shared->futex, seq, true);
+    pthread_cleanup_pop(1);
+  }
+}
+
+int villas::node::shmem_bcast_read(struct ShmemBroadcast *bc,
+                                   struct Sample *const smps[], unsigned cnt) {
+  int ret;
+
+  // Keeps shmem_bcast_close() from removing the mapping while we read
+  bc->active++;
+  if (bc->closing) {
+    bc->active--;
+    return -1;
+  }
+
+  pthread_cleanup_push(shmem_bcast_read_cleanup, bc);
+  ret = shmem_bcast_read_active(bc, smps, cnt);
+  pthread_cleanup_pop(1);
+
+  return ret;
+}
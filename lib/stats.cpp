@@ -39,6 +39,30 @@ std::unordered_map<Stats::Metric, Stats::MetricDescription> Stats::metrics = {
      {"rtp.pkts_lost", "packets", "Cumulative number of packets lost"}},
     {Stats::Metric::RTP_JITTER,
      {"rtp.jitter", "seconds", "Interarrival jitter"}},
+    {Stats::Metric::SOCKET_BATCH_RECV,
+     {"socket.batch_recv", "datagrams",
+      "Number of datagrams received per recvmmsg() call or ring read"}},
+    {Stats::Metric::SOCKET_BATCH_SENT,
+     {"socket.batch_sent", "datagrams",
+      "Number of datagrams sent per sendmmsg() call or ring flush"}},
+    {Stats::Metric::FILE_WRITE_LATENCY,
+     {"file.write_latency", "seconds",
+      "Duration of write() calls of the asynchronous file writer"}},
+    {Stats::Metric::FILE_DROPPED,
+     {"file.dropped", "samples",
+      "Number of samples dropped due to a full write queue"}},
+    {Stats::Metric::INFLUXDB_DROPPED,
+     {"influxdb.dropped", "samples",
+      "Number of samples dropped due to a full send buffer"}},
+    {Stats::Metric::MQTT_DROPPED,
+     {"mqtt.dropped", "samples",
+      "Number of samples dropped due to a full queue or a failed publish"}},
+    {Stats::Metric::MQTT_QUEUED,
+     {"mqtt.queued", "samples",
+      "Number of samples waiting for the asynchronous publisher"}},
+    {Stats::Metric::MQTT_INFLIGHT,
+     {"mqtt.inflight", "messages",
+      "Number of published messages which have not been completed yet"}},
 };
 
 std::unordered_map<Stats::Type, Stats::TypeDescription> Stats::types = {
@@ -102,6 +126,13 @@ Stats::Stats(int buckets, int warmup) : logger(Log::get("stats")) {
 
 void Stats::update(enum Metric m, double val) { histograms[m].put(val); }
 
+void Stats::update(enum Metric m, const double vals[], unsigned cnt) {
+  auto &h = histograms[m];
+
+  for (unsigned i = 0; i < cnt; i++)
+    h.put(vals[i]);
+}
+
 void Stats::reset() {
   for (auto m : metrics)
     histograms[m.first].reset();
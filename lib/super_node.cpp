@@ -89,6 +89,7 @@ void SuperNode::parse(json_t *root) {
   json_t *json_paths = nullptr;
   json_t *json_logging = nullptr;
   json_t *json_http = nullptr;
+  json_t *json_scheduler = nullptr;
 
   json_error_t err;
 
@@ -96,12 +97,13 @@ void SuperNode::parse(json_t *root) {
 
   ret = json_unpack_ex(root, &err, 0,
                        "{ s?: F, s?: o, s?: o, s?: o, s?: o, s?: i, s?: i, s?: "
-                       "i, s?: b, s?: s, s?: i }",
+                       "i, s?: b, s?: s, s?: i, s?: o }",
                        "stats", &statsRate, "http", &json_http, "logging",
                        &json_logging, "nodes", &json_nodes, "paths",
                        &json_paths, "hugepages", &hugepages, "affinity",
                        &affinity, "priority", &priority, "idle_stop", &stop,
-                       "uuid", &uuid_str, "seed", &seed);
+                       "uuid", &uuid_str, "seed", &seed, "scheduler",
+                       &json_scheduler);
   if (ret)
     throw ConfigError(root, err, "node-config",
                       "Unpacking top-level config failed");
@@ -125,6 +127,9 @@ void SuperNode::parse(json_t *root) {
   if (json_logging)
     Log::getInstance().parse(json_logging);
 
+  if (json_scheduler)
+    scheduler.parse(json_scheduler);
+
   // Parse nodes
   if (json_nodes) {
     if (!json_is_object(json_nodes))
@@ -281,11 +286,13 @@ void SuperNode::startNodes() {
 }
 
 void SuperNode::startPaths() {
+  scheduler.start();
+
   for (auto *p : paths) {
     if (!p->isEnabled())
       continue;
 
-    p->start();
+    p->start(&scheduler);
   }
 }
 
@@ -367,6 +374,8 @@ void SuperNode::stopPaths() {
     if (p->getState() == State::STARTED || p->getState() == State::PAUSED)
       p->stop();
   }
+
+  scheduler.stop();
 }
 
 void SuperNode::stopNodes() {
@@ -461,6 +470,9 @@ int SuperNode::periodic() {
 #ifdef WITH_HOOKS
       p->hooks.periodic();
 #endif // WITH_HOOKS
+
+      if (p->trace)
+        p->trace->printPeriodic(p->logger);
     }
   }
 
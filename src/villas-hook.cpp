@@ -15,6 +15,7 @@
 #include <villas/exceptions.hpp>
 #include <villas/format.hpp>
 #include <villas/hook.hpp>
+#include <villas/hook_list.hpp>
 #include <villas/kernel/rt.hpp>
 #include <villas/log.hpp>
 #include <villas/node/config.hpp>
@@ -191,7 +192,7 @@ protected:
   }
 
   int main() override {
-    int ret, recv, sent;
+    int ret, recv, send, sent;
     struct Sample *smps[cnt];
 
     if (cnt < 1)
@@ -238,6 +239,9 @@ protected:
     h->prepare(input->getSignals());
     h->start();
 
+    HookList hooks;
+    hooks.push_back(h);
+
     while (!stop && !feof(stdin)) {
       ret = sample_alloc_many(&p, smps, cnt);
       if (ret != cnt)
@@ -251,36 +255,20 @@ protected:
 
       logger->debug("Read {} smps from stdin", recv);
 
-      unsigned send = 0;
-      for (int processed = 0; processed < recv; processed++) {
-        struct Sample *smp = smps[processed];
+      for (int i = 0; i < recv; i++) {
+        struct Sample *smp = smps[i];
 
         if (!(smp->flags & (int)SampleFlags::HAS_TS_RECEIVED)) {
           smp->ts.received = now;
           smp->flags |= (int)SampleFlags::HAS_TS_RECEIVED;
         }
-
-        auto ret = h->process(smp);
-        switch (ret) {
-          using Reason = node::Hook::Reason;
-        case Reason::ERROR:
-          throw RuntimeError("Failed to process samples");
-
-        case Reason::OK:
-          smps[send++] = smp;
-          break;
-
-        case Reason::SKIP_SAMPLE:
-          break;
-
-        case Reason::STOP_PROCESSING:
-          goto stop;
-        }
-
-        smp->signals = h->getSignals();
       }
 
-    stop:
+      // Process the whole vector at once, like paths and nodes do
+      send = hooks.process(smps, recv);
+      if (send < 0)
+        throw RuntimeError("Failed to process samples");
+
       sent = output->print(stdout, smps, send);
       if (sent < 0)
         throw RuntimeError("Failed to write to stdout");
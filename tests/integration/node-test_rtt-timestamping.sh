@@ -0,0 +1,114 @@
+#!/usr/bin/env bash
+#
+# Integration test for wire-to-wire round-trip measurements using kernel timestamps.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+RATE=${RATE:-100}
+
+mkdir ./logs
+
+# Samples of the test_rtt node are sent by udp1, echoed by udp2 and received by udp1 again.
+cat > config.json << EOF
+{
+    "nodes": {
+        "rtt": {
+            "type": "test_rtt",
+            "output": "./logs",
+            "prefix": "rtt",
+            "shutdown": true,
+            "duration": $(( NUM_SAMPLES / RATE )),
+            "tx_timestamps": "udp1",
+            "cases": [
+                {
+                    "rates": ${RATE},
+                    "values": 4,
+                    "count": ${NUM_SAMPLES}
+                }
+            ]
+        },
+        "udp1": {
+            "type": "socket",
+            "layer": "udp",
+            "timestamping": {
+                "rx": true,
+                "tx": true
+            },
+            "in": {
+                "address": "127.0.0.1:12000",
+                "signals": {
+                    "count": 4,
+                    "type": "float"
+                }
+            },
+            "out": {
+                "address": "127.0.0.1:12001"
+            }
+        },
+        "udp2": {
+            "type": "socket",
+            "layer": "udp",
+            "in": {
+                "address": "127.0.0.1:12001",
+                "signals": {
+                    "count": 4,
+                    "type": "float"
+                }
+            },
+            "out": {
+                "address": "127.0.0.1:12000"
+            }
+        }
+    },
+    "paths": [
+        {
+            "in": "rtt",
+            "out": "udp1"
+        },
+        {
+            "in": "udp1",
+            "out": "rtt"
+        },
+        {
+            "in": "udp2",
+            "out": "udp2"
+        }
+    ]
+}
+EOF
+
+timeout 60 villas node config.json 2>&1 | tee node.log
+
+if grep -q "without a TX timestamp" node.log; then
+    echo "Some samples have been received without a TX timestamp"
+    exit 1
+fi
+
+# Each line starts with the origin timestamp followed by the round-trip time as offset
+grep -hv '^#' logs/rtt_values4_rate${RATE}.log | sed -E 's/^[0-9]+\.[0-9]+([+-][0-9.e+-]+)\(.*/\1/' > rtts.dat
+
+RECEIVED=$(wc -l < rtts.dat)
+if (( RECEIVED < NUM_SAMPLES * 9 / 10 )); then
+    echo "Received only ${RECEIVED} of ${NUM_SAMPLES} samples"
+    exit 1
+fi
+
+# Kernel TX timestamps are taken before the RX timestamps of the echoed samples
+if ! awk '{ if ($1 < 0 || $1 > 1) exit 1 }' rtts.dat; then
+    echo "Invalid round-trip times"
+    exit 1
+fi
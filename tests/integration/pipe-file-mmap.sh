@@ -0,0 +1,110 @@
+#!/usr/bin/env bash
+#
+# Integration test for replaying memory-mapped files with villas pipe.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+
+# Generate $2 samples at a rate of 10 per second, starting at second $1
+function generate() {
+    for ((i = 0; i < $2; i++)); do
+        printf "%d.%09d(%d)\t%d.0\n" $(( $1 + i / 10 )) $(( (i % 10) * 100000000 )) ${i} ${i}
+    done
+}
+
+# Replay $2 samples from file.dat, optionally starting at second $1
+function replay() {
+    if [ -n "$1" ]; then
+        SEEK=", \"seek\": $1"
+    else
+        SEEK=""
+    fi
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "file",
+
+            "uri": "file.dat",
+
+            "in": {
+                "epoch_mode": "original",
+                "eof": "stop",
+                "mmap": true,
+                "index": true${SEEK}
+            }
+        }
+    }
+}
+EOF
+
+villas pipe -r -l $2 config.json node1 > output.dat 2> pipe.log
+}
+
+generate 1000 ${NUM_SAMPLES} > file.dat
+
+# The first replay builds and stores the index
+replay "" ${NUM_SAMPLES}
+villas compare file.dat output.dat
+
+if [ ! -f file.dat.idx ]; then
+    echo "Index has not been stored"
+    exit 1
+fi
+
+# The second replay uses the stored index
+replay "" ${NUM_SAMPLES}
+villas compare file.dat output.dat
+
+if ! grep -q "Loaded index" pipe.log; then
+    echo "Stored index has not been used"
+    exit 1
+fi
+
+# Start at the first sample at or after the seek position
+replay 1005.05 $(( NUM_SAMPLES - 51 ))
+tail -n +52 file.dat > expected.dat
+villas compare expected.dat output.dat
+
+# An index is stale if the size of the file changed
+NUM_SAMPLES=$(( NUM_SAMPLES + 20 ))
+generate 1000 ${NUM_SAMPLES} > file.dat
+
+replay 1005.05 $(( NUM_SAMPLES - 51 ))
+tail -n +52 file.dat > expected.dat
+villas compare expected.dat output.dat
+
+if ! grep -q "Ignoring outdated index" pipe.log; then
+    echo "Outdated index has not been detected"
+    exit 1
+fi
+
+# An index is stale if only the modification time of the file changed.
+# The timestamps of the samples differ, but not the size of the file.
+generate 2000 ${NUM_SAMPLES} > file.dat.new
+touch -d @1000000000 file.dat.new
+mv file.dat.new file.dat
+
+replay 2005.05 $(( NUM_SAMPLES - 51 ))
+tail -n +52 file.dat > expected.dat
+villas compare expected.dat output.dat
+
+if ! grep -q "Ignoring outdated index" pipe.log; then
+    echo "Outdated index has not been detected"
+    exit 1
+fi
@@ -18,6 +18,7 @@ function finish {
 trap finish EXIT
 
 NUM_SAMPLES=${NUM_SAMPLES:-100}
+NUM_VALUES=${NUM_VALUES:-4}
 FORMAT="villas.human"
 
 cat > config.json << EOF
@@ -40,3 +41,67 @@ villas signal -l ${NUM_SAMPLES} -n random > input.dat
 villas pipe -l ${NUM_SAMPLES} config.json node1 > output.dat < input.dat
 
 villas compare input.dat output.dat
+
+# Exchange samples with villas shmem via shared memory.
+# The names of the shared memory objects are expanded by the shell of the sub-process.
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+             "type": "exec",
+             "ipc": "shmem",
+
+             "shell": true,
+
+             "exec": "villas shmem \${VILLAS_SHMEM_WNAME} \${VILLAS_SHMEM_RNAME} 1",
+
+             "in": {
+                 "signals": {
+                     "count": ${NUM_VALUES},
+                     "type": "float"
+                 }
+             }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 > output.dat < input.dat
+
+villas compare input.dat output.dat
+
+# The node must fail to start if the sub-process never opens the interface
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+             "type": "exec",
+             "ipc": "shmem",
+             "timeout": 1,
+
+             "exec": [ "sleep", "30" ],
+
+             "in": {
+                 "signals": {
+                     "count": ${NUM_VALUES},
+                     "type": "float"
+                 }
+             }
+        }
+    }
+}
+EOF
+
+SECONDS=0
+
+if timeout 20 villas pipe -l ${NUM_SAMPLES} config.json node1 > output.dat < input.dat; then
+    echo "Node started although the sub-process did not open the interface"
+    exit 1
+fi
+
+if (( SECONDS > 10 )); then
+    echo "Node did not respect the timeout"
+    exit 1
+fi
@@ -18,6 +18,7 @@ function finish {
 trap finish EXIT
 
 NUM_SAMPLES=${NUM_SAMPLES:-10}
+NUM_SAMPLES_ASYNC=${NUM_SAMPLES_ASYNC:-1000}
 
 cat > config.json << EOF
 {
@@ -44,3 +45,37 @@ villas signal -l ${NUM_SAMPLES} -n random > input.dat
 villas pipe -l ${NUM_SAMPLES} config.json node1 > output.dat < input.dat
 
 villas compare input.dat output.dat
+
+# The asynchronous writer spans multiple chunks and must have written all
+# queued samples once the node has been stopped
+villas signal -l ${NUM_SAMPLES_ASYNC} -n random > input-async.dat
+
+for DIRECT in false true; do
+
+rm -f file-async.dat
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "file",
+
+            "uri": "file-async.dat",
+
+            "out": {
+                "async": true,
+                "direct": ${DIRECT},
+                "chunk_size": 4096,
+                "queuelen": 64,
+                "overflow": "block"
+            }
+        }
+    }
+}
+EOF
+
+villas pipe -s -L ${NUM_SAMPLES_ASYNC} config.json node1 < input-async.dat
+
+villas compare input-async.dat file-async.dat
+
+done
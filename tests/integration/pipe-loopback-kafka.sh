@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using Kafka.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+HOST="localhost"
+
+if [ -n "${CI}" ]; then
+    HOST="kafka"
+fi
+
+if ! timeout 1 bash -c "exec 3<>/dev/tcp/${HOST}/9092" 2> /dev/null; then
+    echo "No Kafka broker available"
+    exit 99
+fi
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    kill %% 2> /dev/null || true
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+TIMEOUT=${TIMEOUT:-30}
+
+# Sequence number of warm-up samples which are removed from the output
+MARKER=999999
+
+villas signal -l ${NUM_SAMPLES} -n random > input.dat
+
+function received() {
+    grep -v -e '^#' -e "(${MARKER})" output.dat | wc -l
+}
+
+# Send samples over a new topic and compare them with the received ones.
+# $1: Number of samples per write
+# $2: Additional settings of the consumer
+# $3: Additional settings of the producer
+function loopback() {
+    local TOPIC="villas-test-${RANDOM}"
+    local DEADLINE=$(( SECONDS + TIMEOUT ))
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "rx": {
+            "type": "kafka",
+            "format": "villas.human",
+            "server": "${HOST}:9092",
+            "timeout": 5.0,
+
+            "in": {
+                "consume": "${TOPIC}",
+                "group_id": "${TOPIC}"$2
+            }
+        },
+        "tx": {
+            "type": "kafka",
+            "format": "villas.human",
+            "server": "${HOST}:9092",
+            "timeout": 5.0,
+
+            "out": {
+                "produce": "${TOPIC}",
+                "vectorize": $1$3
+            }
+        }
+    }
+}
+EOF
+
+    # A whole write of warm-up samples
+    grep -v '^#' input.dat | head -n 1 | sed "s/([0-9]*)/(${MARKER})/" > marker.dat
+    for ((i = 0; i < $1; i++)); do
+        cat marker.dat
+    done > warmup.dat
+
+    rm -f output.dat
+    touch output.dat
+
+    stdbuf -oL villas pipe -r config.json rx > output.dat &
+
+    # New consumer groups start at the end of the topic.
+    # So we send warm-up samples until the consumer got its assignment.
+    {
+        while ! grep -q "(${MARKER})" output.dat && (( SECONDS < DEADLINE )); do
+            cat warmup.dat
+            sleep 0.5
+        done
+
+        # Pace the samples, so that buffers are returned by delivery reports
+        while read -r LINE; do
+            echo "${LINE}"
+            sleep 0.01
+        done < input.dat
+    } | villas pipe -s config.json tx
+
+    while (( $(received) < NUM_SAMPLES )); do
+        if (( SECONDS >= DEADLINE )); then
+            echo "Received only $(received) of ${NUM_SAMPLES} samples"
+            exit 1
+        fi
+
+        sleep 0.1
+    done
+
+    kill %%
+    wait %% || true
+
+    # Samples of different partitions might be received out of order
+    (
+        grep '^#' output.dat
+        grep -v -e '^#' -e "(${MARKER})" output.dat | sort -t '(' -k 2 -n
+    ) > received.dat
+
+    villas compare input.dat received.dat
+}
+
+# A single consumer and a message per write
+loopback 1 "" ""
+
+# Multiple consumers and a message per sample, which are produced in batches.
+# Fewer buffers than samples require the delivery reports to return them.
+loopback 10 ', "consumers": 4, "batch": 16' ', "batch": true, "buffers": 32'
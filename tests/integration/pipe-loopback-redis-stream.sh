@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using Redis streams.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+HOST="localhost"
+
+if [ -n "${CI}" ]; then
+    HOST="redis"
+fi
+
+# Send an inline command without depending on redis-cli
+function redis_cmd() {
+    exec 3<>/dev/tcp/${HOST}/6379 || return 1
+    printf '%s\r\n' "$*" >&3
+    timeout 1 head -n1 <&3
+    exec 3>&-
+}
+
+if ! redis_cmd PING 2> /dev/null | grep -q PONG; then
+    echo "No Redis server available"
+    exit 99
+fi
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+KEY="villas-test-${RANDOM}"
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "redis",
+            "format": "villas.human",
+            "mode": "stream",
+            "key": "${KEY}",
+            "uri": "tcp://${HOST}:6379/0",
+
+            "in": {
+                "vectorize": 10
+            },
+            "out": {
+                "vectorize": 10
+            }
+        }
+    }
+}
+EOF
+
+villas signal -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+redis_cmd DEL ${KEY} > /dev/null
+
+villas compare input.dat output.dat
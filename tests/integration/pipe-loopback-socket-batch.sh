@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using batched system calls of the socket node-type.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+NUM_VALUES=${NUM_VALUES:-4}
+FORMAT=${FORMAT:-villas.binary}
+
+# A vectorize larger than 64 is split into several sendmmsg() calls
+for VECTORIZE in 1 10 100; do
+for TX_TIMESTAMPS in false true; do
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "socket",
+
+            "vectorize": ${VECTORIZE},
+            "format": "${FORMAT}",
+            "layer": "udp",
+            "batch": true,
+
+            "timestamping": {
+                "tx": ${TX_TIMESTAMPS}
+            },
+
+            "out": {
+                "address": "127.0.0.1:12000"
+            },
+            "in": {
+                "address": "127.0.0.1:12000",
+                "signals": {
+                    "count": ${NUM_VALUES},
+                    "type": "float"
+                }
+            }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+villas compare input.dat output.dat
+
+done; done
@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using UDP GSO / GRO of the socket node-type.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+NUM_VALUES=${NUM_VALUES:-4}
+FORMAT=${FORMAT:-villas.binary}
+
+# Coalesced datagrams are split at the segment size by either the kernel or the receiver
+for GSO_GRO in "true false" "false true" "true true"; do
+read GSO GRO <<< "${GSO_GRO}"
+
+for VECTORIZE in 1 10 64; do
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "socket",
+
+            "vectorize": ${VECTORIZE},
+            "format": "${FORMAT}",
+            "layer": "udp",
+            "batch": true,
+
+            "out": {
+                "address": "127.0.0.1:12000",
+                "gso": ${GSO}
+            },
+            "in": {
+                "address": "127.0.0.1:12000",
+                "gro": ${GRO},
+                "signals": {
+                    "count": ${NUM_VALUES},
+                    "type": "float"
+                }
+            }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+villas compare input.dat output.dat
+
+done; done
@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using the packet_mmap backend of the socket node-type.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+if [ "${EUID}" -ne 0 ]; then
+    echo "Test requires root permissions"
+    exit 99
+fi
+
+IF_TX="vl-tx$$"
+IF_RX="vl-rx$$"
+
+if ! ip link add ${IF_TX} type veth peer name ${IF_RX} 2> /dev/null; then
+    echo "Failed to create veth pair"
+    exit 99
+fi
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+
+    ip link delete ${IF_TX}
+}
+trap finish EXIT
+
+ip link set ${IF_TX} up
+ip link set ${IF_RX} up
+
+MAC_RX=$(cat /sys/class/net/${IF_RX}/address)
+
+NUM_VALUES=${NUM_VALUES:-4}
+FORMAT=${FORMAT:-villas.binary}
+
+# Frames are sent over one end of the veth pair and received by the RX ring
+# on the other end. A few samples only fill a fraction of the first block,
+# which must be handed over by its retire timeout. More samples span
+# multiple blocks of the ring.
+for NUM_SAMPLES in 5 2000; do
+for VECTORIZE in 1 32; do
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "socket",
+
+            "vectorize": ${VECTORIZE},
+            "format": "${FORMAT}",
+            "layer": "eth",
+            "io_backend": "packet_mmap",
+
+            "out": {
+                "address": "${MAC_RX}%${IF_TX}:34997"
+            },
+            "in": {
+                "address": "${MAC_RX}%${IF_RX}:34997",
+                "signals": {
+                    "count": ${NUM_VALUES},
+                    "type": "float"
+                }
+            }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+timeout 10 villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+villas compare input.dat output.dat
+
+done; done
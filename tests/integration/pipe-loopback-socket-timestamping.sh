@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using kernel timestamps of the socket node-type.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+NUM_VALUES=${NUM_VALUES:-4}
+
+for BATCH in false true; do
+
+# Received samples carry the same sequence numbers as the sent ones.
+# Their origin timestamps must not be replaced by the TX timestamps.
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "socket",
+            "layer": "udp",
+            "batch": ${BATCH},
+
+            "timestamping": {
+                "rx": true,
+                "tx": true
+            },
+
+            "out": {
+                "address": "127.0.0.1:12000"
+            },
+            "in": {
+                "address": "127.0.0.1:12000",
+                "signals": {
+                    "count": ${NUM_VALUES},
+                    "type": "float"
+                }
+            }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+villas compare input.dat output.dat
+
+done
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+#
+# Integration loopback test for villas pipe using the io_uring backend of the socket node-type.
+#
+# Author: Steffen Vogel <post@steffenvogel.de>
+# SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+# SPDX-License-Identifier: Apache-2.0
+
+set -e
+
+if ! grep -q "^WITH_LIBURING:BOOL=ON$" ${BUILDDIR}/CMakeCache.txt 2> /dev/null; then
+    echo "VILLASnode has been built without io_uring support"
+    exit 99
+fi
+
+DIR=$(mktemp -d)
+pushd ${DIR}
+
+function finish {
+    popd
+    rm -rf ${DIR}
+}
+trap finish EXIT
+
+NUM_SAMPLES=${NUM_SAMPLES:-100}
+NUM_VALUES=${NUM_VALUES:-4}
+FORMAT=${FORMAT:-villas.binary}
+
+for VECTORIZE in 1 10; do
+
+cat > config.json << EOF
+{
+    "nodes": {
+        "node1": {
+            "type": "socket",
+
+            "vectorize": ${VECTORIZE},
+            "format": "${FORMAT}",
+            "layer": "udp",
+            "io_backend": "io_uring",
+
+            "out": {
+                "address": "127.0.0.1:12000"
+            },
+            "in": {
+                "address": "127.0.0.1:12000",
+                "signals": {
+                    "count": ${NUM_VALUES},
+                    "type": "float"
+                }
+            }
+        }
+    }
+}
+EOF
+
+villas signal -v ${NUM_VALUES} -l ${NUM_SAMPLES} -n random > input.dat
+
+villas pipe -l ${NUM_SAMPLES} config.json node1 < input.dat > output.dat
+
+villas compare input.dat output.dat
+
+done
@@ -22,6 +22,8 @@ NUM_SAMPLES=${NUM_SAMPLES:-10}
 VECTORIZE="10"
 FORMAT="protobuf"
 
+for MULTIPART in false true; do
+
 cat > config.json << EOF
 {
     "nodes": {
@@ -32,7 +34,8 @@ cat > config.json << EOF
             "vectorize": ${VECTORIZE},
             "pattern": "pubsub",
             "out": {
-                "publish": "tcp://127.0.0.1:12000"
+                "publish": "tcp://127.0.0.1:12000",
+                "multipart": ${MULTIPART}
             },
             "in": {
                 "subscribe": "tcp://127.0.0.1:12000",
@@ -51,3 +54,5 @@ villas signal -l ${NUM_SAMPLES} -n -v 5 random > input.dat
 villas pipe -l ${NUM_SAMPLES} config.json node1 > output.dat < input.dat
 
 villas compare input.dat output.dat
+
+done
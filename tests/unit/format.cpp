@@ -423,3 +423,77 @@ ParameterizedTest(Param *p, format, highlevel, .init = init_memory) {
   ret = pool_destroy(&pool);
   cr_assert_eq(ret, 0);
 }
+
+Test(format, influxdb, .init = init_memory) {
+  int ret;
+  char buf[1024];
+  size_t wbytes;
+
+  json_t *json_signals = json_loads(
+      "[ { \"name\": \"a b\", \"type\": \"float\" },"
+      "  { \"name\": \"c,d\", \"type\": \"integer\" },"
+      "  { \"name\": \"e=f\", \"type\": \"boolean\" },"
+      "  { \"name\": \"z\", \"type\": \"complex\" },"
+      "  { \"name\": \"nan\", \"type\": \"float\" } ]",
+      0, nullptr);
+  cr_assert_not_null(json_signals);
+
+  auto signals = std::make_shared<SignalList>(json_signals);
+
+  json_t *json_format =
+      json_loads("{ \"type\": \"influxdb\", \"key\": \"meas,tag=a\" }", 0,
+                 nullptr);
+  cr_assert_not_null(json_format);
+
+  Format *fmt = FormatFactory::make(json_format);
+  cr_assert_not_null(fmt);
+
+  fmt->start(signals, (int)SampleFlags::ALL);
+
+  struct Sample *smps[2];
+  for (unsigned i = 0; i < 2; i++) {
+    smps[i] = sample_alloc_mem(signals->size());
+    smps[i]->length = signals->size();
+    smps[i]->signals = signals;
+    smps[i]->flags = (int)SampleFlags::HAS_DATA |
+                     (int)SampleFlags::HAS_TS_ORIGIN;
+    smps[i]->ts.origin = {1234567890, 123};
+  }
+
+  smps[0]->data[0].f = 1.5;
+  smps[0]->data[1].i = -42;
+  smps[0]->data[2].b = true;
+  smps[0]->data[3].z = std::complex<float>(0.25, -2);
+  smps[0]->data[4].f = NAN;
+
+  // Lines without a single finite value are omitted
+  smps[1]->data[0].f = INFINITY;
+  smps[1]->data[1].i = 0;
+  smps[1]->data[2].b = false;
+  smps[1]->data[3].z = std::complex<float>(NAN, 0);
+  smps[1]->data[4].f = -0.125;
+  smps[1]->flags &= ~(int)SampleFlags::HAS_TS_ORIGIN;
+
+  const char *expected =
+      "meas,tag=a a\\ b=1.5,c\\,d=-42,e\\=f=true,z_re=0.25,z_im=-2 "
+      "1234567890000000123\n"
+      "meas,tag=a c\\,d=0,e\\=f=false,nan=-0.125\n";
+
+  ret = fmt->sprint(buf, sizeof(buf), &wbytes, smps, 2);
+  cr_assert_eq(ret, 2);
+  cr_assert_eq(wbytes, strlen(expected));
+  cr_assert_arr_eq(buf, expected, wbytes, "Unexpected lines: %.*s",
+                   (int)wbytes, buf);
+
+  // The required size is reported if the lines do not fit
+  ret = fmt->sprint(buf, 16, &wbytes, smps, 2);
+  cr_assert_eq(ret, 1);
+  cr_assert_eq(wbytes, (size_t)(strchr(expected, '\n') - expected + 1));
+
+  delete fmt;
+
+  sample_free_many(smps, 2);
+
+  json_decref(json_format);
+  json_decref(json_signals);
+}
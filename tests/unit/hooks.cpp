@@ -0,0 +1,278 @@
+/* Unit tests for batched hook processing.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <criterion/criterion.h>
+#include <criterion/parameterized.h>
+#include <unistd.h>
+
+#include <villas/hook.hpp>
+#include <villas/plugin.hpp>
+#include <villas/pool.hpp>
+#include <villas/sample.hpp>
+#include <villas/signal.hpp>
+
+using namespace villas;
+using namespace villas::node;
+
+extern void init_memory();
+
+#define NUM_VALUES 4
+
+using string =
+    std::basic_string<char, std::char_traits<char>, criterion::allocator<char>>;
+
+struct Param {
+public:
+  Param(const char *n, const char *c) : name(n), config(c) {}
+
+  string name;
+  string config;
+};
+
+// Batches of different sizes carry the state of stateful hooks across calls
+static const unsigned batches[] = {1, 7, 16, 3, 12};
+
+static Hook::Ptr make_hook(const char *name, json_t *json,
+                           SignalList::Ptr signals) {
+  auto hf = plugin::registry->lookup<HookFactory>(name);
+  cr_assert_not_null(hf, "Unknown hook %s", name);
+
+  auto h = hf->make(nullptr, nullptr);
+  cr_assert_not_null(h);
+
+  h->parse(json);
+  h->check();
+  h->prepare(signals);
+  h->start();
+
+  return h;
+}
+
+static void fill_samples(SignalList::Ptr signals, struct Sample *smps[],
+                         unsigned cnt, unsigned offset) {
+  for (unsigned i = 0; i < cnt; i++) {
+    struct Sample *smp = smps[i];
+    unsigned k = offset + i;
+
+    smp->flags = (int)SampleFlags::HAS_SEQUENCE | (int)SampleFlags::HAS_DATA |
+                 (int)SampleFlags::HAS_TS_ORIGIN |
+                 (int)SampleFlags::HAS_TS_RECEIVED;
+    smp->length = NUM_VALUES;
+    smp->sequence = k;
+    smp->signals = signals;
+    smp->ts.origin = {1000 + k / 10, (long)(k % 10) * 100000000};
+    smp->ts.received = {1000 + k / 10, (long)(k % 10) * 100000000 + 5000};
+
+    for (unsigned j = 0; j < NUM_VALUES; j++)
+      smp->data[j].f = std::sin(k * 0.3 + j) * (j + 1);
+  }
+}
+
+static void compare_samples(SignalList::Ptr signals, struct Sample *a,
+                            struct Sample *b) {
+  cr_assert_eq(a->length, b->length);
+  cr_assert_eq(a->sequence, b->sequence);
+
+  for (unsigned j = 0; j < a->length; j++) {
+    switch (signals->getByIndex(j)->type) {
+    case SignalType::FLOAT:
+      cr_assert_float_eq(a->data[j].f, b->data[j].f, 1e-9,
+                         "Sample data mismatch at index %u: %f != %f", j,
+                         a->data[j].f, b->data[j].f);
+      break;
+
+    case SignalType::INTEGER:
+      cr_assert_eq(a->data[j].i, b->data[j].i,
+                   "Sample data mismatch at index %u", j);
+      break;
+
+    case SignalType::BOOLEAN:
+      cr_assert_eq(a->data[j].b, b->data[j].b,
+                   "Sample data mismatch at index %u", j);
+      break;
+
+    default: {
+    }
+    }
+  }
+}
+
+// cppcheck-suppress unknownMacro
+ParameterizedTestParameters(hooks, process_many) {
+  static criterion::parameters<Param> params;
+
+  params.emplace_back("scale", "{ \"signals\": [ \"signal0\", \"signal2\" ], "
+                               "\"scale\": 2.5, \"offset\": -1.0 }");
+  params.emplace_back("cast", "{ \"signals\": [ \"signal1\" ], "
+                              "\"new_type\": \"integer\" }");
+  params.emplace_back("round", "{ \"signals\": [ \"signal0\", \"signal1\", "
+                               "\"signal3\" ], \"precision\": 2 }");
+  params.emplace_back("limit_value",
+                      "{ \"signals\": [ \"signal1\", \"signal3\" ], "
+                      "\"min\": -1.5, \"max\": 0.5 }");
+  params.emplace_back("ma", "{ \"signals\": [ \"signal0\", \"signal3\" ], "
+                            "\"window_size\": 5 }");
+  params.emplace_back("rms", "{ \"signals\": [ \"signal2\" ], "
+                             "\"window_size\": 6 }");
+
+  return params;
+}
+
+// A batch processed by processMany() must equal the same samples processed
+// one by one by process()
+ParameterizedTest(Param *p, hooks, process_many, .init = init_memory) {
+  int ret;
+  struct Pool pool;
+  json_error_t err;
+
+  auto signals = std::make_shared<SignalList>(NUM_VALUES, SignalType::FLOAT);
+
+  ret = pool_init(&pool, 64, SAMPLE_LENGTH(NUM_VALUES));
+  cr_assert_eq(ret, 0);
+
+  json_t *json = json_loads(p->config.c_str(), 0, &err);
+  cr_assert_not_null(json);
+
+  auto single = make_hook(p->name.c_str(), json, signals);
+  auto batch = make_hook(p->name.c_str(), json, signals);
+
+  unsigned offset = 0;
+  for (auto cnt : batches) {
+    struct Sample *smps[cnt], *smpt[cnt];
+    Hook::Reason reasons[cnt];
+
+    ret = sample_alloc_many(&pool, smps, cnt);
+    cr_assert_eq(ret, (int)cnt);
+
+    ret = sample_alloc_many(&pool, smpt, cnt);
+    cr_assert_eq(ret, (int)cnt);
+
+    fill_samples(signals, smps, cnt, offset);
+    fill_samples(signals, smpt, cnt, offset);
+
+    auto r = batch->processMany(smpt, cnt, reasons);
+    cr_assert_neq(r, Hook::Reason::ERROR);
+
+    for (unsigned i = 0; i < cnt; i++) {
+      r = single->process(smps[i]);
+      cr_assert_eq(r, reasons[i], "Reason mismatch for sample %u", i);
+
+      compare_samples(single->getSignals(), smps[i], smpt[i]);
+    }
+
+    sample_free_many(smps, cnt);
+    sample_free_many(smpt, cnt);
+
+    offset += cnt;
+  }
+
+  single->stop();
+  batch->stop();
+
+  json_decref(json);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0);
+}
+
+static std::string read_file(const char *path) {
+  std::ifstream f(path);
+  std::stringstream ss;
+
+  ss << f.rdbuf();
+
+  return ss.str();
+}
+
+// The statistics collected from batches must equal those of single samples
+Test(hooks, stats_process_many, .init = init_memory) {
+  int ret;
+  struct Pool pool;
+  char path_single[] = "/tmp/villas-unit-test-stats-XXXXXX";
+  char path_batch[] = "/tmp/villas-unit-test-stats-XXXXXX";
+
+  auto signals = std::make_shared<SignalList>(NUM_VALUES, SignalType::FLOAT);
+
+  ret = pool_init(&pool, 64, SAMPLE_LENGTH(NUM_VALUES));
+  cr_assert_eq(ret, 0);
+
+  ret = mkstemp(path_single);
+  cr_assert_geq(ret, 0);
+  close(ret);
+
+  ret = mkstemp(path_batch);
+  cr_assert_geq(ret, 0);
+  close(ret);
+
+  json_t *json_single =
+      json_pack("{ s: s, s: i, s: i, s: s }", "format", "json", "warmup", 10,
+                "buckets", 10, "output", path_single);
+  json_t *json_batch =
+      json_pack("{ s: s, s: i, s: i, s: s }", "format", "json", "warmup", 10,
+                "buckets", 10, "output", path_batch);
+
+  auto single = make_hook("stats", json_single, signals);
+  auto batch = make_hook("stats", json_batch, signals);
+
+  unsigned offset = 0;
+  for (auto cnt : batches) {
+    struct Sample *smps[cnt], *smpt[cnt];
+    Hook::Reason reasons[cnt];
+
+    ret = sample_alloc_many(&pool, smps, cnt);
+    cr_assert_eq(ret, (int)cnt);
+
+    ret = sample_alloc_many(&pool, smpt, cnt);
+    cr_assert_eq(ret, (int)cnt);
+
+    fill_samples(signals, smps, cnt, offset);
+    fill_samples(signals, smpt, cnt, offset);
+
+    // Introduce a gap in the sequence numbers
+    if (offset > 0) {
+      smps[0]->sequence++;
+      smpt[0]->sequence++;
+    }
+
+    auto r = batch->processMany(smpt, cnt, reasons);
+    cr_assert_eq(r, Hook::Reason::OK);
+
+    for (unsigned i = 0; i < cnt; i++) {
+      r = single->process(smps[i]);
+      cr_assert_eq(r, reasons[i]);
+    }
+
+    sample_free_many(smps, cnt);
+    sample_free_many(smpt, cnt);
+
+    offset += cnt;
+  }
+
+  // Statistics are written to the output files when the hooks are stopped
+  single->stop();
+  batch->stop();
+
+  auto stats_single = read_file(path_single);
+  auto stats_batch = read_file(path_batch);
+
+  cr_assert_gt(stats_single.size(), 0);
+  cr_assert_str_eq(stats_single.c_str(), stats_batch.c_str());
+
+  unlink(path_single);
+  unlink(path_batch);
+
+  json_decref(json_single);
+  json_decref(json_batch);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0);
+}
@@ -0,0 +1,131 @@
+/* Unit tests for the influxdb node-type.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <criterion/criterion.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <villas/node.hpp>
+#include <villas/pool.hpp>
+#include <villas/sample.hpp>
+#include <villas/signal_list.hpp>
+#include <villas/timing.hpp>
+
+using namespace villas::node;
+
+extern void init_memory();
+
+#define NUM_SAMPLES 100
+#define NUM_VALUES 4
+#define BATCH_SIZE 256
+
+// cppcheck-suppress unknownMacro
+Test(influxdb, udp_datagrams, .init = init_memory) {
+  int ret, sd;
+  struct Pool pool;
+  struct sockaddr_in sin = {};
+  socklen_t sinlen = sizeof(sin);
+
+  // Server which receives the datagrams on a free port
+  sd = socket(AF_INET, SOCK_DGRAM, 0);
+  cr_assert_geq(sd, 0);
+
+  sin.sin_family = AF_INET;
+  sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  ret = bind(sd, (struct sockaddr *)&sin, sizeof(sin));
+  cr_assert_eq(ret, 0);
+
+  ret = getsockname(sd, (struct sockaddr *)&sin, &sinlen);
+  cr_assert_eq(ret, 0);
+
+  // All samples are encoded at once and exceed a single datagram
+  json_t *json = json_pack(
+      "{ s: s, s: s, s: s, s: s, s: i, s: f, s: { s: i } }", "type",
+      "influxdb", "server",
+      fmt::format("127.0.0.1:{}", ntohs(sin.sin_port)).c_str(), "key", "meas",
+      "protocol", "udp", "batch_size", BATCH_SIZE, "batch_timeout", 10.0, "out",
+      "vectorize", NUM_SAMPLES);
+  cr_assert_not_null(json);
+
+  uuid_t uuid = {};
+  auto *n = NodeFactory::make("influxdb", uuid, "influxdb");
+  cr_assert_not_null(n);
+
+  ret = n->parse(json);
+  cr_assert_eq(ret, 0);
+
+  ret = n->check();
+  cr_assert_eq(ret, 0);
+
+  ret = n->prepare();
+  cr_assert_eq(ret, 0);
+
+  ret = n->start();
+  cr_assert_eq(ret, 0);
+
+  ret = pool_init(&pool, NUM_SAMPLES, SAMPLE_LENGTH(NUM_VALUES));
+  cr_assert_eq(ret, 0);
+
+  auto signals = std::make_shared<SignalList>(NUM_VALUES, SignalType::FLOAT);
+
+  struct Sample *smps[NUM_SAMPLES];
+  ret = sample_alloc_many(&pool, smps, NUM_SAMPLES);
+  cr_assert_eq(ret, NUM_SAMPLES);
+
+  for (unsigned i = 0; i < NUM_SAMPLES; i++) {
+    smps[i]->flags =
+        (int)SampleFlags::HAS_DATA | (int)SampleFlags::HAS_TS_ORIGIN;
+    smps[i]->length = NUM_VALUES;
+    smps[i]->signals = signals;
+    smps[i]->ts.origin = time_now();
+
+    for (unsigned j = 0; j < NUM_VALUES; j++)
+      smps[i]->data[j].f = i * 0.1 + j;
+  }
+
+  ret = n->write(smps, NUM_SAMPLES);
+  cr_assert_eq(ret, NUM_SAMPLES);
+
+  // Sends the remaining lines
+  ret = n->stop();
+  cr_assert_eq(ret, 0);
+
+  unsigned datagrams = 0, lines = 0;
+  char buf[2 * BATCH_SIZE];
+
+  while (lines < NUM_SAMPLES) {
+    ssize_t len = recv(sd, buf, sizeof(buf), MSG_DONTWAIT);
+    cr_assert_gt(len, 0, "Received only %u of %u lines", lines, NUM_SAMPLES);
+
+    cr_assert_leq(len, BATCH_SIZE, "Datagram exceeds batch size: %zd", len);
+    cr_assert_eq(buf[len - 1], '\n', "Datagram is not split at a line");
+    cr_assert_eq(strncmp(buf, "meas ", 5), 0);
+
+    lines += std::count(buf, buf + len, '\n');
+    datagrams++;
+  }
+
+  cr_assert_eq(lines, NUM_SAMPLES);
+  cr_assert_gt(datagrams, 1);
+
+  sample_free_many(smps, NUM_SAMPLES);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0);
+
+  delete n;
+
+  json_decref(json);
+
+  close(sd);
+}
@@ -9,7 +9,10 @@
 
 #include <villas/list.hpp>
 #include <villas/mapping.hpp>
+#include <villas/mapping_list.hpp>
+#include <villas/mapping_plan.hpp>
 #include <villas/node.hpp>
+#include <villas/sample.hpp>
 #include <villas/signal.hpp>
 #include <villas/utils.hpp>
 
@@ -83,3 +86,84 @@ Test(mapping, parse_nodes) {
   cr_assert_str_eq(m.data.first, "sole");
   cr_assert_str_eq(m.data.last, "mio");
 }
+
+static MappingEntry::Ptr mapping_data(unsigned offset, int src, int len) {
+  auto me = std::make_shared<MappingEntry>();
+
+  me->type = MappingEntry::Type::DATA;
+  me->offset = offset;
+  me->length = len;
+  me->data.offset = src;
+
+  return me;
+}
+
+Test(mapping, plan) {
+  int ret;
+  MappingList ml;
+  MappingPlan plan;
+
+  auto me = std::make_shared<MappingEntry>();
+  me->type = MappingEntry::Type::HEADER;
+  me->header.type = MappingEntry::HeaderType::SEQUENCE;
+  me->offset = 3;
+  me->length = 1;
+
+  // Values 0-1 and 7 are provided by other sources
+  ml.push_back(mapping_data(2, 0, 1));
+  ml.push_back(me);
+  ml.push_back(mapping_data(4, 2, 1));
+  ml.push_back(mapping_data(5, 3, 2));
+
+  plan.compile(ml, 8);
+
+  // Contiguous data mappings are merged
+  cr_assert_eq(plan.getDataRanges().size(), 2);
+  cr_assert_eq(plan.getDataRanges()[1].len, 3);
+  cr_assert_eq(plan.getCarryRanges().size(), 2);
+
+  auto *orig = sample_alloc_mem(8);
+  auto *prev = sample_alloc_mem(8);
+  auto *muxed = sample_alloc_mem(8);
+
+  orig->sequence = 1234;
+  orig->length = 5;
+  for (unsigned i = 0; i < orig->length; i++)
+    orig->data[i].f = 10 + i;
+
+  prev->length = 8;
+  for (unsigned i = 0; i < prev->length; i++)
+    prev->data[i].f = -1.0 * i;
+
+  ret = plan.apply(muxed, orig, prev);
+  cr_assert_eq(ret, 0);
+
+  cr_assert_eq(muxed->length, 8);
+  cr_assert_float_eq(muxed->data[0].f, 0, 1e-6);
+  cr_assert_float_eq(muxed->data[1].f, -1, 1e-6);
+  cr_assert_float_eq(muxed->data[2].f, 10, 1e-6);
+  cr_assert_eq(muxed->data[3].i, 1234);
+  cr_assert_float_eq(muxed->data[4].f, 12, 1e-6);
+  cr_assert_float_eq(muxed->data[5].f, 13, 1e-6);
+  cr_assert_float_eq(muxed->data[6].f, 14, 1e-6);
+  cr_assert_float_eq(muxed->data[7].f, -7, 1e-6);
+
+  // A shorter original sample keeps the previous values
+  orig->length = 4;
+
+  ret = plan.apply(muxed, orig, prev);
+  cr_assert_eq(ret, 0);
+  cr_assert_float_eq(muxed->data[5].f, 13, 1e-6);
+  cr_assert_float_eq(muxed->data[6].f, -6, 1e-6);
+
+  // Insufficient capacity
+  auto *small = sample_alloc_mem(4);
+
+  ret = plan.apply(small, orig, prev);
+  cr_assert_eq(ret, -1);
+
+  sample_free(orig);
+  sample_free(prev);
+  sample_free(muxed);
+  sample_free(small);
+}
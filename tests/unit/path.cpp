@@ -0,0 +1,165 @@
+/* Unit tests for paths.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <criterion/criterion.h>
+
+#include <villas/node.hpp>
+#include <villas/node_list.hpp>
+#include <villas/path.hpp>
+#include <villas/pool.hpp>
+#include <villas/sample.hpp>
+
+using namespace villas::node;
+
+extern void init_memory();
+
+#define NUM_SOURCES 3
+#define NUM_SAMPLES 50
+
+static Node *make_loopback(const char *name, json_t *json) {
+  uuid_t uuid = {};
+
+  auto *n = NodeFactory::make("loopback", uuid, name);
+  cr_assert_not_null(n);
+
+  int ret = n->parse(json);
+  cr_assert_eq(ret, 0);
+
+  ret = n->check();
+  cr_assert_eq(ret, 0);
+
+  json_decref(json);
+
+  return n;
+}
+
+/* A path with multiple sources waits on all of them in a single epoll set.
+ * Each sample written to any source must reach the destination exactly once
+ * and carry the values of its source at the offset of its mapping. */
+// cppcheck-suppress unknownMacro
+Test(path, poll_multiple_sources, .init = init_memory) {
+  int ret;
+  struct Pool pool;
+  NodeList nodes;
+  Node *srcs[NUM_SOURCES];
+  uuid_t sn_uuid = {};
+
+  for (unsigned k = 0; k < NUM_SOURCES; k++) {
+    auto name = fmt::format("src{}", k);
+    srcs[k] = make_loopback(
+        name.c_str(), json_pack("{ s: b, s: { s: { s: i, s: s } } }",
+                                "builtin", 0, "in", "signals", "count", 1,
+                                "type", "float"));
+    nodes.push_back(srcs[k]);
+  }
+
+  auto *dst = make_loopback(
+      "dst", json_pack("{ s: b, s: { s: { s: i, s: s } } }", "builtin", 0,
+                       "in", "signals", "count", NUM_SOURCES, "type", "float"));
+  nodes.push_back(dst);
+
+  json_t *json_path =
+      json_pack("{ s: [ s, s, s ], s: s, s: b }", "in", "src0", "src1", "src2",
+                "out", "dst", "builtin", 0);
+  cr_assert_not_null(json_path);
+
+  auto *p = new Path();
+  p->parse(json_path, nodes, sn_uuid);
+  p->check();
+
+  for (auto *n : nodes) {
+    ret = n->prepare();
+    cr_assert_eq(ret, 0);
+  }
+
+  p->prepare(nodes);
+
+  // Polling is enabled automatically for paths with multiple sources
+  cr_assert_eq(p->poll, 1);
+
+  // Sequence numbers are assigned by the path if it has multiple sources
+  cr_assert_eq(p->original_sequence_no, 0);
+
+  for (auto *n : nodes) {
+    ret = n->start();
+    cr_assert_eq(ret, 0);
+  }
+
+  p->start();
+
+  ret = pool_init(&pool, 2 * NUM_SOURCES * NUM_SAMPLES,
+                  SAMPLE_LENGTH(NUM_SOURCES));
+  cr_assert_eq(ret, 0);
+
+  // Interleave samples of all sources, so that several are ready at once
+  for (unsigned i = 0; i < NUM_SAMPLES; i++) {
+    for (unsigned k = 0; k < NUM_SOURCES; k++) {
+      auto *smp = sample_alloc(&pool);
+      cr_assert_not_null(smp);
+
+      smp->flags = (int)SampleFlags::HAS_DATA | (int)SampleFlags::HAS_SEQUENCE;
+      smp->length = 1;
+      smp->sequence = i;
+      smp->signals = srcs[k]->getInputSignals();
+      smp->data[0].f = 1 + k * 1000 + i;
+
+      ret = srcs[k]->write(&smp, 1);
+      cr_assert_eq(ret, 1);
+
+      sample_decref(smp);
+    }
+  }
+
+  unsigned received[NUM_SOURCES] = {};
+
+  for (unsigned j = 0; j < NUM_SOURCES * NUM_SAMPLES; j++) {
+    auto *smp = sample_alloc(&pool);
+    cr_assert_not_null(smp);
+
+    ret = dst->read(&smp, 1);
+    cr_assert_eq(ret, 1);
+    cr_assert_leq(smp->length, NUM_SOURCES);
+
+    /* The value of the source which triggered this sample is the next in its
+     * sequence. The values of all other sources have been seen before.
+     * Sources which have not been seen yet might be missing. */
+    unsigned updated = 0;
+    for (unsigned k = 0; k < smp->length; k++) {
+      double expected = 1 + k * 1000 + received[k];
+
+      if (received[k] < NUM_SAMPLES && smp->data[k].f == expected) {
+        received[k]++;
+        updated++;
+      } else if (received[k] > 0)
+        cr_assert_float_eq(smp->data[k].f, expected - 1, 1e-9);
+    }
+
+    cr_assert_eq(updated, 1, "Sample %u updated %u sources", j, updated);
+
+    sample_decref(smp);
+  }
+
+  for (unsigned k = 0; k < NUM_SOURCES; k++)
+    cr_assert_eq(received[k], NUM_SAMPLES);
+
+  p->stop();
+
+  for (auto *n : nodes) {
+    ret = n->stop();
+    cr_assert_eq(ret, 0);
+  }
+
+  delete p;
+
+  for (auto *n : nodes)
+    delete n;
+
+  json_decref(json_path);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0);
+}
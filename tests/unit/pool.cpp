@@ -9,6 +9,8 @@
 
 #include <criterion/criterion.h>
 #include <criterion/parameterized.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <signal.h>
 
 #include <villas/log.hpp>
@@ -77,3 +79,148 @@ ParameterizedTest(struct param *p, pool, basic, .init = init_memory) {
   ret = pool_destroy(&pool);
   cr_assert_eq(ret, 0, "Failed to destroy pool");
 }
+
+struct release_param {
+  struct Pool *pool;
+  void **blocks;
+  size_t cnt;
+};
+
+static void *release_blocks(void *ctx) {
+  auto *p = (struct release_param *)ctx;
+
+  for (size_t i = 0; i < p->cnt; i++)
+    pool_put(p->pool, p->blocks[i]);
+
+  return nullptr;
+}
+
+// cppcheck-suppress unknownMacro
+Test(pool, thread_cache, .init = init_memory) {
+  int ret;
+  struct Pool pool;
+  void *ptrs[256];
+
+  ret = pool_init(&pool, 256, 64, &memory::heap, (int)PoolFlags::THREAD_CACHE);
+  cr_assert_eq(ret, 0, "Failed to create pool");
+
+  // The first request refills the cache in a single batch
+  ret = pool_get_many(&pool, ptrs, 4);
+  cr_assert_eq(ret, 4);
+
+  auto stats = pool_cache_stats(&pool);
+  cr_assert_eq(stats.misses, 1);
+  cr_assert_eq(stats.cached, DEFAULT_POOL_CACHE_SIZE - 4);
+
+  ret = pool_get_many(&pool, &ptrs[4], 4);
+  cr_assert_eq(ret, 4);
+
+  ret = pool_put_many(&pool, ptrs, 8);
+  cr_assert_eq(ret, 8);
+
+  stats = pool_cache_stats(&pool);
+  cr_assert_eq(stats.hits, 2);
+  cr_assert_eq(stats.cached, DEFAULT_POOL_CACHE_SIZE);
+
+  // Drain the pool completely
+  ret = pool_get_many(&pool, ptrs, 256);
+  cr_assert_eq(ret, 256);
+  cr_assert_null(pool_get(&pool));
+
+  // Release all blocks from another thread
+  struct release_param rp = {.pool = &pool, .blocks = ptrs, .cnt = 256};
+  pthread_t tid;
+
+  ret = pthread_create(&tid, nullptr, release_blocks, &rp);
+  cr_assert_eq(ret, 0);
+
+  ret = pthread_join(tid, nullptr);
+  cr_assert_eq(ret, 0);
+
+  // The cache of the exited thread has been flushed back to the pool
+  stats = pool_cache_stats(&pool);
+  cr_assert_eq(stats.cached, 0);
+  cr_assert_gt(stats.hits + stats.misses, 256);
+
+  ret = pool_get_many(&pool, ptrs, 256);
+  cr_assert_eq(ret, 256);
+
+  ret = pool_put_many(&pool, ptrs, 256);
+  cr_assert_eq(ret, 256);
+
+  pool_cache_flush(&pool);
+
+  stats = pool_cache_stats(&pool);
+  cr_assert_eq(stats.cached, 0);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
+
+struct foreign_param {
+  struct Pool *pool;
+  void *blocks[8];
+  size_t cnt;
+  int rounds;
+  sem_t taken;
+  sem_t released;
+};
+
+static void *release_rounds(void *ctx) {
+  auto *p = (struct foreign_param *)ctx;
+
+  for (int i = 0; i < p->rounds; i++) {
+    sem_wait(&p->taken);
+
+    pool_put_many(p->pool, p->blocks, p->cnt);
+
+    sem_post(&p->released);
+  }
+
+  return nullptr;
+}
+
+// cppcheck-suppress unknownMacro
+Test(pool, thread_cache_foreign_release, .init = init_memory) {
+  int ret;
+  struct Pool pool;
+  struct foreign_param fp;
+
+  // Less headroom than a full magazine of the releasing thread
+  ret = pool_init(&pool, DEFAULT_POOL_CACHE_SIZE + 8, 64, &memory::heap,
+                  (int)PoolFlags::THREAD_CACHE);
+  cr_assert_eq(ret, 0, "Failed to create pool");
+
+  fp.pool = &pool;
+  fp.cnt = 8;
+  fp.rounds = 100;
+
+  sem_init(&fp.taken, 0, 0);
+  sem_init(&fp.released, 0, 0);
+
+  // The releasing thread stays alive, so its magazine is never flushed
+  pthread_t tid;
+  ret = pthread_create(&tid, nullptr, release_rounds, &fp);
+  cr_assert_eq(ret, 0);
+
+  for (int i = 0; i < fp.rounds; i++) {
+    ret = pool_get_many(&pool, fp.blocks, fp.cnt);
+    cr_assert_eq(ret, (int)fp.cnt, "Pool ran dry in round %d", i);
+
+    sem_post(&fp.taken);
+    sem_wait(&fp.released);
+
+    // Blocks released by a foreign thread are not cached
+    auto stats = pool_cache_stats(&pool);
+    cr_assert_leq(stats.cached, DEFAULT_POOL_CACHE_SIZE);
+  }
+
+  ret = pthread_join(tid, nullptr);
+  cr_assert_eq(ret, 0);
+
+  sem_destroy(&fp.taken);
+  sem_destroy(&fp.released);
+
+  ret = pool_destroy(&pool);
+  cr_assert_eq(ret, 0, "Failed to destroy pool");
+}
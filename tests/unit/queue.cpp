@@ -5,6 +5,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
@@ -41,6 +42,7 @@ struct param {
   bool many;
   int batch_size;
   struct memory::Type *mt;
+  int flags;
   volatile int start;
   struct CQueue queue;
 };
@@ -322,6 +324,181 @@ ParameterizedTest(struct param *p, queue, multi_threaded, .timeout = 20,
 }
 #endif // _POSIX_BARRIERS
 
+// cppcheck-suppress unknownMacro
+Test(queue, spsc, .init = init_memory) {
+  int ret;
+  struct CQueue q;
+  void *ptrs[16];
+
+  ret = queue_init(&q, 8, &memory::heap, (int)QueueFlags::SPSC);
+  cr_assert_eq(ret, 0);
+
+  for (intptr_t i = 0; i < 16; i++)
+    ptrs[i] = (void *)(i + 1);
+
+  // Only as many elements as the queue can hold are pushed
+  ret = queue_push_many(&q, ptrs, 16);
+  cr_assert_eq(ret, 8);
+  cr_assert_eq(queue_available(&q), 8);
+
+  ret = queue_push(&q, ptrs[8]);
+  cr_assert_eq(ret, 0);
+
+  ret = queue_pull_many(&q, ptrs, 5);
+  cr_assert_eq(ret, 5);
+
+  for (intptr_t i = 0; i < 5; i++)
+    cr_assert_eq((intptr_t)ptrs[i], i + 1);
+
+  // Wrap around
+  ret = queue_push_many(&q, &ptrs[8], 5);
+  cr_assert_eq(ret, 5);
+
+  ret = queue_pull_many(&q, ptrs, 16);
+  cr_assert_eq(ret, 8);
+
+  for (intptr_t i = 0; i < 8; i++)
+    cr_assert_eq((intptr_t)ptrs[i], i + 6);
+
+  ret = queue_pull(&q, &ptrs[0]);
+  cr_assert_eq(ret, 0);
+
+  ret = queue_close(&q);
+  cr_assert_eq(ret, 0);
+
+  ret = queue_push(&q, ptrs[0]);
+  cr_assert_eq(ret, -1);
+
+  ret = queue_destroy(&q);
+  cr_assert_eq(ret, 0);
+}
+
+static void *spsc_producer(void *ctx) {
+  struct param *p = (struct param *)ctx;
+
+  void *ptrs[p->batch_size];
+
+  while (p->start == 0)
+    sched_yield();
+
+  for (intptr_t count = 0; count < p->iter_count;) {
+    int cnt = std::min<intptr_t>(p->batch_size, p->iter_count - count);
+
+    for (int i = 0; i < cnt; i++)
+      ptrs[i] = (void *)(count + i);
+
+    for (int pushed = 0; pushed < cnt;) {
+      int ret = queue_push_many(&p->queue, &ptrs[pushed], cnt - pushed);
+      if (ret <= 0)
+        sched_yield(); // queue full
+      else
+        pushed += ret;
+    }
+
+    count += cnt;
+  }
+
+  return nullptr;
+}
+
+static void *spsc_consumer(void *ctx) {
+  struct param *p = (struct param *)ctx;
+
+  void *ptrs[p->batch_size];
+  intptr_t errors = 0;
+
+  while (p->start == 0)
+    sched_yield();
+
+  for (intptr_t count = 0; count < p->iter_count;) {
+    int ret = queue_pull_many(&p->queue, ptrs, p->batch_size);
+    if (ret <= 0) {
+      sched_yield(); // queue empty
+      continue;
+    }
+
+    // Elements must be received in order
+    for (int i = 0; i < ret; i++, count++) {
+      if ((intptr_t)ptrs[i] != count)
+        errors++;
+    }
+  }
+
+  return (void *)errors;
+}
+
+/* Compares the generic MPMC queue with the SPSC variant for a 1:1 link.
+ * The cycles per operation are logged for both. */
+// cppcheck-suppress unknownMacro
+ParameterizedTestParameters(queue, spsc_throughput) {
+  static struct param params[] = {{.iter_count = 1 << 20,
+                                   .queue_size = 1 << 10,
+                                   .thread_count = 2,
+                                   .batch_size = 1,
+                                   .mt = &memory::heap,
+                                   .flags = 0},
+                                  {.iter_count = 1 << 20,
+                                   .queue_size = 1 << 10,
+                                   .thread_count = 2,
+                                   .batch_size = 1,
+                                   .mt = &memory::heap,
+                                   .flags = (int)QueueFlags::SPSC},
+                                  {.iter_count = 1 << 20,
+                                   .queue_size = 1 << 10,
+                                   .thread_count = 2,
+                                   .batch_size = 32,
+                                   .mt = &memory::heap,
+                                   .flags = 0},
+                                  {.iter_count = 1 << 20,
+                                   .queue_size = 1 << 10,
+                                   .thread_count = 2,
+                                   .batch_size = 32,
+                                   .mt = &memory::heap,
+                                   .flags = (int)QueueFlags::SPSC}};
+
+  return cr_make_param_array(struct param, params, std::size(params));
+}
+
+// cppcheck-suppress unknownMacro
+ParameterizedTest(struct param *p, queue, spsc_throughput, .timeout = 20,
+                  .init = init_memory) {
+  int ret;
+  void *errors;
+  struct Tsc tsc;
+  pthread_t prod, cons;
+
+  Logger logger = Log::get("test:queue:spsc_throughput");
+
+  p->start = 0;
+
+  ret = queue_init(&p->queue, p->queue_size, p->mt, p->flags);
+  cr_assert_eq(ret, 0, "Failed to create queue");
+
+  pthread_create(&prod, nullptr, spsc_producer, p);
+  pthread_create(&cons, nullptr, spsc_consumer, p);
+
+  ret = tsc_init(&tsc);
+  cr_assert(!ret);
+
+  uint64_t start_tsc_time = tsc_now(&tsc);
+  p->start = 1;
+
+  pthread_join(prod, nullptr);
+  pthread_join(cons, &errors);
+
+  uint64_t end_tsc_time = tsc_now(&tsc);
+
+  logger->info("{} queue, batch size {}: {} cycles/op",
+               p->flags & (int)QueueFlags::SPSC ? "SPSC" : "MPMC",
+               p->batch_size, (end_tsc_time - start_tsc_time) / p->iter_count);
+
+  cr_assert_eq((intptr_t)errors, 0, "Elements were received out of order");
+  cr_assert_eq(queue_available(&p->queue), 0);
+
+  ret = queue_destroy(&p->queue);
+  cr_assert_eq(ret, 0, "Failed to destroy queue");
+}
+
 // cppcheck-suppress unknownMacro
 Test(queue, init_destroy, .init = init_memory) {
   int ret;
@@ -5,6 +5,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <atomic>
+
 #include <criterion/criterion.h>
 #include <criterion/parameterized.h>
 #include <poll.h>
@@ -100,7 +102,12 @@ ParameterizedTestParameters(queue_signalled, simple) {
     {QueueSignalledMode::POLLING, 0, false},
 #if defined(__linux__) && defined(HAS_EVENTFD)
     {QueueSignalledMode::EVENTFD, 0, false},
-    {QueueSignalledMode::EVENTFD, 0, true}
+    {QueueSignalledMode::EVENTFD, 0, true},
+#endif
+#ifdef __linux__
+    {QueueSignalledMode::FUTEX, 0, false},
+    {QueueSignalledMode::FUTEX, (int)QueueSignalledFlags::PROCESS_SHARED,
+     false},
 #endif
   };
 
@@ -147,3 +154,45 @@ ParameterizedTest(struct param *param, queue_signalled, simple, .timeout = 5,
   ret = queue_signalled_destroy(&q);
   cr_assert_eq(ret, 0);
 }
+
+#ifdef __linux__
+static void *blocked_consumer(void *ctx) {
+  struct CQueueSignalled *q = (struct CQueueSignalled *)ctx;
+  void *p;
+
+  intptr_t ret = queue_signalled_pull(q, &p);
+
+  return (void *)ret;
+}
+
+// Paths are stopped with pthread_cancel() while they wait for samples
+Test(queue_signalled, cancel_futex, .timeout = 5, .init = init_memory) {
+  int ret;
+  void *r;
+  struct CQueueSignalled q;
+  pthread_t t;
+
+  ret = queue_signalled_init(&q, 16, &memory::heap, QueueSignalledMode::FUTEX,
+                             (int)QueueSignalledFlags::PROCESS_SHARED);
+  cr_assert_eq(ret, 0);
+
+  ret = pthread_create(&t, nullptr, blocked_consumer, &q);
+  cr_assert_eq(ret, 0);
+
+  // Wait until the consumer is blocked
+  while (std::atomic_ref(q.futex.waiters).load() == 0)
+    usleep(1000);
+
+  ret = pthread_cancel(t);
+  cr_assert_eq(ret, 0);
+
+  ret = pthread_join(t, &r);
+  cr_assert_eq(ret, 0);
+  cr_assert_eq(r, PTHREAD_CANCELED);
+
+  cr_assert_eq(std::atomic_ref(q.futex.waiters).load(), 0);
+
+  ret = queue_signalled_destroy(&q);
+  cr_assert_eq(ret, 0);
+}
+#endif
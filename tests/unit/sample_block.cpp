@@ -0,0 +1,68 @@
+/* Unit tests for column-major sample blocks.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <cstdint>
+#include <list>
+
+#include <criterion/criterion.h>
+
+#include <villas/sample.hpp>
+#include <villas/sample_block.hpp>
+
+using namespace villas::node;
+
+// cppcheck-suppress unknownMacro
+Test(sample_block, gather_scatter) {
+  const unsigned cnt = 13;
+  struct Sample *smps[cnt];
+  SampleBlock block;
+
+  for (unsigned i = 0; i < cnt; i++) {
+    smps[i] = sample_alloc_mem(4);
+    smps[i]->length = 4;
+
+    for (unsigned j = 0; j < 4; j++)
+      smps[i]->data[j].f = i * 10 + j;
+  }
+
+  std::list<unsigned> indices = {3, 1};
+  block.gather(smps, cnt, indices);
+
+  cr_assert_eq(block.getCount(), cnt);
+  cr_assert_eq(block.getColumnCount(), 2);
+
+  // Each column starts at a cache line boundary
+  cr_assert_eq((uintptr_t)block.column(0) % 64, 0);
+  cr_assert_eq((uintptr_t)block.column(1) % 64, 0);
+
+  for (unsigned i = 0; i < cnt; i++) {
+    cr_assert_float_eq(block.column(0)[i], i * 10 + 3, 1e-9);
+    cr_assert_float_eq(block.column(1)[i], i * 10 + 1, 1e-9);
+  }
+
+  for (unsigned i = 0; i < cnt; i++) {
+    block.column(0)[i] *= -1;
+    block.column(1)[i] *= 2;
+  }
+
+  block.scatter(smps);
+
+  for (unsigned i = 0; i < cnt; i++) {
+    cr_assert_float_eq(smps[i]->data[0].f, i * 10 + 0, 1e-9);
+    cr_assert_float_eq(smps[i]->data[1].f, (i * 10 + 1) * 2, 1e-9);
+    cr_assert_float_eq(smps[i]->data[2].f, i * 10 + 2, 1e-9);
+    cr_assert_float_eq(smps[i]->data[3].f, (i * 10 + 3) * -1.0, 1e-9);
+  }
+
+  // A smaller batch reuses the memory of the block
+  block.gather(smps, 2, indices);
+  cr_assert_eq(block.getCount(), 2);
+  cr_assert_float_eq(block.column(1)[1], 22, 1e-9);
+
+  for (unsigned i = 0; i < cnt; i++)
+    sample_decref(smps[i]);
+}
@@ -0,0 +1,152 @@
+/* Unit tests for shared memory broadcast rings.
+ *
+ * Author: Steffen Vogel <post@steffenvogel.de>
+ * SPDX-FileCopyrightText: 2014-2023 Institute for Automation of Complex Power Systems, RWTH Aachen University
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <criterion/criterion.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <villas/sample.hpp>
+#include <villas/shmem.hpp>
+
+using namespace villas::node;
+
+extern void init_memory();
+
+constexpr static auto NAME = "/villas-test-broadcast";
+constexpr static auto SLOTS = 16;
+constexpr static auto SAMPLELEN = 4;
+
+static void fill(struct Sample *smps[], unsigned cnt, uint64_t first) {
+  for (unsigned i = 0; i < cnt; i++) {
+    smps[i]->sequence = first + i;
+    smps[i]->flags = (int)SampleFlags::HAS_SEQUENCE;
+    smps[i]->length = SAMPLELEN;
+
+    for (unsigned j = 0; j < SAMPLELEN; j++)
+      smps[i]->data[j].i = first + i + j;
+  }
+}
+
+// cppcheck-suppress unknownMacro
+Test(shmem, broadcast, .init = init_memory) {
+  int ret;
+  struct ShmemBroadcast writer, readers[2];
+  struct Sample *smps[SLOTS * 3];
+
+  for (auto &smp : smps) {
+    smp = sample_alloc_mem(SAMPLELEN);
+    cr_assert_not_null(smp);
+  }
+
+  ret = shmem_bcast_create(NAME, &writer, SLOTS, SAMPLELEN);
+  cr_assert_eq(ret, 0);
+
+  for (auto &r : readers) {
+    ret = shmem_bcast_attach(NAME, &r);
+    cr_assert_eq(ret, 0);
+  }
+
+  // All readers receive the same samples
+  fill(smps, 10, 0);
+
+  ret = shmem_bcast_write(&writer, smps, 10);
+  cr_assert_eq(ret, 10);
+
+  for (auto &r : readers) {
+    ret = shmem_bcast_read(&r, smps, 10);
+    cr_assert_eq(ret, 10);
+
+    for (unsigned i = 0; i < 10; i++) {
+      cr_assert_eq(smps[i]->sequence, i);
+      cr_assert_eq(smps[i]->length, SAMPLELEN);
+      cr_assert_eq(smps[i]->data[SAMPLELEN - 1].i, i + SAMPLELEN - 1);
+    }
+  }
+
+  // A reader which falls behind loses the overwritten samples
+  fill(smps, SLOTS * 3, 10);
+
+  ret = shmem_bcast_write(&writer, smps, SLOTS * 3);
+  cr_assert_eq(ret, SLOTS * 3);
+
+  ret = shmem_bcast_read(&readers[0], smps, SLOTS * 3);
+  cr_assert_eq(ret, SLOTS);
+  cr_assert_eq(readers[0].lost, SLOTS * 2);
+  cr_assert_eq(smps[0]->sequence, 10 + SLOTS * 2);
+
+  // Readers are woken up once the writer is closed
+  ret = shmem_bcast_close(&writer);
+  cr_assert_eq(ret, 0);
+
+  ret = shmem_bcast_read(&readers[0], smps, 1);
+  cr_assert_eq(ret, -1);
+
+  for (auto &r : readers) {
+    ret = shmem_bcast_close(&r);
+    cr_assert_eq(ret, 0);
+  }
+
+  for (auto &smp : smps)
+    sample_free(smp);
+}
+
+static void *blocked_reader(void *ctx) {
+  auto *bc = (struct ShmemBroadcast *)ctx;
+  struct Sample *smp = sample_alloc_mem(SAMPLELEN);
+
+  intptr_t ret = shmem_bcast_read(bc, &smp, 1);
+
+  sample_free(smp);
+
+  return (void *)ret;
+}
+
+Test(shmem, broadcast_stop, .timeout = 5, .init = init_memory) {
+  int ret;
+  void *r;
+  pthread_t t;
+  struct ShmemBroadcast writer, reader;
+
+  ret = shmem_bcast_create(NAME, &writer, SLOTS, SAMPLELEN);
+  cr_assert_eq(ret, 0);
+
+  ret = shmem_bcast_attach(NAME, &reader);
+  cr_assert_eq(ret, 0);
+
+  // A blocked reader can be cancelled
+  ret = pthread_create(&t, nullptr, blocked_reader, &reader);
+  cr_assert_eq(ret, 0);
+
+  while (std::atomic_ref(writer.shared->waiters).load() == 0)
+    usleep(1000);
+
+  ret = pthread_cancel(t);
+  cr_assert_eq(ret, 0);
+
+  ret = pthread_join(t, &r);
+  cr_assert_eq(ret, 0);
+  cr_assert_eq(r, PTHREAD_CANCELED);
+  cr_assert_eq(std::atomic_ref(writer.shared->waiters).load(), 0);
+  cr_assert_eq(reader.active, 0);
+
+  // Closing the handle of a blocked reader wakes it up
+  ret = pthread_create(&t, nullptr, blocked_reader, &reader);
+  cr_assert_eq(ret, 0);
+
+  while (std::atomic_ref(writer.shared->waiters).load() == 0)
+    usleep(1000);
+
+  ret = shmem_bcast_close(&reader);
+  cr_assert_eq(ret, 0);
+
+  ret = pthread_join(t, &r);
+  cr_assert_eq(ret, 0);
+  cr_assert_eq((intptr_t)r, -1);
+
+  ret = shmem_bcast_close(&writer);
+  cr_assert_eq(ret, 0);
+}